@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       complete_bench.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Measures completion and PATH lookup by the command index
+//             with 20000 executables.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file complete_bench.cpp
+ *
+ * @brief Measures completion and PATH lookup by the command index with 20000
+ *        executables.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../src/CommandIndex.h"
+#include "../src/Completer.h"
+
+using namespace std;
+
+static const int DIRECTORIES = 20;
+static const int EXECUTABLES = 1000; /**< per directory */
+static const int QUERIES = 10000;
+
+static double seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Returns random lower case name.
+ */
+static string randomName(size_t length) {
+	string name;
+	for (size_t i = 0; i < length; i++) {
+		name += 'a' + rand() % 26;
+	}
+	return name;
+}
+
+int main() {
+	char root[] = "/tmp/complete_benchXXXXXX";
+	if (mkdtemp(root) == NULL) {
+		perror("mkdtemp");
+		return EXIT_FAILURE;
+	}
+
+	/* Directories of PATH with executables of random names */
+	srand(1);
+	string path;
+	vector<string> dirs, names;
+	for (int i = 0; i < DIRECTORIES; i++) {
+		char dir[64];
+		snprintf(dir, sizeof(dir), "%s/bin%02d", root, i);
+		mkdir(dir, 0755);
+		dirs.push_back(dir);
+		path += (i > 0 ? ":" : "") + string(dir);
+		for (int j = 0; j < EXECUTABLES; j++) {
+			string name = randomName(6);
+			int fd = open((string(dir) + "/" + name).c_str(),
+					O_CREAT | O_WRONLY | O_CLOEXEC, 0755);
+			close(fd);
+			names.push_back(name);
+		}
+	}
+	const char *oldPath = getenv("PATH");
+	string systemPath = (oldPath != NULL) ? oldPath : "/bin:/usr/bin";
+	setenv("PATH", path.c_str(), 1);
+
+	double start = seconds();
+	size_t indexed = CommandIndex::size();
+	double buildMillis = (seconds() - start) * 1e3;
+
+	/* Completion of two letter prefixes, the worst case is one letter */
+	vector<double> latencies;
+	size_t candidates = 0;
+	for (int i = 0; i < QUERIES; i++) {
+		vector<string> result;
+		double queryStart = seconds();
+		CommandIndex::complete(randomName(2), result);
+		latencies.push_back((seconds() - queryStart) * 1e6);
+		candidates += result.size();
+	}
+	sort(latencies.begin(), latencies.end());
+
+	vector<string> all;
+	start = seconds();
+	CommandIndex::complete(randomName(1), all);
+	double worstMicros = (seconds() - start) * 1e6;
+
+	/* Lookup by the index against stat in every directory of PATH */
+	string found;
+	start = seconds();
+	for (int i = 0; i < QUERIES; i++) {
+		CommandIndex::lookup(names[rand() % names.size()], found);
+	}
+	double lookupMicros = (seconds() - start) * 1e6 / QUERIES;
+
+	start = seconds();
+	for (int i = 0; i < QUERIES; i++) {
+		const string &name = names[rand() % names.size()];
+		struct stat st;
+		for (size_t j = 0; j < dirs.size(); j++) {
+			if (stat((dirs[j] + "/" + name).c_str(), &st) == 0) {
+				break;
+			}
+		}
+	}
+	double walkMicros = (seconds() - start) * 1e6 / QUERIES;
+
+	/* File names of one directory, listing is cached */
+	Completer completer;
+	start = seconds();
+	for (int i = 0; i < QUERIES; i++) {
+		vector<string> result;
+		completer.completeFile(dirs[0] + "/" + randomName(2), "/", result);
+	}
+	double fileMicros = (seconds() - start) * 1e6 / QUERIES;
+
+	printf("complete executables=%lu build_ms=%.1f p50_us=%.1f p99_us=%.1f"
+			" max_us=%.1f avg_candidates=%.1f one_letter_us=%.1f\n",
+			(unsigned long) indexed, buildMillis,
+			latencies[latencies.size() / 2],
+			latencies[latencies.size() * 99 / 100], latencies.back(),
+			(double) candidates / QUERIES, worstMicros);
+	printf("complete lookup_us=%.2f path_walk_us=%.2f file_us=%.2f\n",
+			lookupMicros, walkMicros, fileMicros);
+
+	CommandIndex::stop();
+	setenv("PATH", systemPath.c_str(), 1);
+	string command = string("rm -rf ") + root;
+	return (system(command.c_str()) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,145 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       every_bench.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Measures jitter and drift of the runs started by every.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file every_bench.cpp
+ *
+ * @brief Measures jitter and drift of the runs started by the every builtin
+ *        and CPU time of the shell per run.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+static const int DEFAULT_RUNS = 200;
+static const long INTERVAL_MILLIS = 10;
+
+/**
+ * Returns user and system CPU time of the process in milliseconds.
+ */
+static long cpuMillis(pid_t pid) {
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/%d/stat", (int) pid);
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		return -1;
+	}
+
+	unsigned long user = 0, system = 0;
+	int fields = fscanf(file, "%*d (%*[^)]) %*c %*d %*d %*d %*d %*d %*u %*u"
+			" %*u %*u %*u %lu %lu", &user, &system);
+	fclose(file);
+	return (fields == 2) ? (user + system) * 1000 / sysconf(_SC_CLK_TCK) : -1;
+}
+
+/**
+ * Runs date every interval in the shell, start times printed by the runs are
+ * compared with the ticks since the first run. Drift is the offset
+ * of the last run.
+ * @param shell Path of the shell.
+ * @param runs Number of the runs.
+ * @return False on failure.
+ */
+static bool measure(const char *shell, int runs) {
+	int input[2], output[2];
+	if (pipe(input) == -1 || pipe(output) == -1) {
+		perror("pipe");
+		return false;
+	}
+	pid_t pid = fork();
+	if (pid == 0) {
+		dup2(input[0], STDIN_FILENO);
+		dup2(output[1], STDOUT_FILENO);
+		close(input[0]);
+		close(input[1]);
+		close(output[0]);
+		close(output[1]);
+		execl(shell, shell, "-", (char *) NULL);
+		_exit(127);
+	}
+	close(input[0]);
+	close(output[1]);
+
+	char line[256];
+	int length = snprintf(line, sizeof(line), "every -o parallel %ldms /bin/date +%%s%%N\n",
+			INTERVAL_MILLIS);
+	if (write(input[1], line, length) != length) {
+		perror("write");
+		return false;
+	}
+
+	/* Start times in nanoseconds, prompts are skipped */
+	vector<double> starts;
+	string text;
+	char data[4096];
+	ssize_t count = 1;
+	long cpuBefore = -1;
+	while ((int) starts.size() < runs
+			&& (count = read(output[0], data, sizeof(data))) > 0) {
+		text.append(data, count);
+		size_t end;
+		while ((end = text.find('\n')) != string::npos) {
+			size_t digit = text.find_first_of("0123456789");
+			string value = (digit < end) ? text.substr(digit, end - digit) : "";
+			if (value.size() > 12 && value.find(']') == string::npos) {
+				starts.push_back(atof(value.c_str()));
+			}
+			text.erase(0, end + 1);
+		}
+		cpuBefore = (cpuBefore == -1) ? cpuMillis(pid) : cpuBefore;
+	}
+	long cpu = cpuMillis(pid) - cpuBefore;
+
+	close(input[1]);
+	kill(pid, SIGTERM);
+	close(output[0]);
+	waitpid(pid, NULL, 0);
+
+	if ((int) starts.size() < runs) {
+		fprintf(stderr, "Shell %s has not run the command!\n", shell);
+		return false;
+	}
+
+	/* Run is matched with the nearest tick, missed ticks have no run */
+	vector<double> jitters;
+	double interval = INTERVAL_MILLIS * 1e6, drift = 0;
+	for (size_t i = 0; i < starts.size(); i++) {
+		double ticks = floor((starts[i] - starts[0]) / interval + 0.5);
+		drift = (starts[i] - starts[0] - ticks * interval) / 1e3;
+		jitters.push_back(fabs(drift));
+	}
+
+	sort(jitters.begin(), jitters.end());
+	printf("every interval_ms=%ld runs=%d jitter_p50_us=%.0f"
+			" jitter_p99_us=%.0f drift_us=%.0f shell_cpu_us_per_run=%.0f\n",
+			INTERVAL_MILLIS, runs, jitters[jitters.size() / 2],
+			jitters[jitters.size() * 99 / 100], drift, cpu * 1e3 / runs);
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	const char *shell = (argc > 1) ? argv[1] : "./shell";
+	int runs = (argc > 2) ? atoi(argv[2]) : DEFAULT_RUNS;
+
+	return measure(shell, runs) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
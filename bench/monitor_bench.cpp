@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       monitor_bench.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Compares monitor with separate conditions against monitor
+//             with one broadcasted condition variable.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file monitor_bench.cpp
+ *
+ * @brief Compares monitor with separate conditions against monitor with one
+ *        broadcasted condition variable.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <pthread.h>
+#include <time.h>
+
+#include "../src/PThread.h"
+
+using namespace std;
+
+static const int ENTER_ROUNDS = 10000000;
+static const int HANDOFFS = 200000;
+
+/**
+ * Monitor as it was before - every signal wakes up both reader and executor.
+ */
+class BroadcastMonitor {
+public:
+	BroadcastMonitor() {
+		pthread_mutex_init(&mutex, NULL);
+		pthread_cond_init(&cond, NULL);
+	}
+	void enter() {
+		pthread_mutex_lock(&mutex);
+	}
+	void exit() {
+		pthread_mutex_unlock(&mutex);
+	}
+	void signal() {
+		pthread_cond_broadcast(&cond);
+	}
+	void wait() {
+		pthread_cond_wait(&cond, &mutex);
+	}
+private:
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+};
+
+/**
+ * One slot buffer shared by the producer and the consumer.
+ */
+typedef struct {
+	BroadcastMonitor broadcast;
+	PThreadMonitor monitor;
+	PThreadCondition *filled;
+	PThreadCondition *emptied;
+	volatile int slot; /**< 0 when empty */
+	bool useConditions;
+} Shared;
+
+static double seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Consumer takes values until it gets negative one.
+ */
+static void *consumer(void *arg) {
+	Shared *shared = static_cast<Shared *>(arg);
+	int value = 0;
+
+	while (value >= 0) {
+		if (shared->useConditions) {
+			shared->monitor.enter();
+			while (shared->slot == 0) {
+				shared->filled->wait();
+			}
+			value = shared->slot;
+			shared->slot = 0;
+			shared->emptied->signal();
+			shared->monitor.exit();
+		} else {
+			shared->broadcast.enter();
+			while (shared->slot == 0) {
+				shared->broadcast.wait();
+			}
+			value = shared->slot;
+			shared->slot = 0;
+			shared->broadcast.signal();
+			shared->broadcast.exit();
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Producer puts value into the slot when it is empty.
+ */
+static void produce(Shared *shared, int value) {
+	if (shared->useConditions) {
+		shared->monitor.enter();
+		while (shared->slot != 0) {
+			shared->emptied->wait();
+		}
+		shared->slot = value;
+		shared->filled->signal();
+		shared->monitor.exit();
+	} else {
+		shared->broadcast.enter();
+		while (shared->slot != 0) {
+			shared->broadcast.wait();
+		}
+		shared->slot = value;
+		shared->broadcast.signal();
+		shared->broadcast.exit();
+	}
+}
+
+/**
+ * Measures handoff of lines between two threads.
+ * @return Nanoseconds per handoff.
+ */
+static double handoff(Shared *shared) {
+	pthread_t thread;
+	shared->slot = 0;
+	pthread_create(&thread, NULL, consumer, shared);
+
+	double start = seconds();
+	for (int i = 1; i <= HANDOFFS; i++) {
+		produce(shared, i);
+	}
+	produce(shared, -1);
+	pthread_join(thread, NULL);
+
+	return (seconds() - start) * 1e9 / HANDOFFS;
+}
+
+int main() {
+	Shared shared;
+	PThreadCondition filled(shared.monitor, "filled");
+	PThreadCondition emptied(shared.monitor, "emptied");
+	shared.filled = &filled;
+	shared.emptied = &emptied;
+
+	/* Handoff between producer and consumer */
+
+	shared.useConditions = false;
+	double broadcastHandoff = handoff(&shared);
+	shared.useConditions = true;
+	double conditionsHandoff = handoff(&shared);
+
+	/* Uncontended enter and exit, glibc locks without lock prefix until the
+	 * first thread is created, so it is measured after the handoff */
+
+	double start = seconds();
+	for (int i = 0; i < ENTER_ROUNDS; i++) {
+		shared.broadcast.enter();
+		shared.broadcast.exit();
+	}
+	double broadcastEnter = (seconds() - start) * 1e9 / ENTER_ROUNDS;
+
+	start = seconds();
+	for (int i = 0; i < ENTER_ROUNDS; i++) {
+		shared.monitor.enter();
+		shared.monitor.exit();
+	}
+	double conditionsEnter = (seconds() - start) * 1e9 / ENTER_ROUNDS;
+
+	printf("monitor variant=broadcast enter_exit_ns=%.1f handoff_ns=%.0f\n",
+			broadcastEnter, broadcastHandoff);
+	printf("monitor variant=conditions enter_exit_ns=%.1f handoff_ns=%.0f\n",
+			conditionsEnter, conditionsHandoff);
+	return EXIT_SUCCESS;
+}
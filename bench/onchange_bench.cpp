@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       onchange_bench.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Measures latency from the change of the file to the output
+//             of the command run by on-change.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file onchange_bench.cpp
+ *
+ * @brief Measures latency from the change of the watched file to the output
+ *        of the command run by the on-change builtin and CPU time
+ *        of the shell waiting for the change.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+static const int DEFAULT_RUNS = 100;
+static const long IDLE_MILLIS = 1000;
+
+static double seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Returns user and system CPU time of the process in milliseconds.
+ */
+static long cpuMillis(pid_t pid) {
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/%d/stat", (int) pid);
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		return -1;
+	}
+
+	unsigned long user = 0, system = 0;
+	int fields = fscanf(file, "%*d (%*[^)]) %*c %*d %*d %*d %*d %*d %*u %*u"
+			" %*u %*u %*u %lu %lu", &user, &system);
+	fclose(file);
+	return (fields == 2) ? (user + system) * 1000 / sysconf(_SC_CLK_TCK) : -1;
+}
+
+/**
+ * Runs on-change in the shell, changes the watched file and measures time
+ * until the output of the command is read.
+ * @param shell Path of the shell.
+ * @param debounce Debounce of on-change in milliseconds.
+ * @param runs Number of the changes.
+ * @return False on failure.
+ */
+static bool measure(const char *shell, long debounce, int runs) {
+	char dir[] = "/tmp/onchange_bench.XXXXXX";
+	if (mkdtemp(dir) == NULL) {
+		perror("mkdtemp");
+		return false;
+	}
+	string watched = string(dir) + "/watched";
+
+	int input[2], output[2];
+	if (pipe(input) == -1 || pipe(output) == -1) {
+		perror("pipe");
+		return false;
+	}
+	pid_t pid = fork();
+	if (pid == 0) {
+		dup2(input[0], STDIN_FILENO);
+		dup2(output[1], STDOUT_FILENO);
+		close(input[0]);
+		close(input[1]);
+		close(output[0]);
+		close(output[1]);
+		execl(shell, shell, "-H", "-", (char *) NULL);
+		_exit(127);
+	}
+	close(input[0]);
+	close(output[1]);
+
+	char line[256];
+	int length = snprintf(line, sizeof(line),
+			"on-change -d %ldms -n %d %s /bin/echo x\n", debounce, runs,
+			watched.c_str());
+	if (write(input[1], line, length) != length) {
+		perror("write");
+		return false;
+	}
+
+	/* Shell waits for the change */
+	usleep(100000);
+	long cpuBefore = cpuMillis(pid);
+	usleep(IDLE_MILLIS * 1000);
+	long idleCpu = cpuMillis(pid) - cpuBefore;
+
+	vector<double> latencies;
+	string text;
+	char data[256];
+	ssize_t count = 1;
+	for (int i = 0; i < runs && count > 0; i++) {
+		double start = seconds();
+		int fd = open(watched.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+		if (fd == -1 || write(fd, "x", 1) != 1) {
+			perror("write watched file");
+			return false;
+		}
+		close(fd);
+
+		while (text.find("x\n") == string::npos
+				&& (count = read(output[0], data, sizeof(data))) > 0) {
+			text.append(data, count);
+		}
+		latencies.push_back((seconds() - start) * 1e6);
+		text.erase(0, text.find("x\n") + 2);
+		usleep(debounce * 1000 + 10000); // Changes are not coalesced
+	}
+
+	close(input[1]);
+	while (read(output[0], data, sizeof(data)) > 0) {
+	}
+	close(output[0]);
+	waitpid(pid, NULL, 0);
+	unlink(watched.c_str());
+	rmdir(dir);
+
+	if (count <= 0) {
+		fprintf(stderr, "Shell %s has not run the command!\n", shell);
+		return false;
+	}
+
+	sort(latencies.begin(), latencies.end());
+	printf("onchange debounce_ms=%ld runs=%d p50_us=%.0f p99_us=%.0f"
+			" idle_cpu_ms=%ld\n", debounce, runs,
+			latencies[latencies.size() / 2],
+			latencies[latencies.size() * 99 / 100], idleCpu);
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	const char *shell = (argc > 1) ? argv[1] : "./shell";
+	int runs = (argc > 2) ? atoi(argv[2]) : DEFAULT_RUNS;
+
+	if (!measure(shell, 0, runs) || !measure(shell, 20, runs)) {
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       pool_bench.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Compares tasks run by the thread pool against one new thread
+//             per task.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file pool_bench.cpp
+ *
+ * @brief Compares tasks run by the thread pool against one new thread per
+ *        task.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <time.h>
+
+#include "../src/ThreadPool.h"
+
+using namespace std;
+
+static const int POOL_TASKS = 20000;
+static const int THREAD_TASKS = 2000;
+static const int SUBTASKS = 20000;
+
+static int counter = 0;
+
+static double seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Task which only counts that it has been run.
+ */
+class CountTask: public Task {
+public:
+	virtual int run() {
+		__atomic_add_fetch(&counter, 1, __ATOMIC_RELAXED);
+		return 0;
+	}
+};
+
+/**
+ * The same work on its own thread.
+ */
+class CountPThread: public PThread {
+public:
+	virtual ~CountPThread() {
+		cancel();
+	}
+	virtual int run() {
+		__atomic_add_fetch(&counter, 1, __ATOMIC_RELAXED);
+		return 0;
+	}
+};
+
+/**
+ * Task which submits subtasks from the worker, so they are queued
+ * to its own deque and the other workers have to steal them.
+ */
+class FanOutTask: public Task {
+public:
+	FanOutTask(ThreadPool &pool, vector<CountTask *> &subtasks) :
+			pool(pool), subtasks(subtasks) {
+	}
+	virtual int run() {
+		for (size_t i = 0; i < subtasks.size(); i++) {
+			pool.submit(subtasks[i]);
+		}
+		return 0;
+	}
+private:
+	ThreadPool &pool;
+	vector<CountTask *> &subtasks;
+};
+
+/**
+ * Creates tasks, runs them by the pool and waits for them.
+ * @return Nanoseconds per task.
+ */
+static double runPool(ThreadPool &pool, int count) {
+	vector<CountTask *> tasks;
+	for (int i = 0; i < count; i++) {
+		tasks.push_back(new CountTask());
+	}
+
+	double start = seconds();
+	for (int i = 0; i < count; i++) {
+		pool.submit(tasks[i]);
+	}
+	for (int i = 0; i < count; i++) {
+		tasks[i]->getCompletion().wait();
+	}
+	double spent = seconds() - start;
+
+	for (int i = 0; i < count; i++) {
+		delete tasks[i];
+	}
+	return spent * 1e9 / count;
+}
+
+/**
+ * Creates, starts and joins one thread per task.
+ * @return Nanoseconds per task.
+ */
+static double runThreads(int count) {
+	double start = seconds();
+	for (int i = 0; i < count; i++) {
+		CountPThread *thread = new CountPThread();
+		thread->start();
+		thread->getCompletion().wait();
+		delete thread;
+	}
+	return (seconds() - start) * 1e9 / count;
+}
+
+int main(int argc, char *argv[]) {
+	ThreadPool pool((argc > 1) ? atoi(argv[1]) : 0); // Default is one per CPU
+
+	double poolNanos = runPool(pool, POOL_TASKS);
+	double threadNanos = runThreads(THREAD_TASKS);
+
+	/* Subtasks submitted by the worker */
+
+	vector<CountTask *> subtasks;
+	for (int i = 0; i < SUBTASKS; i++) {
+		subtasks.push_back(new CountTask());
+	}
+	FanOutTask fanOut(pool, subtasks);
+
+	double start = seconds();
+	pool.submit(&fanOut);
+	fanOut.getCompletion().wait();
+	for (int i = 0; i < SUBTASKS; i++) {
+		subtasks[i]->getCompletion().wait();
+	}
+	double fanOutNanos = (seconds() - start) * 1e9 / SUBTASKS;
+
+	for (int i = 0; i < SUBTASKS; i++) {
+		delete subtasks[i];
+	}
+
+	int expected = POOL_TASKS + THREAD_TASKS + SUBTASKS;
+	printf("pool variant=thread_per_task tasks=%d ns_per_task=%.0f\n",
+			THREAD_TASKS, threadNanos);
+	printf("pool variant=pool workers=%d tasks=%d ns_per_task=%.0f\n",
+			pool.getWorkerCount(), POOL_TASKS, poolNanos);
+	printf("pool variant=fan_out workers=%d tasks=%d ns_per_task=%.0f stolen=%lu"
+			" complete=%d\n", pool.getWorkerCount(), SUBTASKS, fanOutNanos,
+			pool.getStolen(), counter == expected);
+	return (counter == expected) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       scanner_bench.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Benchmark of the delimiter scanner variants.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file scanner_bench.cpp
+ *
+ * @brief Benchmark of the delimiter scanner variants. Checks that every
+ *        variant gives the same bitmap as the scalar one and reports GB/s.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <sys/time.h>
+
+#include "../src/DelimiterScanner.h"
+
+using namespace std;
+
+static const size_t BLOCK_LENGTH = 64 * 1024 * 1024 + 37;
+static const int REPEATS = 10;
+
+/**
+ * Returns current time in seconds.
+ */
+static double now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+int main() {
+	static const char alphabet[] = "abcdefghij /-._ \t\n&<>|0123456789";
+
+	vector<char> block(BLOCK_LENGTH);
+	srand(42);
+	for (size_t i = 0; i < block.size(); i++) {
+		block[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+	}
+
+	DelimiterBitmap reference, bitmap;
+	DelimiterScanner::scan(&block[0], block.size(), reference,
+			DelimiterScanner::SCALAR);
+
+	DelimiterScanner::Variant variants[] = { DelimiterScanner::SCALAR,
+			DelimiterScanner::SSE2, DelimiterScanner::AVX2 };
+
+	int ret = EXIT_SUCCESS;
+	for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {
+		if (!DelimiterScanner::isSupported(variants[v])) {
+			printf("scanner variant=%s supported=0\n",
+					DelimiterScanner::variantName(variants[v]));
+			continue;
+		}
+
+		double start = now();
+		for (int r = 0; r < REPEATS; r++) {
+			DelimiterScanner::scan(&block[0], block.size(), bitmap,
+					variants[v]);
+		}
+		double elapsed = now() - start;
+
+		bool same = bitmap.delimiters == reference.delimiters
+				&& bitmap.newlines == reference.newlines;
+		if (!same) {
+			ret = EXIT_FAILURE;
+		}
+
+		printf("scanner variant=%s supported=1 identical=%d gbps=%.3f\n",
+				DelimiterScanner::variantName(variants[v]), same ? 1 : 0,
+				(double) block.size() * REPEATS / elapsed / 1e9);
+	}
+
+	return ret;
+}
@@ -0,0 +1,254 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       server_bench.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Load test of the shell server with many concurrent sessions.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file server_bench.cpp
+ *
+ * @brief Load test of the shell server with many concurrent sessions.
+ *        Every session sets its own variable and runs a command which
+ *        prints it, so the replies show that sessions are independent.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+static const int DEFAULT_SESSIONS = 1000;
+static const int CONNECT_ATTEMPTS = 200;
+
+static double seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Returns value of the field from /proc/PID/status, -1 if it is missing.
+ */
+static long procStatus(pid_t pid, const char *field) {
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/%d/status", (int) pid);
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		return -1;
+	}
+
+	long value = -1;
+	char line[256];
+	size_t length = strlen(field);
+	while (fgets(line, sizeof(line), file) != NULL) {
+		if (strncmp(line, field, length) == 0 && line[length] == ':') {
+			value = atol(line + length + 1);
+			break;
+		}
+	}
+	fclose(file);
+	return value;
+}
+
+/**
+ * Starts the shell with given arguments, its output is discarded.
+ * @param stdinFd Descriptor used as stdin of the shell.
+ */
+static pid_t startShell(const vector<const char *> &args, int stdinFd) {
+	pid_t pid = fork();
+	if (pid == 0) {
+		int devnull = open("/dev/null", O_WRONLY);
+		dup2(stdinFd, STDIN_FILENO);
+		dup2(devnull, STDOUT_FILENO);
+		execv(args[0], const_cast<char * const *>(&args[0]));
+		perror("Failed to start shell - execv()");
+		_exit(EXIT_FAILURE);
+	}
+	return pid;
+}
+
+static int connectTo(const string &path) {
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd != -1
+			&& connect(fd, reinterpret_cast<struct sockaddr *>(&addr),
+					sizeof(addr)) == -1) {
+		close(fd);
+		fd = -1;
+	}
+	return fd;
+}
+
+static bool sendLine(int fd, const string &line) {
+	return send(fd, line.data(), line.size(), MSG_NOSIGNAL)
+			== (ssize_t) line.size();
+}
+
+/**
+ * Waits until every session replies with its expected line.
+ * @return Number of the sessions which have replied correctly.
+ */
+static int collectReplies(const vector<int> &fds,
+		const vector<string> &expected) {
+	vector<string> replies(fds.size());
+	vector<bool> done(fds.size(), false);
+	int finished = 0, correct = 0;
+
+	while (finished < (int) fds.size()) {
+		vector<struct pollfd> pfds;
+		vector<size_t> index;
+		for (size_t i = 0; i < fds.size(); i++) {
+			if (!done[i]) {
+				struct pollfd pfd = { fds[i], POLLIN, 0 };
+				pfds.push_back(pfd);
+				index.push_back(i);
+			}
+		}
+		if (poll(&pfds[0], pfds.size(), 10000) <= 0) {
+			break; // Stuck sessions are reported as incorrect
+		}
+
+		for (size_t j = 0; j < pfds.size(); j++) {
+			if (pfds[j].revents == 0) {
+				continue;
+			}
+			size_t i = index[j];
+			char data[256];
+			ssize_t count = read(fds[i], data, sizeof(data));
+			if (count > 0) {
+				replies[i].append(data, count);
+			}
+			if (count <= 0 || replies[i].find('\n') != string::npos) {
+				done[i] = true;
+				finished++;
+				correct += (replies[i] == expected[i]) ? 1 : 0;
+			}
+		}
+	}
+	return correct;
+}
+
+int main(int argc, char *argv[]) {
+	const char *shellPath = (argc > 1) ? argv[1] : "./shell";
+	int sessions = (argc > 2) ? atoi(argv[2]) : DEFAULT_SESSIONS;
+
+	/* Every session is one descriptor of both processes */
+	struct rlimit limit;
+	getrlimit(RLIMIT_NOFILE, &limit);
+	if (limit.rlim_cur < (rlim_t) sessions + 64) {
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+
+	int devnull = open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+	/* Memory of one idle shell process for comparison */
+	int idlePipe[2];
+	if (pipe2(idlePipe, O_CLOEXEC) == -1) { // Shell exits on end of input
+		perror("Failed to create pipe - pipe2()");
+		return EXIT_FAILURE;
+	}
+	vector<const char *> idleArgs;
+	idleArgs.push_back(shellPath);
+	idleArgs.push_back(NULL);
+	pid_t idle = startShell(idleArgs, idlePipe[0]);
+	close(idlePipe[0]);
+	usleep(200000);
+	long idleRss = procStatus(idle, "VmRSS");
+	close(idlePipe[1]);
+	waitpid(idle, NULL, 0);
+
+	/* Server */
+	char socketPath[64];
+	snprintf(socketPath, sizeof(socketPath), "/tmp/shell_bench.%d.sock",
+			(int) getpid());
+	vector<const char *> serverArgs;
+	serverArgs.push_back(shellPath);
+	serverArgs.push_back("-S");
+	serverArgs.push_back(socketPath);
+	serverArgs.push_back(NULL);
+	pid_t server = startShell(serverArgs, devnull);
+
+	int probe = -1;
+	for (int i = 0; i < CONNECT_ATTEMPTS && probe == -1; i++) {
+		usleep(10000);
+		probe = connectTo(socketPath);
+	}
+	if (probe == -1) {
+		fprintf(stderr, "Server has not started on %s\n", socketPath);
+		kill(server, SIGKILL);
+		waitpid(server, NULL, 0);
+		return EXIT_FAILURE;
+	}
+	close(probe);
+
+	double start = seconds();
+	vector<int> fds;
+	for (int i = 0; i < sessions; i++) {
+		int fd = connectTo(socketPath);
+		if (fd == -1) {
+			perror("Failed to connect - connect()");
+			break;
+		}
+		fds.push_back(fd);
+	}
+	double connected = seconds();
+
+	/* Sessions keep their variables between the lines */
+	vector<string> expected;
+	for (size_t i = 0; i < fds.size(); i++) {
+		char line[64];
+		snprintf(line, sizeof(line), "X=%lu\n", (unsigned long) i);
+		sendLine(fds[i], line);
+	}
+	for (size_t i = 0; i < fds.size(); i++) {
+		char line[64];
+		snprintf(line, sizeof(line), "got %lu\n", (unsigned long) i);
+		expected.push_back(line);
+		sendLine(fds[i], "echo got $X\n");
+	}
+	int correct = collectReplies(fds, expected);
+	double replied = seconds();
+
+	long rss = procStatus(server, "VmRSS");
+	long threads = procStatus(server, "Threads");
+
+	for (size_t i = 0; i < fds.size(); i++) {
+		close(fds[i]);
+	}
+	kill(server, SIGTERM);
+	int status;
+	waitpid(server, &status, 0);
+	close(devnull);
+
+	bool complete = correct == sessions;
+	printf("server sessions=%d connect_ms=%.1f reply_ms=%.1f"
+			" rss_kb=%ld threads=%ld idle_process_rss_kb=%ld complete=%d\n",
+			sessions, (connected - start) * 1e3, (replied - connected) * 1e3,
+			rss, threads, idleRss, complete);
+	return complete ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,301 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       shell_bench.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Benchmark of the hot path of the shell from the tokens
+//             of the command to the commands per second of piped input.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file shell_bench.cpp
+ *
+ * @brief Benchmark of the hot path of the shell: scan of the delimiters
+ *        and split of the tokens of the command, parsing of the command line
+ *        (not cached and cached), handoff of the lines from the reader
+ *        thread to the executor, spawns per second of the executor and
+ *        commands per second of the shell reading piped input (builtins
+ *        and spawned children, also by the fork server).
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "../src/CommandExecutor.h"
+#include "../src/ReadPThread.h"
+
+using namespace std;
+
+static const int SPLITS = 200000;
+static const int COLD_PARSES = 5000;
+static const int CACHED_PARSES = 100000;
+static const int HANDOFF_LINES = 200000;
+static const int BUILTIN_LINES = 20000;
+static const int SPAWN_LINES = 2000;
+static const int SPAWNS = 2000;
+
+static const char LINE[] = "ls -la /tmp /var > listing < input &";
+
+static double seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Hook into the private parts of the executor, declared as its friend,
+ * so the benchmark does not widen its public interface.
+ */
+class ShellBench {
+public:
+	/**
+	 * Scans delimiters of the command line and splits its tokens.
+	 */
+	static void tokens() {
+		JobTable jobs;
+		CommandExecutor executor(jobs);
+		string line(LINE);
+		DelimiterBitmap bitmap;
+
+		double start = seconds();
+		for (int i = 0; i < SPLITS; i++) {
+			DelimiterScanner::scan(line.data(), line.size(), bitmap);
+		}
+		double scanNanos = (seconds() - start) * 1e9 / SPLITS;
+
+		size_t count = 0;
+		start = seconds();
+		for (int i = 0; i < SPLITS; i++) {
+			CommandExecutor::CommandInfo cmdInfo;
+			if (executor.processCommand(cmdInfo, line, bitmap)) {
+				count += 1 + cmdInfo.arguments.size() + cmdInfo.redirects.size();
+			}
+		}
+		double splitNanos = (seconds() - start) * 1e9 / SPLITS;
+
+		printf("tokens scan_ns=%.0f split_ns=%.0f tokens=%lu\n", scanNanos,
+				splitNanos, (unsigned long) count / SPLITS);
+	}
+
+	/**
+	 * Parses distinct lines, which miss the cache, and one line repeatedly.
+	 */
+	static void parse() {
+		JobTable jobs;
+		CommandExecutor executor(jobs);
+
+		vector<string> lines;
+		for (int i = 0; i < COLD_PARSES; i++) {
+			char line[96];
+			snprintf(line, sizeof(line),
+					"cmd%d -la /tmp /var > listing < input &", i);
+			lines.push_back(line);
+		}
+
+		double start = seconds();
+		for (int i = 0; i < COLD_PARSES; i++) {
+			executor.parseCommand(lines[i]);
+		}
+		double coldMicros = (seconds() - start) * 1e6 / COLD_PARSES;
+
+		start = seconds();
+		for (int i = 0; i < CACHED_PARSES; i++) {
+			executor.parseCommand(LINE);
+		}
+		double warmNanos = (seconds() - start) * 1e9 / CACHED_PARSES;
+
+		printf("parse cold_us=%.2f cached_ns=%.0f\n", coldMicros, warmNanos);
+	}
+
+	/**
+	 * Spawns /bin/true by startProcess and waits for it, then runs
+	 * the parsed command through executeCommand, which also adds the job
+	 * and waits for it. Startup and reading of the shell are not included.
+	 */
+	static void spawn() {
+		JobTable jobs;
+		CommandExecutor executor(jobs);
+		const CommandExecutor::CommandInfo *cmdInfo = executor.parseCommand(
+				"/bin/true");
+		if (cmdInfo == NULL) {
+			return;
+		}
+
+		CommandExecutor::ChildArgs args;
+		args.executor = &executor;
+		args.cmdInfo = cmdInfo;
+		args.periodic = false;
+		args.newGroup = false;
+		executor.getChildDescriptors(args.fds);
+		Scheduling::clear(args.sched);
+		args.limits = executor.sessionLimits;
+
+		double start = seconds();
+		for (int i = 0; i < SPAWNS; i++) {
+			int pid = executor.startProcess(CommandExecutor::executionHandler,
+					&args);
+			if (pid > 0) {
+				waitpid(pid, NULL, 0);
+			}
+		}
+		double processRate = SPAWNS / (seconds() - start);
+
+		start = seconds();
+		for (int i = 0; i < SPAWNS; i++) {
+			executor.executeCommand(*cmdInfo);
+		}
+		double executeRate = SPAWNS / (seconds() - start);
+
+		printf("spawn start_process_per_s=%.0f execute_per_s=%.0f\n",
+				processRate, executeRate);
+	}
+};
+
+/**
+ * Writes the lines into the descriptor and closes it.
+ */
+static pid_t startWriter(int fd, const string &line, int count) {
+	pid_t pid = fork();
+	if (pid == 0) {
+		string block;
+		for (int i = 0; i < count; i++) {
+			block += line;
+		}
+		size_t written = 0;
+		while (written < block.size()) {
+			ssize_t ret = write(fd, block.data() + written,
+					block.size() - written);
+			if (ret <= 0) {
+				_exit(EXIT_FAILURE);
+			}
+			written += ret;
+		}
+		_exit(EXIT_SUCCESS);
+	}
+	close(fd);
+	return pid;
+}
+
+/**
+ * Lines of the stdin are passed by the reader thread through the shared
+ * buffer to this thread, as to the execute thread of the shell.
+ */
+static void benchHandoff() {
+	int fds[2];
+	if (pipe(fds) == -1) {
+		perror("pipe");
+		return;
+	}
+	int savedStdin = dup(STDIN_FILENO);
+	dup2(fds[0], STDIN_FILENO);
+	close(fds[0]);
+
+	vector<char> buffer(513);
+	PThreadMonitor monitor("buffer");
+	PThreadCondition filled(monitor, "filled");
+	PThreadCondition emptied(monitor, "emptied");
+	ReadPThread reader(buffer, monitor, filled, emptied);
+
+	double start = seconds();
+	pid_t writer = startWriter(fds[1], "echo line\n", HANDOFF_LINES);
+	reader.startReading();
+
+	int lines = 0;
+	while (lines < HANDOFF_LINES) {
+		monitor.enter();
+		while (buffer[0] == '\0') {
+			filled.wait();
+		}
+		string line(&buffer[0]);
+		buffer[0] = '\0';
+		emptied.signal();
+		monitor.exit();
+		lines++;
+	}
+	double nanos = (seconds() - start) * 1e9 / lines;
+
+	reader.cancel();
+	waitpid(writer, NULL, 0);
+	dup2(savedStdin, STDIN_FILENO);
+	close(savedStdin);
+
+	printf("handoff lines=%d ns_per_line=%.0f\n", lines, nanos);
+}
+
+/**
+ * Runs the shell with piped input, its output is discarded.
+ * @return Commands per second or 0 if the shell has failed.
+ */
+static double runShell(const char *shell, const string &line, int count,
+		bool forkServer) {
+	int fds[2];
+	if (pipe(fds) == -1) {
+		perror("pipe");
+		return 0;
+	}
+
+	double start = seconds();
+	pid_t pid = fork();
+	if (pid == 0) {
+		int devnull = open("/dev/null", O_WRONLY);
+		dup2(fds[0], STDIN_FILENO);
+		dup2(devnull, STDOUT_FILENO);
+		close(fds[0]);
+		close(fds[1]);
+		execl(shell, shell, "-H", "-", forkServer ? "-z" : (char *) NULL,
+				(char *) NULL);
+		_exit(127);
+	}
+	close(fds[0]);
+	pid_t writer = startWriter(fds[1], line, count);
+
+	int status;
+	waitpid(pid, &status, 0);
+	double elapsed = seconds() - start;
+	waitpid(writer, NULL, 0);
+
+	return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? count / elapsed
+			: 0;
+}
+
+int main(int argc, char *argv[]) {
+	const char *shell = (argc > 1) ? argv[1] : "./shell";
+	signal(SIGPIPE, SIG_IGN);
+
+	ShellBench::tokens();
+	ShellBench::parse();
+	ShellBench::spawn();
+	benchHandoff();
+
+	struct {
+		const char *variant;
+		const char *line;
+		int count;
+		bool forkServer;
+	} variants[] = { { "builtin", "X=1\n", BUILTIN_LINES, false }, {
+			"spawn", "/bin/true\n", SPAWN_LINES, false }, { "spawn_zygote",
+			"/bin/true\n", SPAWN_LINES, true } };
+
+	int ret = EXIT_SUCCESS;
+	for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {
+		double rate = runShell(shell, variants[v].line, variants[v].count,
+				variants[v].forkServer);
+		printf("e2e variant=%s commands=%d commands_per_s=%.0f\n",
+				variants[v].variant, variants[v].count, rate);
+		ret = (rate > 0) ? ret : EXIT_FAILURE;
+	}
+	return ret;
+}
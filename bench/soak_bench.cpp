@@ -0,0 +1,335 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       soak_bench.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Soak test of the shell which runs a long mix of commands and
+//             fails when descriptors, memory or latency drift.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file soak_bench.cpp
+ *
+ * @brief Soak test of the shell. Runs a long mix of builtins, compound
+ *        commands, children with redirections, background children and
+ *        children with timeout, one command at a time through the event
+ *        stream. Every window of commands it samples open descriptors
+ *        and RSS of the shell, descriptors inherited by a child and p99
+ *        latency of the commands. Test fails when descriptors grow,
+ *        a child inherits more than stdin, stdout and stderr, or RSS or
+ *        p99 latency of the last window drift from the first sample.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+static const long DEFAULT_COMMANDS = 1000000;
+static const long DEFAULT_WINDOW = 50000;
+static const int EVENT_FD = 3;
+
+static const double RSS_DRIFT = 1.25; /**< allowed ratio to the first sample */
+static const long RSS_SLACK_KB = 1024;
+static const double LATENCY_DRIFT = 3.0;
+static const double LATENCY_SLACK_US = 200;
+
+static double seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Returns value of the field from /proc/PID/status, -1 if it is missing.
+ */
+static long procStatus(pid_t pid, const char *field) {
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/%d/status", (int) pid);
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		return -1;
+	}
+
+	long value = -1;
+	char line[256];
+	size_t length = strlen(field);
+	while (fgets(line, sizeof(line), file) != NULL) {
+		if (strncmp(line, field, length) == 0 && line[length] == ':') {
+			value = atol(line + length + 1);
+			break;
+		}
+	}
+	fclose(file);
+	return value;
+}
+
+/**
+ * Counts entries of the directory without . and .., -1 on error.
+ */
+static long countEntries(const string &path) {
+	DIR *dir = opendir(path.c_str());
+	if (dir == NULL) {
+		return -1;
+	}
+	long count = 0;
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL) {
+		count += (entry->d_name[0] != '.') ? 1 : 0;
+	}
+	closedir(dir);
+	return count;
+}
+
+/**
+ * Counts lines of the file, -1 on error.
+ */
+static long countLines(const string &path) {
+	FILE *file = fopen(path.c_str(), "r");
+	if (file == NULL) {
+		return -1;
+	}
+	long count = 0;
+	int c;
+	while ((c = fgetc(file)) != EOF) {
+		count += (c == '\n') ? 1 : 0;
+	}
+	fclose(file);
+	return count;
+}
+
+/**
+ * Returns the i-th command of the mix, about 6 % of them spawn a child.
+ * @param dir Directory for the redirections.
+ */
+static string command(long i, const string &dir) {
+	if (i % 50 == 7) {
+		return "/bin/true";
+	} else if (i % 50 == 17) {
+		return "/bin/echo soak > " + dir + "/out";
+	} else if (i % 100 == 27) {
+		return "/bin/cat < " + dir + "/out";
+	} else if (i % 500 == 37) {
+		return "/bin/true &";
+	} else if (i % 500 == 47) {
+		return "timeout 5s /bin/true";
+	}
+
+	switch (i % 6) {
+	case 0:
+		return "X=soak";
+	case 1:
+		return "if true; then Y=$X; else Y=no; fi";
+	case 2:
+		return "for W in a b c; do Z=$W; done";
+	case 3:
+		return "f A";
+	case 4:
+		return (i % 12 == 4) ? "cd " + dir : "cd /";
+	default: // Relative redirection is opened in the directory of the session
+		return (i % 12 == 5) ?
+				"cd " + dir + "; /bin/echo soak > rel" :
+				"complete -f " + dir + "/o";
+	}
+}
+
+/**
+ * Reads events until the line is done.
+ * @return False if the shell has closed the event stream.
+ */
+static bool waitDone(int fd, unsigned long seq, string &pending) {
+	char expected[64];
+	snprintf(expected, sizeof(expected), "{\"event\":\"done\",\"seq\":%lu,",
+			seq);
+
+	while (1) {
+		size_t end;
+		while ((end = pending.find('\n')) != string::npos) {
+			bool done = pending.compare(0, strlen(expected), expected) == 0;
+			pending.erase(0, end + 1);
+			if (done) {
+				return true;
+			}
+		}
+
+		char data[4096];
+		ssize_t length = read(fd, data, sizeof(data));
+		if (length <= 0) {
+			return false;
+		}
+		pending.append(data, length);
+	}
+}
+
+/**
+ * Writes the whole line.
+ */
+static bool writeLine(int fd, const string &line) {
+	size_t written = 0;
+	while (written < line.size()) {
+		ssize_t ret = write(fd, line.data() + written, line.size() - written);
+		if (ret <= 0) {
+			return false;
+		}
+		written += ret;
+	}
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	long commands = DEFAULT_COMMANDS;
+	long window = DEFAULT_WINDOW;
+	const char *shell = "./shell";
+
+	int opt;
+	while ((opt = getopt(argc, argv, "+n:w:x:")) != -1) {
+		switch (opt) {
+		case 'n':
+			commands = atol(optarg);
+			break;
+		case 'w':
+			window = atol(optarg);
+			break;
+		case 'x':
+			shell = optarg;
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-n COMMANDS] [-w WINDOW] [-x SHELL]"
+					" [-- SHELL_OPTION...]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (commands < 2 * window || window <= 0) {
+		fprintf(stderr, "At least two windows of commands are needed!\n");
+		return EXIT_FAILURE;
+	}
+
+	char dirName[] = "/tmp/soak_benchXXXXXX";
+	if (mkdtemp(dirName) == NULL) {
+		perror("mkdtemp");
+		return EXIT_FAILURE;
+	}
+	string dir(dirName);
+
+	int input[2], events[2];
+	if (pipe2(input, O_CLOEXEC) == -1 || pipe2(events, O_CLOEXEC) == -1) {
+		perror("pipe");
+		return EXIT_FAILURE;
+	}
+	signal(SIGPIPE, SIG_IGN);
+
+	vector<const char *> args;
+	args.push_back(shell);
+	args.push_back("-H");
+	args.push_back("-");
+	args.push_back("-e");
+	args.push_back("3");
+	for (int i = optind; i < argc; i++) {
+		args.push_back(argv[i]);
+	}
+	args.push_back(NULL);
+
+	pid_t pid = fork();
+	if (pid == 0) {
+		int devnull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+		dup2(input[0], STDIN_FILENO);
+		dup2(devnull, STDOUT_FILENO);
+		dup2(devnull, STDERR_FILENO);
+		dup2(events[1], EVENT_FD);
+		execv(args[0], const_cast<char * const *>(&args[0]));
+		_exit(127);
+	}
+	close(input[0]);
+	close(events[1]);
+
+	/* Children inherit only stdin, stdout, stderr and ls its directory */
+	string fdsCommand = "/bin/ls /proc/self/fd > " + dir + "/fds";
+	string pending;
+	unsigned long seq = 0;
+	const char *failure = NULL;
+
+	if (!writeLine(input[1], "f() { V=$1; }\n")
+			|| !waitDone(events[0], ++seq, pending)) {
+		failure = "shell";
+	}
+
+	long baseFds = -1, baseRss = -1;
+	double baseP99 = 0;
+	vector<double> latencies;
+	double start = seconds();
+	for (long i = 0; i < commands && failure == NULL; i++) {
+		bool sample = (i % window == window - 1);
+		string line = (sample ? fdsCommand : command(i, dir)) + "\n";
+
+		double sent = seconds();
+		if (!writeLine(input[1], line) || !waitDone(events[0], ++seq, pending)) {
+			failure = "shell";
+			break;
+		}
+		latencies.push_back((seconds() - sent) * 1e6);
+		if (!sample) {
+			continue;
+		}
+
+		sort(latencies.begin(), latencies.end());
+		double p99 = latencies[latencies.size() * 99 / 100];
+		latencies.clear();
+
+		char fdDir[64];
+		snprintf(fdDir, sizeof(fdDir), "/proc/%d/fd", (int) pid);
+		long fds = countEntries(fdDir);
+		long childFds = countLines(dir + "/fds");
+		long rss = procStatus(pid, "VmRSS");
+		printf("soak commands=%ld elapsed_s=%.1f fds=%ld child_fds=%ld"
+				" rss_kb=%ld p99_us=%.1f\n", i + 1, seconds() - start, fds,
+				childFds, rss, p99);
+		fflush(stdout);
+
+		if (baseFds < 0) { // The first window includes the warm up
+			baseFds = fds;
+			baseRss = rss;
+			baseP99 = p99;
+		} else if (fds > baseFds) {
+			failure = "fds";
+		} else if (childFds > 4) {
+			failure = "child_fds";
+		} else if (i + window >= commands
+				&& rss > baseRss * RSS_DRIFT + RSS_SLACK_KB) {
+			failure = "rss";
+		} else if (i + window >= commands
+				&& p99 > baseP99 * LATENCY_DRIFT + LATENCY_SLACK_US) {
+			failure = "latency";
+		}
+	}
+
+	close(input[1]);
+	close(events[0]);
+	int status;
+	waitpid(pid, &status, 0);
+
+	if (failure == NULL && access((dir + "/rel").c_str(), F_OK) != 0) {
+		failure = "cwd";
+	}
+	unlink((dir + "/rel").c_str());
+	unlink((dir + "/out").c_str());
+	unlink((dir + "/fds").c_str());
+	rmdir(dir.c_str());
+
+	printf("soak result=%s\n", (failure == NULL) ? "pass" : failure);
+	return (failure == NULL) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
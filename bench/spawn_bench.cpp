@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       spawn_bench.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Compares spawn latency of fork in the shell and of the fork
+//             server while the heap of the shell grows.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file spawn_bench.cpp
+ *
+ * @brief Compares spawn latency of fork in the shell and of the fork server
+ *        while the heap of the shell grows.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "../src/ForkServer.h"
+
+using namespace std;
+
+static const int SPAWNS = 200;
+static const size_t HEAP_SIZES_MB[] = { 0, 256, 1024 };
+
+static double seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Forks and executes /bin/true, like the shell does without fork server.
+ * @return Microseconds per spawn and wait.
+ */
+static double spawnByFork() {
+	char *argv[] = { const_cast<char *>("/bin/true"), NULL };
+	double start = seconds();
+	for (int i = 0; i < SPAWNS; i++) {
+		pid_t pid = fork();
+		if (pid == 0) {
+			execv(argv[0], argv);
+			_exit(127);
+		}
+		waitpid(pid, NULL, 0);
+	}
+	return (seconds() - start) * 1e6 / SPAWNS;
+}
+
+/**
+ * Executes /bin/true by the fork server.
+ * @return Microseconds per spawn and wait.
+ */
+static double spawnByForkServer(int devnull) {
+	SpawnRequest request;
+	request.argv.push_back("/bin/true");
+	request.expand = false;
+	request.background = false;
+	request.newGroup = false;
+	request.fds[0] = request.fds[1] = request.fds[2] = devnull;
+	Scheduling::clear(request.sched);
+	ResourceLimits::clear(request.limits);
+
+	double start = seconds();
+	for (int i = 0; i < SPAWNS; i++) {
+		pid_t pid = ForkServer::spawn(request);
+		if (pid <= 0 || ForkServer::wait(pid, NULL, NULL, 0) != pid) {
+			return -1;
+		}
+	}
+	return (seconds() - start) * 1e6 / SPAWNS;
+}
+
+int main() {
+	int devnull = open("/dev/null", O_RDWR | O_CLOEXEC);
+
+	/* Helper is forked while the process is small */
+	if (!ForkServer::start()) {
+		return EXIT_FAILURE;
+	}
+
+	vector<char *> heap;
+	size_t allocated = 0;
+	for (size_t i = 0; i < sizeof(HEAP_SIZES_MB) / sizeof(HEAP_SIZES_MB[0]);
+			i++) {
+		size_t size = (HEAP_SIZES_MB[i] - allocated) << 20;
+		if (size > 0) {
+			heap.push_back(static_cast<char *>(malloc(size)));
+			memset(heap.back(), 1, size); // Pages are copied on fork
+			allocated = HEAP_SIZES_MB[i];
+		}
+
+		double forkMicros = spawnByFork();
+		double serverMicros = spawnByForkServer(devnull);
+		printf("spawn variant=fork heap_mb=%lu us_per_spawn=%.1f\n",
+				(unsigned long) allocated, forkMicros);
+		printf("spawn variant=fork_server heap_mb=%lu us_per_spawn=%.1f\n",
+				(unsigned long) allocated, serverMicros);
+	}
+
+	for (size_t i = 0; i < heap.size(); i++) {
+		free(heap[i]);
+	}
+	ForkServer::stop();
+	close(devnull);
+	return EXIT_SUCCESS;
+}
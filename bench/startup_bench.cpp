@@ -0,0 +1,145 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       startup_bench.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Measures time from exec of the shell to its first prompt and
+//             its memory at the prompt.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file startup_bench.cpp
+ *
+ * @brief Measures time from exec of the shell to its first prompt and its
+ *        resident memory, virtual memory and threads at the prompt.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+static const int DEFAULT_RUNS = 200;
+
+static double seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Returns value of the field from /proc/PID/status, -1 if it is missing.
+ */
+static long procStatus(pid_t pid, const char *field) {
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/%d/status", (int) pid);
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		return -1;
+	}
+
+	long value = -1;
+	char line[256];
+	size_t length = strlen(field);
+	while (fgets(line, sizeof(line), file) != NULL) {
+		if (strncmp(line, field, length) == 0 && line[length] == ':') {
+			value = atol(line + length + 1);
+			break;
+		}
+	}
+	fclose(file);
+	return value;
+}
+
+/**
+ * Sample of one start of the shell.
+ */
+typedef struct {
+	double micros; /**< exec to the first prompt */
+	long rssKiB;
+	long vmKiB;
+	long threads;
+} Sample;
+
+/**
+ * Starts the shell, waits for its prompt, measures it and ends it by
+ * the end of its input.
+ * @return False if the shell has not printed the prompt.
+ */
+static bool measure(const char *shell, Sample &sample) {
+	int input[2], output[2];
+	if (pipe(input) == -1 || pipe(output) == -1) {
+		perror("pipe");
+		return false;
+	}
+
+	double start = seconds();
+	pid_t pid = fork();
+	if (pid == 0) {
+		dup2(input[0], STDIN_FILENO);
+		dup2(output[1], STDOUT_FILENO);
+		close(input[0]);
+		close(input[1]);
+		close(output[0]);
+		close(output[1]);
+		execl(shell, shell, "-H", "-", (char *) NULL);
+		_exit(127);
+	}
+	close(input[0]);
+	close(output[1]);
+
+	string text;
+	char data[64];
+	ssize_t length;
+	while (text.find("$ ") == string::npos
+			&& (length = read(output[0], data, sizeof(data))) > 0) {
+		text.append(data, length);
+	}
+	sample.micros = (seconds() - start) * 1e6;
+	sample.rssKiB = procStatus(pid, "VmRSS");
+	sample.vmKiB = procStatus(pid, "VmSize");
+	sample.threads = procStatus(pid, "Threads");
+
+	close(input[1]);
+	while (read(output[0], data, sizeof(data)) > 0) {
+	}
+	close(output[0]);
+	waitpid(pid, NULL, 0);
+
+	return text.find("$ ") != string::npos;
+}
+
+int main(int argc, char *argv[]) {
+	const char *shell = (argc > 1) ? argv[1] : "./shell";
+	int runs = (argc > 2) ? atoi(argv[2]) : DEFAULT_RUNS;
+
+	vector<double> latencies;
+	Sample sample;
+	for (int i = 0; i < runs; i++) {
+		if (!measure(shell, sample)) {
+			fprintf(stderr, "Shell %s has not printed the prompt!\n", shell);
+			return EXIT_FAILURE;
+		}
+		latencies.push_back(sample.micros);
+	}
+	sort(latencies.begin(), latencies.end());
+
+	printf("startup runs=%d p50_us=%.0f p99_us=%.0f rss_kb=%ld vm_kb=%ld"
+			" threads=%ld\n", runs, latencies[latencies.size() / 2],
+			latencies[latencies.size() * 99 / 100], sample.rssKiB,
+			sample.vmKiB, sample.threads);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       tasks_bench.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Measures throughput and critical path scheduling of tasks.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file tasks_bench.cpp
+ *
+ * @brief Measures tasks per second of the tasks builtin and elapsed time
+ *        of a graph with a long chain compared with its lower bound.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+static const int DEFAULT_TASKS = 500;
+static const int CHAIN = 4;
+static const int SIDE_TASKS = 8;
+static const char SLEEP[] = "0.05";
+
+static double seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Runs the tasks of the file in the shell.
+ * @return Elapsed seconds including startup of the shell, negative
+ *         on failure.
+ */
+static double runTasks(const char *shell, const string &dir,
+		const string &fileName, int jobs) {
+	int input[2];
+	if (pipe(input) == -1) {
+		perror("pipe");
+		return -1;
+	}
+
+	double start = seconds();
+	pid_t pid = fork();
+	if (pid == 0) {
+		int devnull = open("/dev/null", O_WRONLY);
+		dup2(input[0], STDIN_FILENO);
+		dup2(devnull, STDOUT_FILENO);
+		close(input[0]);
+		close(input[1]);
+		execl(shell, shell, (char *) NULL);
+		_exit(127);
+	}
+	close(input[0]);
+
+	char line[512];
+	int length = snprintf(line, sizeof(line), "cd %s\ntasks -B -j%d %s\n",
+			dir.c_str(), jobs, fileName.c_str());
+	if (write(input[1], line, length) != length) {
+		perror("write");
+	}
+	close(input[1]);
+
+	int status;
+	waitpid(pid, &status, 0);
+	return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ?
+			seconds() - start : -1;
+}
+
+int main(int argc, char *argv[]) {
+	const char *shell = (argc > 1) ? argv[1] : "./shell";
+	int tasks = (argc > 2) ? atoi(argv[2]) : DEFAULT_TASKS;
+
+	char dir[] = "/tmp/tasks_bench.XXXXXX";
+	if (mkdtemp(dir) == NULL) {
+		perror("mkdtemp");
+		return EXIT_FAILURE;
+	}
+	string flat = string(dir) + "/flat.tasks";
+	string chain = string(dir) + "/chain.tasks";
+
+	/* Independent tasks measure the overhead of the spawns and waits */
+	FILE *file = fopen(flat.c_str(), "w");
+	for (int i = 0; file != NULL && i < tasks; i++) {
+		fprintf(file, "t%d:\n\t/bin/true\n", i);
+	}
+	if (file == NULL || fclose(file) != 0) {
+		perror("Failed to write tasks");
+		return EXIT_FAILURE;
+	}
+
+	/* Side tasks come first in the file, the chain has to start first */
+	file = fopen(chain.c_str(), "w");
+	for (int i = 0; file != NULL && i < SIDE_TASKS; i++) {
+		fprintf(file, "s%d:\n\t/bin/sleep %s\n", i, SLEEP);
+	}
+	for (int i = 0; file != NULL && i < CHAIN; i++) {
+		if (i > 0) {
+			fprintf(file, "c%d: c%d\n\t/bin/sleep %s\n", i, i - 1, SLEEP);
+		} else {
+			fprintf(file, "c0:\n\t/bin/sleep %s\n", SLEEP);
+		}
+	}
+	if (file == NULL || fclose(file) != 0) {
+		perror("Failed to write tasks");
+		return EXIT_FAILURE;
+	}
+
+	int result = EXIT_SUCCESS;
+	int jobs[] = { 1, 4 };
+	for (size_t i = 0; i < sizeof(jobs) / sizeof(jobs[0]); i++) {
+		double elapsed = runTasks(shell, dir, flat, jobs[i]);
+		if (elapsed < 0) {
+			result = EXIT_FAILURE;
+			break;
+		}
+		printf("tasks flat jobs=%d tasks=%d tasks_per_s=%.0f\n", jobs[i],
+				tasks, tasks / elapsed);
+	}
+
+	/* With two jobs the bound is reached only when the chain starts first */
+	double sleep = atof(SLEEP);
+	double bound = max(CHAIN * sleep, (CHAIN + SIDE_TASKS) * sleep / 2);
+	double elapsed = runTasks(shell, dir, chain, 2);
+	if (elapsed < 0) {
+		result = EXIT_FAILURE;
+	} else {
+		printf("tasks chain jobs=2 elapsed_ms=%.0f bound_ms=%.0f\n",
+				elapsed * 1e3, bound * 1e3);
+	}
+
+	unlink(flat.c_str());
+	unlink(chain.c_str());
+	rmdir(dir);
+	if (result != EXIT_SUCCESS) {
+		fprintf(stderr, "Shell %s has failed to run the tasks!\n", shell);
+	}
+	return result;
+}
@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       trace_bench.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Measures cost of one recorded span.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file trace_bench.cpp
+ *
+ * @brief Measures cost of one recorded span.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <time.h>
+#include <unistd.h>
+
+#include "../src/Trace.h"
+
+using namespace std;
+
+/**
+ * Returns wall time in nanoseconds, ticks of the trace are not nanoseconds.
+ */
+static double wallNanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main() {
+	const char *fileName = "/tmp/shell_trace_bench.bin";
+	if (!Trace::open(fileName)) {
+		return EXIT_FAILURE;
+	}
+
+	/* Ring is drained after every batch, so no span is dropped */
+	const int batch = Trace::RING_SIZE / 2;
+	const int batches = 2000;
+
+	double best = 1e9;
+	for (int round = 0; round < 3; round++) {
+		double spent = 0;
+		for (int b = 0; b < batches; b++) {
+			double start = wallNanos();
+			for (int i = 0; i < batch; i++) {
+				Trace::record(Trace::PARSE, Trace::now());
+			}
+			spent += wallNanos() - start;
+			Trace::flush();
+		}
+
+		double perSpan = spent / ((double) batch * batches);
+		best = (perSpan < best) ? perSpan : best;
+	}
+
+	uint64_t dropped = Trace::getDropped();
+	Trace::close();
+	unlink(fileName);
+
+	printf("trace spans=%d ns_per_span=%.1f dropped=%lu\n", batch * batches,
+			best, (unsigned long) dropped);
+	return (dropped == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,1024 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       Builtins.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements commands run by the execute
+//             thread itself.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Builtins.cpp
+ *
+ * @brief Source file which implements commands run by the execute thread
+ *        itself.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <sys/stat.h>
+
+#include "Metrics.h"
+#include "MemoCache.h"
+#include "PeriodicPThread.h"
+#include "TaskGraph.h"
+#include "ChangeWatcherPThread.h"
+#include "PThread.h"
+#include "WatchdogPThread.h"
+#include "CommandExecutor.h"
+
+using namespace std;
+
+/**
+ * Table of the builtin commands.
+ */
+const CommandExecutor::Builtin CommandExecutor::BUILTINS[] = {
+		{ "parsecache", &CommandExecutor::builtinParseCache },
+		{ "time", &CommandExecutor::builtinTime },
+		{ "timing", &CommandExecutor::builtinTiming },
+		{ "stats", &CommandExecutor::builtinStats },
+		{ "monitors", &CommandExecutor::builtinMonitors },
+		{ "cd", &CommandExecutor::builtinCd },
+		{ "pwd", &CommandExecutor::builtinPwd },
+		{ "sched", &CommandExecutor::builtinSched },
+		{ "ulimit", &CommandExecutor::builtinUlimit },
+		{ "timeout", &CommandExecutor::builtinTimeout },
+		{ "history", &CommandExecutor::builtinHistory },
+		{ "complete", &CommandExecutor::builtinComplete },
+		{ "memo", &CommandExecutor::builtinMemo },
+		{ "on-change", &CommandExecutor::builtinOnChange },
+		{ "every", &CommandExecutor::builtinEvery },
+		{ "tasks", &CommandExecutor::builtinTasks },
+		{ NULL, NULL } };
+
+/**
+ * Runs builtin command if the command line starts by its name.
+ * @param commandLine Expanded command line.
+ * @param found Set whether command is a builtin.
+ * @return Exit status of the builtin.
+ */
+int CommandExecutor::runBuiltin(const string &commandLine, bool &found) {
+	found = false;
+
+	size_t start = commandLine.find_first_not_of(" \t\n");
+	if (start == string::npos) {
+		return EXIT_SUCCESS;
+	}
+	size_t end = commandLine.find_first_of(" \t\n", start);
+	string name = commandLine.substr(start, end - start);
+
+	for (const Builtin *builtin = BUILTINS; builtin->name != NULL; builtin++) {
+		if (name == builtin->name) {
+			vector<string> args;
+			BytecodeInterpreter::splitWords(commandLine, args);
+
+			found = true;
+			return (this->*builtin->handler)(args, commandLine);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Returns rest of the command line after skipping words.
+ * @param commandLine Command line.
+ * @param count Number of skipped words.
+ * @return Rest of the command line, quotes are kept.
+ */
+string CommandExecutor::skipWords(const string &commandLine, size_t count) {
+	size_t i = 0;
+	char quote = '\0';
+
+	for (; count > 0; count--) {
+		i = commandLine.find_first_not_of(" \t", i);
+		while (i < commandLine.size()) {
+			char c = commandLine[i];
+			if (quote == '\0' && (c == ' ' || c == '\t')) {
+				break;
+			} else if (c == '\\' && quote != '\'') {
+				i++;
+			} else if (quote == '\0' && (c == '\'' || c == '"')) {
+				quote = c;
+			} else if (c == quote) {
+				quote = '\0';
+			}
+			i++;
+		}
+	}
+
+	return (i < commandLine.size()) ? commandLine.substr(i) : "";
+}
+
+/**
+ * Prints statistics of the cache of parsed commands, -c clears the cache.
+ * @param args Arguments of the builtin.
+ * @return Exit status.
+ */
+int CommandExecutor::builtinParseCache(const vector<string> &args,
+		const string &) {
+	if (args.size() > 1 && args[1] == "-c") {
+		commandCache.clear();
+		return EXIT_SUCCESS;
+	} else if (args.size() > 1) {
+		*err << "Usage: parsecache [-c]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	unsigned long hits = commandCache.getHits();
+	unsigned long misses = commandCache.getMisses();
+	double perParse = (parseCount > 0) ? parseTime / parseCount : 0;
+
+	*out << "parse cache: " << commandCache.size() << "/"
+			<< commandCache.getCapacity() << " entries, hits " << hits
+			<< ", misses " << misses << ", hit rate " << fixed
+			<< setprecision(1)
+			<< ((hits + misses > 0) ? 100.0 * hits / (hits + misses) : 0.0)
+			<< " %, saved " << setprecision(3) << perParse * hits * 1000
+			<< " ms" << endl;
+	out->unsetf(ios::floatfield);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Runs command and prints its wall time and resource usage to stderr.
+ * @param args Arguments of the builtin.
+ * @param commandLine Whole command line.
+ * @return Exit status of the command.
+ */
+int CommandExecutor::builtinTime(const vector<string> &args,
+		const string &commandLine) {
+	if (args.size() < 2) {
+		*err << "Usage: time COMMAND [ARGS...]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	struct timespec start, end;
+	char line[160];
+	unsigned long finishedBefore = foregroundCount;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	int status = runCommand(skipWords(commandLine, 1));
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	if (foregroundCount != finishedBefore) {
+		snprintf(line, sizeof(line),
+				"real %.3fs user %.3fs sys %.3fs maxrss %ldKB ctxsw %ld/%ld\n",
+				JobTable::realTime(lastJob),
+				lastJob.usage.ru_utime.tv_sec
+						+ lastJob.usage.ru_utime.tv_usec / 1e6,
+				lastJob.usage.ru_stime.tv_sec
+						+ lastJob.usage.ru_stime.tv_usec / 1e6,
+				lastJob.usage.ru_maxrss, lastJob.usage.ru_nvcsw,
+				lastJob.usage.ru_nivcsw);
+	} else { // Builtin or command on background
+		snprintf(line, sizeof(line), "real %.3fs\n",
+				(end.tv_sec - start.tv_sec)
+						+ (end.tv_nsec - start.tv_nsec) / 1e9);
+	}
+	*err << line << flush;
+
+	return status;
+}
+
+/**
+ * Sets log where resource usage of every command is written.
+ * @param args Arguments of the builtin - file name, "-" or "off".
+ * @return Exit status.
+ */
+int CommandExecutor::builtinTiming(const vector<string> &args,
+		const string &) {
+	if (args.size() != 2) {
+		*err << "Usage: timing FILE|-|off" << endl;
+		return EXIT_FAILURE;
+	}
+
+	return setTimingLog((args[1] == "off") ? "" : args[1]) ?
+			EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Prints runtime metrics in Prometheus text format.
+ * @return Exit status.
+ */
+int CommandExecutor::builtinStats(const vector<string> &, const string &) {
+	*out << Metrics::format() << flush;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Prints statistics of the monitors or switches their collecting.
+ * @param args Arguments of the builtin - nothing, "on" or "off".
+ * @return Exit status.
+ */
+int CommandExecutor::builtinMonitors(const vector<string> &args,
+		const string &) {
+	if (args.size() == 2 && (args[1] == "on" || args[1] == "off")) {
+		PThreadMonitor::setInstrumented(args[1] == "on");
+		return EXIT_SUCCESS;
+	} else if (args.size() != 1) {
+		*err << "Usage: monitors [on|off]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	if (!PThreadMonitor::isInstrumented()) {
+		*err << "Statistics of monitors are not collected, run monitors on"
+				<< " or start shell with -M" << endl;
+	}
+	*out << PThreadMonitor::dump() << flush;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Changes working directory of the session, children are started there.
+ * @param args Arguments of the builtin - directory or nothing for HOME.
+ * @return Exit status.
+ */
+int CommandExecutor::builtinCd(const vector<string> &args, const string &) {
+	if (args.size() > 2) {
+		*err << "Usage: cd [DIR]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	string dir;
+	if (args.size() == 2) {
+		dir = args[1];
+	} else {
+		const char *home = getenv("HOME");
+		dir = (home != NULL) ? home : "/";
+	}
+	if (dir[0] != '/') {
+		dir = getCwd() + "/" + dir;
+	}
+
+	char *resolved = realpath(dir.c_str(), NULL);
+	struct stat st;
+	if (resolved == NULL || stat(resolved, &st) == -1 || !S_ISDIR(st.st_mode)) {
+		*err << "cd: " << args.back() << ": No such directory" << endl;
+		free(resolved);
+		return EXIT_FAILURE;
+	}
+	cwd = resolved;
+	free(resolved);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Prints working directory of the session.
+ * @return Exit status.
+ */
+int CommandExecutor::builtinPwd(const vector<string> &, const string &) {
+	*out << getCwd() << endl;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Runs command with CPU affinity, nice value, scheduling policy and I/O
+ * priority, or sets them as default of the background children (-b).
+ * Attributes of the command override the default.
+ * @param args Arguments of the builtin.
+ * @param commandLine Whole command line.
+ * @return Exit status of the command.
+ */
+int CommandExecutor::builtinSched(const vector<string> &args,
+		const string &commandLine) {
+	if (args.size() == 1) {
+		*out << "background: "
+				<< (Scheduling::isEmpty(backgroundSched) ?
+						"none" : Scheduling::format(backgroundSched)) << endl;
+		return EXIT_SUCCESS;
+	}
+
+	bool background = args[1] == "-b";
+	if (background && args.size() == 3 && args[2] == "off") {
+		Scheduling::clear(backgroundSched);
+		return EXIT_SUCCESS;
+	}
+
+	SchedAttrs attrs;
+	Scheduling::clear(attrs);
+	size_t i = background ? 2 : 1;
+	for (; i < args.size() && args[i][0] == '-'; i += 2) {
+		string error;
+		if (i + 1 >= args.size()
+				|| !Scheduling::parseOption(args[i], args[i + 1], attrs, error)) {
+			*err << "sched: " << (error.empty() ? "missing value" : error)
+					<< endl;
+			i = args.size() + 1; // Prints usage
+			break;
+		}
+	}
+	if (i > args.size() || (background == (i < args.size()))
+			|| Scheduling::isEmpty(attrs)) {
+		*err << "Usage: sched [-c CPUS] [-n NICE] [-p POLICY[:PRIO]]"
+				<< " [-i CLASS[:LEVEL]] COMMAND [ARGS...]" << endl
+				<< "       sched -b OPTIONS|off" << endl;
+		return EXIT_FAILURE;
+	}
+
+	if (background) {
+		backgroundSched = attrs;
+		return EXIT_SUCCESS;
+	}
+
+	SchedAttrs outer = commandSched; // Restored for nested prefixes
+	Scheduling::merge(commandSched, attrs);
+	int status = runCommand(skipWords(commandLine, i));
+	commandSched = outer;
+	return status;
+}
+
+/**
+ * Runs command with limited CPU time, address space, open files and
+ * processes, or sets the limits as default of all children of the session
+ * when no command is given. Limits of the command override the default.
+ * @param args Arguments of the builtin.
+ * @param commandLine Whole command line.
+ * @return Exit status of the command.
+ */
+int CommandExecutor::builtinUlimit(const vector<string> &args,
+		const string &commandLine) {
+	if (args.size() == 1) {
+		*out << "session: "
+				<< (ResourceLimits::isEmpty(sessionLimits) ?
+						"none" : ResourceLimits::format(sessionLimits)) << endl;
+		return EXIT_SUCCESS;
+	}
+
+	if (args.size() == 2 && args[1] == "off") {
+		ResourceLimits::clear(sessionLimits);
+		return EXIT_SUCCESS;
+	}
+
+	LimitAttrs attrs;
+	ResourceLimits::clear(attrs);
+	size_t i = 1;
+	for (; i < args.size() && args[i][0] == '-'; i += 2) {
+		string error;
+		if (i + 1 >= args.size()
+				|| !ResourceLimits::parseOption(args[i], args[i + 1], attrs,
+						error)) {
+			*err << "ulimit: " << (error.empty() ? "missing value" : error)
+					<< endl;
+			i = args.size() + 1; // Prints usage
+			break;
+		}
+	}
+	if (i > args.size() || ResourceLimits::isEmpty(attrs)) {
+		*err << "Usage: ulimit [-t SECONDS] [-v KIB] [-n FILES] [-u PROCESSES]"
+				<< " [COMMAND [ARGS...]]" << endl << "       ulimit off" << endl;
+		return EXIT_FAILURE;
+	}
+
+	if (i == args.size()) {
+		ResourceLimits::merge(sessionLimits, attrs);
+		return EXIT_SUCCESS;
+	}
+
+	LimitAttrs outer = commandLimits; // Restored for nested prefixes
+	ResourceLimits::merge(commandLimits, attrs);
+	int status = runCommand(skipWords(commandLine, i));
+	commandLimits = outer;
+	return status;
+}
+
+/**
+ * Runs command which gets SIGTERM when it has not finished in time
+ * and SIGKILL after the kill delay. Child is placed to its own process group,
+ * which is signalled, so the whole pipeline of the command is terminated.
+ * Exit status is 124 when the command has timed out.
+ * @param args Arguments of the builtin.
+ * @param commandLine Whole command line.
+ * @return Exit status of the command.
+ */
+int CommandExecutor::builtinTimeout(const vector<string> &args,
+		const string &commandLine) {
+	long timeout = 0, killAfter = WatchdogPThread::DEFAULT_KILL_AFTER;
+	size_t i = 1;
+	bool valid = true;
+	if (args.size() > 2 && args[1] == "-k") {
+		valid = WatchdogPThread::parseDuration(args[2], killAfter);
+		i = 3;
+	}
+	if (!valid || i + 1 >= args.size()
+			|| !WatchdogPThread::parseDuration(args[i], timeout)) {
+		*err << "Usage: timeout [-k KILL_AFTER] DURATION COMMAND [ARGS...]"
+				<< endl
+				<< "       duration is number with suffix ms, s, m, h or d"
+				<< endl;
+		return EXIT_FAILURE;
+	}
+
+	long outerTimeout = commandTimeout, outerKillAfter = commandKillAfter;
+	if (timeout > 0 && (commandTimeout == 0 || timeout < commandTimeout)) {
+		commandTimeout = timeout; // The nearest deadline of nested prefixes
+		commandKillAfter = killAfter;
+	}
+	int status = runCommand(skipWords(commandLine, i + 1));
+	commandTimeout = outerTimeout;
+	commandKillAfter = outerKillAfter;
+	return status;
+}
+
+/**
+ * Prints the newest N entries of the history (all by default), or the unique
+ * entries containing TEXT, the newest first (-s).
+ * @param args Arguments of the builtin.
+ * @return Exit status.
+ */
+int CommandExecutor::builtinHistory(const vector<string> &args,
+		const string &) {
+	if (history == NULL) {
+		*err << "history: history is not kept, see -H option" << endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<HistoryEntry> entries;
+	char *end = NULL;
+	if (args.size() == 3 && args[1] == "-s") {
+		history->search(args[2], entries);
+	} else if (args.size() == 1
+			|| (args.size() == 2 && strtol(args[1].c_str(), &end, 10) >= 0
+					&& *end == '\0')) {
+		history->last((args.size() == 2) ? atol(args[1].c_str()) : (size_t) -1,
+				entries);
+	} else {
+		*err << "Usage: history [N]" << endl << "       history -s TEXT" << endl;
+		return EXIT_FAILURE;
+	}
+
+	for (size_t i = 0; i < entries.size(); i++) {
+		*out << setw(6) << entries[i].first << "  " << entries[i].second
+				<< endl;
+	}
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Prints completions of the last word, one per line. The first word
+ * is completed by the names of the commands, other words and words with
+ * slash (or any word with -f) by the file names.
+ * @param args Arguments of the builtin - words of the completed line.
+ * @return Exit status, failure when there is no completion.
+ */
+int CommandExecutor::builtinComplete(const vector<string> &args,
+		const string &) {
+	bool files = args.size() > 1 && args[1] == "-f";
+	vector<string> words(args.begin() + (files ? 2 : 1), args.end());
+	if (words.empty()) {
+		*err << "Usage: complete [-f] WORD..." << endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<string> candidates;
+	if (files) {
+		completer.completeFile(words.back(), getCwd(), candidates);
+	} else {
+		vector<string> builtins;
+		for (const Builtin *builtin = BUILTINS; builtin->name != NULL;
+				builtin++) {
+			builtins.push_back(builtin->name);
+		}
+		completer.complete(words, getCwd(), builtins, candidates);
+	}
+
+	for (size_t i = 0; i < candidates.size(); i++) {
+		*out << candidates[i] << endl;
+	}
+	return candidates.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * Runs command whose output is cached, or serves its cached output and exit
+ * status without running it. Output is keyed by the command line, working
+ * directory, PATH, locale, variables given by -e and identity (device,
+ * inode, size and mtime) of the input files and of the files given by -d.
+ * Output of the command which has run is served after it has finished.
+ * Statuses from 124 up (timeout, exec failure, signal) are not cached.
+ * @param args Arguments of the builtin.
+ * @param commandLine Whole command line.
+ * @return Exit status of the command.
+ */
+int CommandExecutor::builtinMemo(const vector<string> &args,
+		const string &commandLine) {
+	if (args.size() == 2 && args[1] == "-s") {
+		*out << "memo: hits " << Metrics::total(Metrics::MEMO_HITS)
+				<< ", misses " << Metrics::total(Metrics::MEMO_MISSES)
+				<< ", served " << Metrics::total(Metrics::MEMO_SERVED_BYTES)
+				<< " bytes, store " << MemoCache::size() << "/"
+				<< MemoCache::MAX_SIZE << " bytes in " << MemoCache::getDir()
+				<< endl;
+		return EXIT_SUCCESS;
+	} else if (args.size() == 2 && args[1] == "-c") {
+		return MemoCache::clear() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	vector<string> files, names;
+	size_t i = 1;
+	for (; i + 1 < args.size() && (args[i] == "-d" || args[i] == "-e"); i +=
+			2) {
+		(args[i] == "-d" ? files : names).push_back(args[i + 1]);
+	}
+	if (i >= args.size() || args[i][0] == '-') {
+		*err << "Usage: memo [-d FILE]... [-e NAME]... COMMAND [ARGS...]"
+				<< endl << "       memo -s|-c" << endl;
+		return EXIT_FAILURE;
+	}
+	for (const Builtin *builtin = BUILTINS; builtin->name != NULL; builtin++) {
+		if (args[i] == builtin->name) {
+			*err << "memo: builtin " << args[i] << " cannot be memoized"
+					<< endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	string memoized = skipWords(commandLine, i);
+	const CommandInfo *cmdInfo = parseCommand(memoized);
+	if (cmdInfo == NULL) {
+		Metrics::increment(Metrics::PARSE_FAILURES);
+		*err << "Typed invalid command!" << endl;
+		return EXIT_FAILURE;
+	}
+	for (size_t r = 0; r < cmdInfo->redirects.size(); r++) {
+		files.push_back(cmdInfo->redirects[r].fileName);
+		if (cmdInfo->redirects[r].isOut || cmdInfo->runOnBackground) {
+			*err << "memo: output of the command on background or redirected"
+					<< " into file cannot be cached" << endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	uint64_t key = memoKey(memoized, files, names);
+	int cached, status;
+	if (MemoCache::lookup(key, cached, status)) {
+		Metrics::increment(Metrics::MEMO_HITS);
+		Metrics::increment(Metrics::MEMO_SERVED_BYTES, serveOutput(cached));
+		close(cached);
+		return status;
+	}
+
+	/* Output of the child is captured into the store and served from it */
+	Metrics::increment(Metrics::MEMO_MISSES);
+	Metrics::increment(Metrics::COMMANDS_PARSED);
+	string tempName;
+	captureFd = MemoCache::createTemp(tempName);
+	int captured = captureFd;
+	bool periodic = periodicRun; // Output is served after the run
+	periodicRun = false;
+	status = executeCommand(*cmdInfo);
+	periodicRun = periodic;
+	spawnedPid = 0;
+	captureFd = -1;
+
+	if (captured != -1) {
+		serveOutput(captured);
+		if (status < EXIT_TIMED_OUT) {
+			MemoCache::store(key, captured, tempName, status);
+		} else {
+			MemoCache::discard(captured, tempName);
+		}
+	}
+	return status;
+}
+
+/**
+ * Runs command whenever the watched files change, until it has run COUNT
+ * times (-n) or the shell is stopped. Changes during the run are coalesced
+ * into one run after it, or they terminate the run (-k), which is started
+ * again.
+ * @param args Arguments of the builtin.
+ * @param commandLine Whole command line.
+ * @return Exit status of the last run.
+ */
+int CommandExecutor::builtinOnChange(const vector<string> &args,
+		const string &commandLine) {
+	long debounce = ChangeWatcherPThread::DEFAULT_DEBOUNCE, count = 0;
+	bool cancelRun = false, valid = true;
+	size_t i = 1;
+	for (; valid && i < args.size() && args[i][0] == '-'; i++) {
+		char *end = NULL;
+		if (args[i] == "-k") {
+			cancelRun = true;
+		} else if (args[i] == "-d" && i + 1 < args.size()) {
+			valid = WatchdogPThread::parseDuration(args[++i], debounce);
+		} else if (args[i] == "-n" && i + 1 < args.size()) {
+			count = strtol(args[++i].c_str(), &end, 10);
+			valid = count > 0 && *end == '\0';
+		} else {
+			valid = false;
+		}
+	}
+	if (!valid || i + 1 >= args.size()) {
+		*err << "Usage: on-change [-d DEBOUNCE] [-k] [-n COUNT] PATH[:PATH...]"
+				<< " COMMAND [ARGS...]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	ChangeWatcherPThread watcher(debounce, cancelRun);
+	string paths = args[i] + ":";
+	for (size_t start = 0, end; (end = paths.find(':', start)) != string::npos;
+			start = end + 1) {
+		string path = paths.substr(start, end - start);
+		if (!path.empty()
+				&& !watcher.watch((path[0] == '/') ? path : getCwd() + "/" + path)) {
+			*err << "on-change: " << path << ": Cannot be watched" << endl;
+			return EXIT_FAILURE;
+		}
+	}
+	watcher.start();
+
+	ChangeWatcherPThread *outer = changeWatcher; // Restored for nested prefixes
+	changeWatcher = &watcher;
+	string command = skipWords(commandLine, i + 1);
+	int status = EXIT_SUCCESS;
+	for (long runs = 0; (count == 0 || runs < count) && watcher.waitChange();
+			runs++) {
+		status = runCommand(command);
+	}
+	changeWatcher = outer;
+	return status;
+}
+
+/**
+ * Adds command which is run every INTERVAL, the first run starts at once.
+ * Ticks are absolute, so the runs do not drift. When the previous run has
+ * not exited at the tick, the run is skipped (default), queued or started
+ * in parallel (-o). Without arguments lists the periodic commands, -c cancels
+ * the command and terminates its running runs.
+ * @param args Arguments of the builtin.
+ * @param commandLine Whole command line.
+ * @return Exit status, failure on invalid arguments.
+ */
+int CommandExecutor::builtinEvery(const vector<string> &args,
+		const string &commandLine) {
+	PeriodicOwner *owner = dynamic_cast<PeriodicOwner *>(this);
+	if (owner == NULL) {
+		*err << "every: periodic commands are run only by the terminal shell"
+				<< endl;
+		return EXIT_FAILURE;
+	}
+
+	char *end = NULL;
+	if (args.size() == 1) {
+		*out << PeriodicPThread::list(owner);
+		return EXIT_SUCCESS;
+	} else if (args.size() == 3 && args[1] == "-c") {
+		long id = strtol(args[2].c_str(), &end, 10);
+		vector<pid_t> running;
+		if (*end != '\0' || !PeriodicPThread::remove(owner, id, running)) {
+			*err << "every: " << args[2] << ": No such periodic command"
+					<< endl;
+			return EXIT_FAILURE;
+		}
+		for (size_t i = 0; i < running.size(); i++) {
+			kill(running[i], SIGTERM);
+		}
+		return EXIT_SUCCESS;
+	}
+
+	PeriodicPThread::Overlap overlap = PeriodicPThread::SKIP;
+	long interval = 0;
+	bool valid = true;
+	size_t i = 1;
+	if (args.size() > 2 && args[1] == "-o") {
+		valid = PeriodicPThread::parseOverlap(args[2], overlap);
+		i = 3;
+	}
+	if (!valid || i + 1 >= args.size()
+			|| !WatchdogPThread::parseDuration(args[i], interval)
+			|| interval <= 0) {
+		*err << "Usage: every [-o skip|queue|parallel] INTERVAL COMMAND"
+				<< " [ARGS...]" << endl << "       every [-c ID]" << endl;
+		return EXIT_FAILURE;
+	}
+	if (args[i + 1] == "every" || args[i + 1] == "on-change") {
+		*err << "every: " << args[i + 1] << " cannot be run periodically"
+				<< endl;
+		return EXIT_FAILURE;
+	}
+
+	string command = skipWords(commandLine, i + 1);
+	command.erase(0, command.find_first_not_of(" \t"));
+	bool builtin = false;
+	for (const Builtin *b = BUILTINS; b->name != NULL; b++) {
+		builtin = builtin || args[i + 1] == b->name;
+	}
+	if (!builtin && parseCommand(command) == NULL) {
+		Metrics::increment(Metrics::PARSE_FAILURES);
+		*err << "Typed invalid command!" << endl;
+		return EXIT_FAILURE;
+	}
+
+	*out << "[" << PeriodicPThread::add(owner, command, interval, overlap)
+			<< "]" << endl;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Runs tasks of the dependency graph read from FILE (see TaskGraph), all
+ * tasks or those needed by the TARGETs. At most JOBS commands run
+ * in parallel (-j, number of processors by default), ready tasks with
+ * the longest critical path start first. Task whose target file is not
+ * older than its dependencies is skipped unless -B is given. After
+ * a failure no other task is started, with -k tasks which do not depend
+ * on the failed one still run.
+ * @param args Arguments of the builtin.
+ * @return Exit status of the first failed command.
+ */
+int CommandExecutor::builtinTasks(const vector<string> &args,
+		const string &) {
+	long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	bool keepGoing = false, force = false, valid = true;
+	size_t i = 1;
+	for (; valid && i < args.size() && args[i][0] == '-'; i++) {
+		char *end = NULL;
+		if (args[i] == "-k") {
+			keepGoing = true;
+		} else if (args[i] == "-B") {
+			force = true;
+		} else if (args[i].compare(0, 2, "-j") == 0
+				&& (args[i].size() > 2 || i + 1 < args.size())) {
+			jobs = strtol((args[i].size() > 2) ?
+					args[i].c_str() + 2 : args[++i].c_str(), &end, 10);
+			valid = jobs > 0 && jobs <= (long) MAX_TASK_JOBS && *end == '\0';
+		} else {
+			valid = false;
+		}
+	}
+	if (!valid || i >= args.size()) {
+		*err << "Usage: tasks [-j JOBS] [-k] [-B] FILE [TARGET...]" << endl;
+		return EXIT_FAILURE;
+	}
+	jobs = (jobs > 0 && jobs <= (long) MAX_TASK_JOBS) ? jobs : 1;
+
+	TaskGraph graph;
+	string error, cwd = getCwd();
+	vector<string> targets(args.begin() + i + 1, args.end());
+	if (!graph.load((args[i][0] == '/') ? args[i] : cwd + "/" + args[i], error)
+			|| !graph.select(targets, cwd, error)) {
+		*err << "tasks: " << error << endl;
+		return EXIT_FAILURE;
+	}
+
+	/* Commands are checked before anything runs */
+	for (size_t t = 0; t < graph.size(); t++) {
+		const vector<string> &commands = graph[t].commands;
+		for (size_t c = 0; graph[t].selected && c < commands.size(); c++) {
+			const Builtin *builtin = BUILTINS;
+			for (; builtin->name != NULL
+					&& commands[c].compare(0, commands[c].find_first_of(" \t"),
+							builtin->name) != 0; builtin++) {
+			}
+			if (builtin->name != NULL || parseCommand(commands[c]) == NULL) {
+				*err << "tasks: " << graph[t].target << ": Invalid command "
+						<< commands[c] << endl;
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	bool periodic = periodicRun; // Tasks are waited for even in periodic run
+	periodicRun = false;
+	int status = runTasks(graph, jobs, keepGoing, force);
+	periodicRun = periodic;
+	spawnedPid = 0;
+	return status;
+}
+
+/**
+ * Computes key of the memoized command.
+ * @param commandLine Expanded command line.
+ * @param files Files whose identity is part of the key.
+ * @param names Variables of the environment which are part of the key.
+ * @return Hash of the command and of everything its output depends on.
+ */
+uint64_t CommandExecutor::memoKey(const string &commandLine, const vector<string> &files,
+		const vector<string> &names) {
+	static const char * const ENVIRONMENT[] = { "PATH", "LANG", "LC_ALL", NULL };
+	string cwd = getCwd();
+
+	uint64_t key = MemoCache::hash(commandLine);
+	key = MemoCache::hash(key, string(1, '\0') + cwd);
+
+	vector<string> variables(names);
+	for (const char * const *name = ENVIRONMENT; *name != NULL; name++) {
+		variables.push_back(*name);
+	}
+	for (size_t i = 0; i < variables.size(); i++) {
+		const char *value = getenv(variables[i].c_str());
+		key = MemoCache::hash(key,
+				string(1, '\0') + variables[i]
+						+ ((value != NULL) ? string("=") + value : ""));
+	}
+
+	for (size_t i = 0; i < files.size(); i++) {
+		string path = (files[i][0] == '/') ? files[i] : cwd + "/" + files[i];
+		struct stat st;
+		char identity[128] = "missing";
+		if (stat(path.c_str(), &st) == 0) {
+			snprintf(identity, sizeof(identity), "%lu:%lu:%ld:%ld.%09ld",
+					(unsigned long) st.st_dev, (unsigned long) st.st_ino,
+					(long) st.st_size, (long) st.st_mtim.tv_sec,
+					(long) st.st_mtim.tv_nsec);
+		}
+		key = MemoCache::hash(key, string(1, '\0') + path + "@" + identity);
+	}
+	return key;
+}
+
+/**
+ * Runs ready tasks of the selected graph, their commands are spawned
+ * without waiting and their exits are watched by pidfd.
+ * @param graph Graph whose tasks have been selected.
+ * @param jobs Maximum of the running commands.
+ * @param keepGoing Whether tasks independent of the failed one still run.
+ * @param force Whether tasks run even when their targets are up to date.
+ * @return Exit status of the first failed command.
+ */
+int CommandExecutor::runTasks(TaskGraph &graph, size_t jobs, bool keepGoing,
+		bool force) {
+	/* Children are waited for by PID, the handler must not reap them */
+	sigset_t oldmask;
+	PThread::blockChildSignal(&oldmask);
+
+	string cwd = getCwd();
+	vector<size_t> nextCommand(graph.size(), 0);
+	vector<struct pollfd> polls; // Running commands
+	vector<pid_t> pids;
+	vector<size_t> owners;
+	vector<size_t> continuing; // Tasks with the next command
+	size_t task, finished = 0, selected = 0, failures = 0;
+	int status = EXIT_SUCCESS;
+	for (size_t t = 0; t < graph.size(); t++) {
+		selected += graph[t].selected ? 1 : 0;
+	}
+
+	while (1) {
+		/* Task whose command has finished starts the next one, ready tasks
+		 * start the first one */
+		while (pids.size() < jobs && (failures == 0 || keepGoing)) {
+			if (!continuing.empty()) {
+				task = continuing.back();
+				continuing.pop_back();
+			} else if (!graph.takeReady(task)) {
+				break;
+			} else if (graph[task].commands.empty()
+					|| (!force && graph.isUpToDate(task, cwd))) {
+				graph.finish(task, false);
+				finished++;
+				continue;
+			}
+
+			const string &command = graph[task].commands[nextCommand[task]++];
+			*out << command << endl;
+			const CommandInfo *cmdInfo = parseCommand(command);
+			spawnedPid = 0;
+			parallelRun = true;
+			if (cmdInfo != NULL) {
+				Metrics::increment(Metrics::COMMANDS_PARSED);
+				executeCommand(*cmdInfo);
+			}
+			parallelRun = false;
+
+			/* Fails also for the child which has been reaped by the fork server
+			 * or without pidfd, then it is waited for at once */
+			struct pollfd exit;
+			exit.fd = (spawnedPid > 0) ? syscall(SYS_pidfd_open, spawnedPid, 0) : -1;
+			exit.events = POLLIN;
+			exit.revents = 0;
+			polls.push_back(exit);
+			pids.push_back(spawnedPid);
+			owners.push_back(task);
+		}
+		if (pids.empty()) {
+			break;
+		}
+
+		size_t done = 0;
+		while (done < polls.size() && polls[done].fd != -1) {
+			done++;
+		}
+		if (done == polls.size()) { // Stop of the executor is polled last
+			struct pollfd stop;
+			stop.fd = getStopFd();
+			stop.events = POLLIN;
+			polls.push_back(stop);
+			while (poll(&polls[0], polls.size(), -1) == -1 && errno == EINTR) {
+			}
+			stop = polls.back();
+			polls.pop_back();
+			if (stop.revents != 0) { // Running commands are signalled
+				for (size_t i = 0; i < pids.size(); i++) {
+					Job *job = (pids[i] > 0) ? jobTable.find(pids[i]) : NULL;
+					if (job != NULL) {
+						waitJob(job);
+					}
+					if (polls[i].fd != -1) {
+						close(polls[i].fd);
+					}
+				}
+				status = (failures++ == 0) ? (int) EXIT_STOPPED : status;
+				break;
+			}
+			done = 0;
+			while (done + 1 < polls.size() && polls[done].revents == 0) {
+				done++;
+			}
+		}
+
+		int commandStatus = EXIT_FAILURE;
+		Job *job = (pids[done] > 0) ? jobTable.find(pids[done]) : NULL;
+		if (job != NULL) {
+			commandStatus = waitJob(job);
+		}
+		if (polls[done].fd != -1) {
+			close(polls[done].fd);
+		}
+		task = owners[done];
+		polls.erase(polls.begin() + done);
+		pids.erase(pids.begin() + done);
+		owners.erase(owners.begin() + done);
+
+		if (commandStatus != EXIT_SUCCESS) {
+			*err << "tasks: " << graph[task].target << " failed with status "
+					<< commandStatus << endl;
+			status = (failures++ == 0) ? commandStatus : status;
+		} else if (nextCommand[task] < graph[task].commands.size()) {
+			continuing.push_back(task);
+		} else {
+			graph.finish(task, true);
+			finished++;
+		}
+	}
+
+	pthread_sigmask(SIG_SETMASK, &oldmask, NULL);
+	if (finished < selected) {
+		*err << "tasks: " << selected - finished << " of " << selected
+				<< " tasks have not finished" << endl;
+	}
+	return (failures > 0) ? status : EXIT_SUCCESS;
+}
+
+/**
+ * Sends the file into stdout of the session by sendfile, so the output is
+ * not copied through the shell. SIGPIPE of the closed stdout is discarded.
+ * @param fd Output of the command.
+ * @return Number of the sent bytes.
+ */
+off_t CommandExecutor::serveOutput(int fd) {
+	int fds[3];
+	getChildDescriptors(fds);
+	*out << flush;
+
+	struct stat st;
+	if (fstat(fd, &st) == -1) {
+		return 0;
+	}
+
+	sigset_t mask, oldmask;
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &mask, &oldmask);
+
+	int output = fds[STDOUT_FILENO];
+	off_t offset = 0;
+	ssize_t count = 0;
+	while (offset < st.st_size
+			&& ((count = sendfile(output, fd, &offset, st.st_size - offset)) > 0
+					|| (count == -1 && errno == EINTR))) {
+	}
+	if (count == -1 && (errno == EINVAL || errno == ENOSYS)) {
+		char data[64 * 1024]; // Output opened for append is copied
+		while (offset < st.st_size
+				&& (count = pread(fd, data, sizeof(data), offset)) > 0
+				&& (count = write(output, data, count)) > 0) {
+			offset += count;
+		}
+	}
+	if (count == -1 && errno != EPIPE) {
+		*err << "memo: failed to send output: " << strerror(errno) << endl;
+	}
+
+	struct timespec zero = { 0, 0 };
+	while (sigtimedwait(&mask, NULL, &zero) == SIGPIPE) {
+	}
+	pthread_sigmask(SIG_SETMASK, &oldmask, NULL);
+	return offset;
+}
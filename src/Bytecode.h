@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       Bytecode.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines bytecode of the compiled scripts.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Bytecode.h
+ *
+ * @brief Header file which defines bytecode of the compiled scripts.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef BYTECODE_H_INCLUDED
+#define BYTECODE_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Instructions of the bytecode. Operands are stored in a and b.
+ */
+enum Opcode {
+	OP_EXEC, /**< a = template of the command line */
+	OP_ASSIGN, /**< a = variable slot, b = template of the value */
+	OP_STATUS, /**< a = new exit status */
+	OP_JUMP, /**< a = target */
+	OP_JUMP_FALSE, /**< a = target, jumps when exit status is not zero */
+	OP_FOR_BEGIN, /**< a = list of the words */
+	OP_RANGE_BEGIN, /**< a = template of lower bound, b = upper bound */
+	OP_LOOP_NEXT, /**< a = variable slot, b = target when loop is exhausted */
+	OP_LOOP_POP, /**< removes state of the innermost loop */
+	OP_NEGATE, /**< negates exit status */
+	OP_DEFUN, /**< a = function */
+	OP_RETURN, /**< a = template of the exit status, -1 keeps status */
+	OP_EXIT /**< a = template of the exit code, -1 keeps status */
+};
+
+/**
+ * One instruction of the bytecode.
+ */
+typedef struct {
+	Opcode op;
+	int a;
+	int b;
+} Instruction;
+
+/**
+ * Part of the word or command line which is expanded during the execution.
+ */
+typedef struct {
+	enum {
+		LITERAL, VARIABLE, POSITIONAL, STATUS, ARG_COUNT
+	} type;
+	string text; /**< literal text or name of the variable */
+	int index; /**< variable slot or number of positional parameter */
+} Segment;
+
+typedef vector<Segment> Template;
+
+/**
+ * Word of the for list.
+ */
+typedef struct {
+	Template value;
+	bool split; /**< unquoted word is split by whitespaces after expansion */
+} ListWord;
+
+struct Program;
+
+/**
+ * Function defined by the script, its body is compiled only once. Body is
+ * owned by the function and copied with it, program of the body contains
+ * functions itself, so it cannot be stored by value.
+ */
+struct Function {
+	string name;
+	Program *body;
+
+	Function();
+	Function(const Function &function);
+	Function &operator=(const Function &function);
+	~Function();
+};
+
+/**
+ * Compiled program - top level command line or body of the function.
+ */
+struct Program {
+	vector<Instruction> code;
+	vector<Template> templates;
+	vector<vector<ListWord> > lists;
+	vector<Function> functions;
+};
+
+inline Function::Function() :
+		body(new Program()) {
+}
+
+inline Function::Function(const Function &function) :
+		name(function.name), body(new Program(*function.body)) {
+}
+
+inline Function &Function::operator=(const Function &function) {
+	Program *copy = new Program(*function.body);
+	delete body;
+	body = copy;
+	name = function.name;
+	return *this;
+}
+
+inline Function::~Function() {
+	delete body;
+}
+
+#endif // BYTECODE_H_INCLUDED
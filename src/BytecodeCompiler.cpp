@@ -0,0 +1,602 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       BytecodeCompiler.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements compiler of the command lines
+//             into the bytecode.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file BytecodeCompiler.cpp
+ *
+ * @brief Source file which implements compiler of the command lines into
+ *        the bytecode.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstring>
+#include <cctype>
+
+#include "BytecodeCompiler.h"
+
+using namespace std;
+
+/**
+ * Reserved words which can not start a simple command.
+ */
+static const char * const RESERVED[] = { "then", "elif", "else", "fi", "do",
+		"done", "}", NULL };
+
+static const char * const TERM_THEN[] = { "then", NULL };
+static const char * const TERM_IF_BODY[] = { "elif", "else", "fi", NULL };
+static const char * const TERM_FI[] = { "fi", NULL };
+static const char * const TERM_DO[] = { "do", NULL };
+static const char * const TERM_DONE[] = { "done", NULL };
+static const char * const TERM_BRACE[] = { "}", NULL };
+
+/**
+ * Tests whether word is contained in the NULL terminated array.
+ */
+static bool isOneOf(const string &word, const char * const *words) {
+	for (; *words != NULL; words++) {
+		if (word == *words) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Compiles source text into program.
+ * @param source Text of the script.
+ * @param program Program which will be filled by compiled bytecode.
+ * @throw ScriptIncomplete When source ends inside of the compound command.
+ * @throw ScriptSyntaxError When source is not valid.
+ */
+void BytecodeCompiler::compile(const string &source, Program &program) {
+	tokenize(source);
+	pos = 0;
+	loops.clear();
+	parseList(program, NULL);
+}
+
+/**
+ * Returns slot of the variable, new slot is allocated for unknown variable.
+ * @param name Name of the variable.
+ * @return Index of the slot.
+ */
+int BytecodeCompiler::slotOf(const string &name) {
+	map<string, int>::iterator it = slots.find(name);
+	if (it != slots.end()) {
+		return it->second;
+	}
+
+	int slot = slotNames.size();
+	slots[name] = slot;
+	slotNames.push_back(name);
+	return slot;
+}
+
+/**
+ * Returns number of allocated slots.
+ */
+int BytecodeCompiler::getSlotCount() const {
+	return slotNames.size();
+}
+
+/**
+ * Returns name of the variable stored in the slot.
+ */
+const string &BytecodeCompiler::getSlotName(int slot) const {
+	return slotNames[slot];
+}
+
+/**
+ * Tests whether text is valid name of the variable or function.
+ */
+bool BytecodeCompiler::isName(const string &text) {
+	if (text.empty() || isdigit(text[0])) {
+		return false;
+	}
+	for (size_t i = 0; i < text.size(); i++) {
+		if (!isalnum(text[i]) && text[i] != '_') {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Splits source into words and separators. Quotes are kept in the words.
+ */
+void BytecodeCompiler::tokenize(const string &source) {
+	tokens.clear();
+
+	size_t i = 0;
+	while (i < source.size()) {
+		char c = source[i];
+
+		if (c == ' ' || c == '\t' || c == '\r') {
+			i++;
+			continue;
+		} else if (c == '\n' || c == ';') {
+			Token token = { string(1, c), true };
+			tokens.push_back(token);
+			i++;
+			continue;
+		} else if (c == '#') { // Comment up to the end of line
+			while (i < source.size() && source[i] != '\n') {
+				i++;
+			}
+			continue;
+		}
+
+		Token token = { "", false };
+		char quote = '\0';
+		while (i < source.size()) {
+			c = source[i];
+			if (quote == '\0'
+					&& (c == ' ' || c == '\t' || c == '\r' || c == '\n'
+							|| c == ';')) {
+				break;
+			}
+
+			if (c == '\\' && quote != '\'' && i + 1 < source.size()) {
+				token.text += c;
+				c = source[++i];
+			} else if (quote == '\0' && (c == '\'' || c == '"')) {
+				quote = c;
+			} else if (c == quote) {
+				quote = '\0';
+			}
+
+			token.text += c;
+			i++;
+		}
+
+		if (quote != '\0') { // Quoted string continues on the next line
+			throw ScriptIncomplete();
+		}
+		tokens.push_back(token);
+	}
+}
+
+/**
+ * Skips separators of the commands.
+ */
+void BytecodeCompiler::skipSeparators() {
+	while (pos < tokens.size() && tokens[pos].separator) {
+		pos++;
+	}
+}
+
+/**
+ * Expects reserved word after optional separators.
+ * @param word Expected word.
+ */
+void BytecodeCompiler::expectWord(const char *word) {
+	skipSeparators();
+	if (pos >= tokens.size()) {
+		throw ScriptIncomplete();
+	}
+	if (tokens[pos].text != word) {
+		throw ScriptSyntaxError(
+				string("Expected '") + word + "' instead of '"
+						+ tokens[pos].text + "'!");
+	}
+	pos++;
+}
+
+/**
+ * Compiles list of statements.
+ * @param program Program where to emit instructions.
+ * @param terminators Reserved words which end the list, NULL for top level.
+ * @return Terminator which ended the list.
+ */
+string BytecodeCompiler::parseList(Program &program,
+		const char * const *terminators) {
+	while (1) {
+		skipSeparators();
+		if (pos >= tokens.size()) {
+			if (terminators != NULL) {
+				throw ScriptIncomplete();
+			}
+			return "";
+		}
+
+		const string &word = tokens[pos].text;
+		if (terminators != NULL && isOneOf(word, terminators)) {
+			pos++;
+			return word;
+		} else if (isOneOf(word, RESERVED)) {
+			throw ScriptSyntaxError("Unexpected '" + word + "'!");
+		}
+
+		parseStatement(program);
+	}
+}
+
+/**
+ * Compiles one statement.
+ */
+void BytecodeCompiler::parseStatement(Program &program) {
+	string word = tokens[pos].text;
+
+	if (word == "if") {
+		pos++;
+		parseIf(program);
+	} else if (word == "while" || word == "until") {
+		pos++;
+		parseWhile(program, word == "until");
+	} else if (word == "for") {
+		pos++;
+		parseFor(program);
+	} else if (word == "!") {
+		pos++;
+		skipSeparators();
+		if (pos >= tokens.size()) {
+			throw ScriptIncomplete();
+		}
+		parseStatement(program);
+		emit(program, OP_NEGATE);
+	} else if (word == "function" && pos + 1 < tokens.size()
+			&& !tokens[pos + 1].separator) {
+		string name = tokens[pos + 1].text;
+		pos += 2;
+		if (name.size() > 2 && name.compare(name.size() - 2, 2, "()") == 0) {
+			name.erase(name.size() - 2);
+		} else if (pos < tokens.size() && tokens[pos].text == "()") {
+			pos++;
+		}
+		parseFunction(program, name);
+	} else if (word.size() > 2 && word.compare(word.size() - 2, 2, "()") == 0
+			&& isName(word.substr(0, word.size() - 2))) {
+		pos++;
+		parseFunction(program, word.substr(0, word.size() - 2));
+	} else if (isName(word) && pos + 1 < tokens.size()
+			&& tokens[pos + 1].text == "()") {
+		pos += 2;
+		parseFunction(program, word);
+	} else {
+		vector<string> words;
+		while (pos < tokens.size() && !tokens[pos].separator) {
+			words.push_back(tokens[pos++].text);
+		}
+		parseSimple(program, words);
+	}
+}
+
+/**
+ * Compiles simple command, assignment or builtin.
+ */
+void BytecodeCompiler::parseSimple(Program &program,
+		const vector<string> &words) {
+	const string &name = words[0];
+
+	if (words.size() == 1 && isAssignment(name)) {
+		size_t eq = name.find('=');
+		int slot = slotOf(name.substr(0, eq));
+		emit(program, OP_ASSIGN, slot,
+				addTemplate(program, name.substr(eq + 1), false));
+	} else if (name == "break" || name == "continue") {
+		if (loops.empty()) {
+			throw ScriptSyntaxError("'" + name + "' is used outside of loop!");
+		}
+		size_t jump = emit(program, OP_JUMP);
+		if (name == "break") {
+			loops.back().breaks.push_back(jump);
+		} else {
+			loops.back().continues.push_back(jump);
+		}
+	} else if (name == "return" || name == "exit") {
+		int code = (words.size() > 1) ? addTemplate(program, words[1], false) : -1;
+		emit(program, (name == "return") ? OP_RETURN : OP_EXIT, code);
+	} else if (words.size() == 1 && (name == ":" || name == "true")) {
+		emit(program, OP_STATUS, 0);
+	} else if (words.size() == 1 && name == "false") {
+		emit(program, OP_STATUS, 1);
+	} else {
+		string line = name;
+		for (size_t i = 1; i < words.size(); i++) {
+			line += " " + words[i];
+		}
+		emit(program, OP_EXEC, addTemplate(program, line, true));
+	}
+}
+
+/**
+ * Compiles if statement, "if" has been already read.
+ */
+void BytecodeCompiler::parseIf(Program &program) {
+	vector<size_t> endJumps;
+
+	parseList(program, TERM_THEN);
+	size_t falseJump = emit(program, OP_JUMP_FALSE);
+	string terminator = parseList(program, TERM_IF_BODY);
+
+	while (1) {
+		endJumps.push_back(emit(program, OP_JUMP));
+		patch(program, falseJump, program.code.size());
+
+		if (terminator == "fi") { // No branch has been taken
+			emit(program, OP_STATUS, 0);
+			break;
+		} else if (terminator == "else") {
+			parseList(program, TERM_FI);
+			break;
+		}
+
+		parseList(program, TERM_THEN);
+		falseJump = emit(program, OP_JUMP_FALSE);
+		terminator = parseList(program, TERM_IF_BODY);
+	}
+
+	for (size_t i = 0; i < endJumps.size(); i++) {
+		patch(program, endJumps[i], program.code.size());
+	}
+}
+
+/**
+ * Compiles while or until statement, keyword has been already read.
+ */
+void BytecodeCompiler::parseWhile(Program &program, bool until) {
+	size_t head = program.code.size();
+
+	parseList(program, TERM_DO);
+	if (until) {
+		emit(program, OP_NEGATE);
+	}
+	size_t falseJump = emit(program, OP_JUMP_FALSE);
+
+	parseLoopBody(program, head);
+	patch(program, falseJump, program.code.size());
+	emit(program, OP_STATUS, 0);
+
+	LoopContext &loop = loops.back();
+	for (size_t i = 0; i < loop.breaks.size(); i++) {
+		patch(program, loop.breaks[i], program.code.size() - 1);
+	}
+	loops.pop_back();
+}
+
+/**
+ * Compiles for statement, "for" has been already read.
+ * Single word {LOW..HIGH} is compiled into numeric range, so no list
+ * of the words has to be built.
+ */
+void BytecodeCompiler::parseFor(Program &program) {
+	if (pos >= tokens.size() || tokens[pos].separator) {
+		throw ScriptIncomplete();
+	}
+	if (!isName(tokens[pos].text)) {
+		throw ScriptSyntaxError(
+				"Invalid name of the variable '" + tokens[pos].text + "'!");
+	}
+	int slot = slotOf(tokens[pos++].text);
+
+	if (pos >= tokens.size()) {
+		throw ScriptIncomplete();
+	}
+	if (tokens[pos].text != "in") {
+		throw ScriptSyntaxError("Expected 'in' in for statement!");
+	}
+	pos++;
+
+	vector<string> words;
+	while (pos < tokens.size() && !tokens[pos].separator) {
+		words.push_back(tokens[pos++].text);
+	}
+
+	string low, high;
+	if (words.size() == 1 && isRange(words[0], low, high)) {
+		emit(program, OP_RANGE_BEGIN, addTemplate(program, low, false),
+				addTemplate(program, high, false));
+	} else {
+		vector<ListWord> list;
+		for (size_t i = 0; i < words.size(); i++) {
+			ListWord word;
+			word.value = compileTemplate(words[i], false);
+			word.split = words[i].find_first_of("'\"") == string::npos;
+			list.push_back(word);
+		}
+		program.lists.push_back(list);
+		emit(program, OP_FOR_BEGIN, program.lists.size() - 1);
+	}
+
+	size_t head = emit(program, OP_LOOP_NEXT, slot);
+	expectWord("do");
+	parseLoopBody(program, head);
+
+	patch(program, head, program.code.size());
+	emit(program, OP_LOOP_POP);
+
+	LoopContext &loop = loops.back();
+	for (size_t i = 0; i < loop.breaks.size(); i++) {
+		patch(program, loop.breaks[i], program.code.size() - 1);
+	}
+	loops.pop_back();
+}
+
+/**
+ * Compiles body of the loop up to "done" and jump back to the head.
+ * Context of the loop is left on the stack for patching of breaks.
+ * @param program Program where to emit instructions.
+ * @param head Instruction where the next iteration starts.
+ */
+void BytecodeCompiler::parseLoopBody(Program &program, size_t head) {
+	loops.push_back(LoopContext());
+	parseList(program, TERM_DONE);
+	emit(program, OP_JUMP, head);
+
+	LoopContext &loop = loops.back();
+	for (size_t i = 0; i < loop.continues.size(); i++) {
+		patch(program, loop.continues[i], head);
+	}
+}
+
+/**
+ * Compiles definition of the function, header has been already read.
+ * Body is compiled only once into its own program.
+ */
+void BytecodeCompiler::parseFunction(Program &program, const string &name) {
+	if (!isName(name)) {
+		throw ScriptSyntaxError("Invalid name of the function '" + name + "'!");
+	}
+	expectWord("{");
+
+	Function function;
+	function.name = name;
+
+	vector<LoopContext> outerLoops;
+	outerLoops.swap(loops);
+	parseList(*function.body, TERM_BRACE);
+	outerLoops.swap(loops);
+
+	program.functions.push_back(function);
+	emit(program, OP_DEFUN, program.functions.size() - 1);
+}
+
+/**
+ * Compiles word into template. Variables are not expanded inside
+ * of the single quotes.
+ * @param word Word as it was typed.
+ * @param keepQuotes Whether quotes and escapes are kept in the literals,
+ *        used for command lines which are expanded by wordexp later.
+ * @return Compiled template.
+ */
+Template BytecodeCompiler::compileTemplate(const string &word,
+		bool keepQuotes) {
+	Template result;
+	Segment literal = { Segment::LITERAL, "", 0 };
+	char quote = '\0';
+
+	for (size_t i = 0; i < word.size(); i++) {
+		char c = word[i];
+
+		if (c == '\\' && quote != '\'' && i + 1 < word.size()) {
+			if (keepQuotes) {
+				literal.text += c;
+			}
+			literal.text += word[++i];
+			continue;
+		} else if ((c == '\'' || c == '"') && (quote == '\0' || quote == c)) {
+			quote = (quote == '\0') ? c : '\0';
+			if (keepQuotes) {
+				literal.text += c;
+			}
+			continue;
+		} else if (c != '$' || quote == '\'' || i + 1 == word.size()) {
+			literal.text += c;
+			continue;
+		}
+
+		Segment segment = { Segment::LITERAL, "", 0 };
+		char next = word[i + 1];
+		if (isalpha(next) || next == '_') {
+			size_t end = i + 1;
+			while (end < word.size() && (isalnum(word[end]) || word[end] == '_')) {
+				end++;
+			}
+			segment.type = Segment::VARIABLE;
+			segment.text = word.substr(i + 1, end - i - 1);
+			i = end - 1;
+		} else if (next == '{' && word.find('}', i) != string::npos
+				&& isName(word.substr(i + 2, word.find('}', i) - i - 2))) {
+			size_t end = word.find('}', i);
+			segment.type = Segment::VARIABLE;
+			segment.text = word.substr(i + 2, end - i - 2);
+			i = end;
+		} else if (isdigit(next)) {
+			segment.type = Segment::POSITIONAL;
+			segment.index = next - '0';
+			i++;
+		} else if (next == '?') {
+			segment.type = Segment::STATUS;
+			i++;
+		} else if (next == '#') {
+			segment.type = Segment::ARG_COUNT;
+			i++;
+		} else { // Left for wordexp - $(...), $((...))
+			literal.text += c;
+			continue;
+		}
+
+		if (segment.type == Segment::VARIABLE) {
+			segment.index = slotOf(segment.text);
+		}
+		if (!literal.text.empty()) {
+			result.push_back(literal);
+			literal.text.clear();
+		}
+		result.push_back(segment);
+	}
+
+	if (!literal.text.empty()) {
+		result.push_back(literal);
+	}
+	return result;
+}
+
+/**
+ * Compiles word into template and adds it into the program.
+ * @return Index of the template.
+ */
+int BytecodeCompiler::addTemplate(Program &program, const string &word,
+		bool keepQuotes) {
+	program.templates.push_back(compileTemplate(word, keepQuotes));
+	return program.templates.size() - 1;
+}
+
+/**
+ * Appends instruction to the program.
+ * @return Position of the instruction.
+ */
+size_t BytecodeCompiler::emit(Program &program, Opcode op, int a, int b) {
+	Instruction instruction = { op, a, b };
+	program.code.push_back(instruction);
+	return program.code.size() - 1;
+}
+
+/**
+ * Sets target of the jump instruction.
+ */
+void BytecodeCompiler::patch(Program &program, size_t instruction,
+		size_t target) {
+	Instruction &in = program.code[instruction];
+	if (in.op == OP_LOOP_NEXT) {
+		in.b = target;
+	} else {
+		in.a = target;
+	}
+}
+
+/**
+ * Tests whether word is an assignment NAME=value.
+ */
+bool BytecodeCompiler::isAssignment(const string &word) {
+	size_t eq = word.find('=');
+	return eq != string::npos && eq > 0 && isName(word.substr(0, eq));
+}
+
+/**
+ * Tests whether word is a range {LOW..HIGH}.
+ */
+bool BytecodeCompiler::isRange(const string &word, string &low,
+		string &high) {
+	if (word.size() < 6 || word[0] != '{' || word[word.size() - 1] != '}') {
+		return false;
+	}
+
+	size_t dots = word.find("..");
+	if (dots == string::npos || dots == 1 || dots + 3 >= word.size()) {
+		return false;
+	}
+
+	low = word.substr(1, dots - 1);
+	high = word.substr(dots + 2, word.size() - dots - 3);
+	return true;
+}
@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       BytecodeCompiler.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines compiler of the command lines into
+//             the bytecode.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file BytecodeCompiler.h
+ *
+ * @brief Header file which defines compiler of the command lines into
+ *        the bytecode.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef BYTECODECOMPILER_H_INCLUDED
+#define BYTECODECOMPILER_H_INCLUDED
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "Bytecode.h"
+
+using namespace std;
+
+/**
+ * Thrown when compiled text ends inside of the compound command.
+ */
+class ScriptIncomplete: public runtime_error {
+public:
+	ScriptIncomplete() :
+			runtime_error("Script is not complete!") {
+	}
+};
+
+/**
+ * Thrown when compiled text is not valid.
+ */
+class ScriptSyntaxError: public runtime_error {
+public:
+	ScriptSyntaxError(const string &msg) :
+			runtime_error(msg) {
+	}
+};
+
+/**
+ * Compiles command lines with if, while, until, for and function
+ * definitions into the bytecode. Variables are compiled into slots which
+ * are shared by all programs compiled by one compiler.
+ */
+class BytecodeCompiler {
+public:
+	BytecodeCompiler() :
+			pos(0) {
+	}
+
+	void compile(const string &source, Program &program);
+	int slotOf(const string &name);
+	int getSlotCount() const;
+	const string &getSlotName(int slot) const;
+
+	static bool isName(const string &text);
+private:
+	/**
+	 * Word of the script or separator of commands (; or newline).
+	 */
+	typedef struct {
+		string text;
+		bool separator;
+	} Token;
+
+	/**
+	 * Jumps of break and continue which have to be patched at the end
+	 * of the loop.
+	 */
+	typedef struct {
+		vector<size_t> breaks;
+		vector<size_t> continues;
+	} LoopContext;
+
+	vector<Token> tokens;
+	size_t pos;
+	vector<LoopContext> loops;
+	map<string, int> slots;
+	vector<string> slotNames;
+
+	void tokenize(const string &source);
+	string parseList(Program &program, const char * const *terminators);
+	void parseStatement(Program &program);
+	void parseSimple(Program &program, const vector<string> &words);
+	void parseIf(Program &program);
+	void parseWhile(Program &program, bool until);
+	void parseFor(Program &program);
+	void parseFunction(Program &program, const string &name);
+	void parseLoopBody(Program &program, size_t head);
+	void expectWord(const char *word);
+	void skipSeparators();
+
+	Template compileTemplate(const string &word, bool keepQuotes);
+	int addTemplate(Program &program, const string &word, bool keepQuotes);
+
+	static size_t emit(Program &program, Opcode op, int a = 0, int b = 0);
+	static void patch(Program &program, size_t instruction, size_t target);
+	static bool isAssignment(const string &word);
+	static bool isRange(const string &word, string &low, string &high);
+};
+
+#endif // BYTECODECOMPILER_H_INCLUDED
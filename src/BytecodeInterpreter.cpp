@@ -0,0 +1,332 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       BytecodeInterpreter.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements interpreter of the compiled
+//             command lines.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file BytecodeInterpreter.cpp
+ *
+ * @brief Source file which implements interpreter of the compiled command
+ *        lines.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <iostream>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "Metrics.h"
+#include "BytecodeInterpreter.h"
+
+using namespace std;
+
+/**
+ * Constructor.
+ * @param runner Object which runs simple commands.
+ */
+BytecodeInterpreter::BytecodeInterpreter(CommandRunner &runner) :
+		runner(runner), arguments(&noArguments), status(0), exiting(false), depth(
+				0) {
+}
+
+/**
+ * Compiles line and runs it. Line which does not finish compound command
+ * is kept and compiled again together with the following lines.
+ * @param line Line of the input.
+ */
+void BytecodeInterpreter::feed(const string &line) {
+	pending += line;
+
+	Program program;
+	try {
+		compiler.compile(pending, program);
+	} catch (ScriptIncomplete &) {
+		return;
+	} catch (ScriptSyntaxError &e) {
+		Metrics::increment(Metrics::PARSE_FAILURES);
+		runner.getErrorStream() << "Typed invalid command! " << e.what() << endl;
+		pending.clear();
+		status = 2;
+		return;
+	}
+	pending.clear();
+
+	Slot undefined = { "", false };
+	slots.resize(compiler.getSlotCount(), undefined);
+
+	run(program);
+}
+
+/**
+ * Tests whether the last line has not finished compound command.
+ */
+bool BytecodeInterpreter::needsMoreInput() const {
+	return !pending.empty();
+}
+
+/**
+ * Tests whether exit has been executed.
+ */
+bool BytecodeInterpreter::exitRequested() const {
+	return exiting;
+}
+
+/**
+ * Returns exit status of the last command.
+ */
+int BytecodeInterpreter::getStatus() const {
+	return status;
+}
+
+/**
+ * Main loop of the interpreter.
+ * @param program Program to be run.
+ */
+void BytecodeInterpreter::run(const Program &program) {
+	vector<LoopState> loops;
+	string value;
+	char number[32];
+
+	size_t pc = 0;
+	while (pc < program.code.size() && !exiting) {
+		const Instruction &in = program.code[pc++];
+
+		switch (in.op) {
+		case OP_EXEC:
+			expand(program.templates[in.a], value);
+			exec(value);
+			break;
+		case OP_ASSIGN:
+			expand(program.templates[in.b], value);
+			slots[in.a].value.swap(value);
+			slots[in.a].defined = true;
+			status = 0;
+			break;
+		case OP_STATUS:
+			status = in.a;
+			break;
+		case OP_JUMP:
+			pc = in.a;
+			break;
+		case OP_JUMP_FALSE:
+			if (status != 0) {
+				pc = in.a;
+			}
+			break;
+		case OP_FOR_BEGIN: {
+			LoopState loop;
+			loop.isRange = false;
+			expandList(program.lists[in.a], loop.items);
+			loop.current = 0;
+			loop.last = (long) loop.items.size() - 1;
+			loop.step = 1;
+			loops.push_back(loop);
+			break;
+		}
+		case OP_RANGE_BEGIN: {
+			LoopState loop;
+			loop.isRange = true;
+			loop.current = expandNumber(program.templates[in.a]);
+			loop.last = expandNumber(program.templates[in.b]);
+			loop.step = (loop.current <= loop.last) ? 1 : -1;
+			loops.push_back(loop);
+			break;
+		}
+		case OP_LOOP_NEXT: {
+			LoopState &loop = loops.back();
+			if ((loop.step > 0) ?
+					loop.current > loop.last : loop.current < loop.last) {
+				pc = in.b;
+				break;
+			}
+
+			Slot &slot = slots[in.a];
+			if (loop.isRange) {
+				snprintf(number, sizeof(number), "%ld", loop.current);
+				slot.value.assign(number);
+			} else {
+				slot.value = loop.items[loop.current];
+			}
+			slot.defined = true;
+			loop.current += loop.step;
+			break;
+		}
+		case OP_LOOP_POP:
+			loops.pop_back();
+			break;
+		case OP_NEGATE:
+			status = (status == 0) ? 1 : 0;
+			break;
+		case OP_DEFUN: {
+			const Function &function = program.functions[in.a];
+			functions[function.name] = *function.body;
+			status = 0;
+			break;
+		}
+		case OP_RETURN:
+			if (in.a >= 0) {
+				status = expandNumber(program.templates[in.a]);
+			}
+			return;
+		case OP_EXIT:
+			if (in.a >= 0) {
+				status = expandNumber(program.templates[in.a]);
+			}
+			exiting = true;
+			return;
+		}
+	}
+}
+
+/**
+ * Executes expanded command line - calls function or passes it to runner.
+ * @param commandLine Expanded command line.
+ */
+void BytecodeInterpreter::exec(const string &commandLine) {
+	if (!functions.empty()) {
+		size_t start = commandLine.find_first_not_of(" \t");
+		size_t end = commandLine.find_first_of(" \t", start);
+		map<string, Program>::iterator it = functions.find(
+				commandLine.substr(start, end - start));
+
+		if (it != functions.end()) {
+			if (depth >= MAX_CALL_DEPTH) {
+				runner.getErrorStream() << "Maximal depth of function calls exceeded!" << endl;
+				status = EXIT_FAILURE;
+				return;
+			}
+
+			vector<string> args;
+			splitWords(commandLine, args);
+
+			vector<string> *callerArguments = arguments;
+			arguments = &args;
+			depth++;
+			run(it->second);
+			depth--;
+			arguments = callerArguments;
+			return;
+		}
+	}
+
+	status = runner.runCommand(commandLine);
+}
+
+/**
+ * Expands template into string.
+ * @param value Compiled template.
+ * @param out Expanded string.
+ */
+void BytecodeInterpreter::expand(const Template &value, string &out) {
+	char number[32];
+	out.clear();
+
+	for (Template::const_iterator it = value.begin(); it != value.end();
+			++it) {
+		switch (it->type) {
+		case Segment::LITERAL:
+			out += it->text;
+			break;
+		case Segment::VARIABLE:
+			if (slots[it->index].defined) {
+				out += slots[it->index].value;
+			} else {
+				const char *env = getenv(it->text.c_str());
+				if (env != NULL) {
+					out += env;
+				}
+			}
+			break;
+		case Segment::POSITIONAL:
+			if (it->index == 0) {
+				out += "shell";
+			} else if (it->index < (int) arguments->size()) {
+				out += (*arguments)[it->index];
+			}
+			break;
+		case Segment::STATUS:
+			snprintf(number, sizeof(number), "%d", status);
+			out += number;
+			break;
+		case Segment::ARG_COUNT:
+			snprintf(number, sizeof(number), "%d",
+					arguments->empty() ? 0 : (int) arguments->size() - 1);
+			out += number;
+			break;
+		}
+	}
+}
+
+/**
+ * Expands words of the for list.
+ * @param list Compiled words.
+ * @param items Expanded words.
+ */
+void BytecodeInterpreter::expandList(const vector<ListWord> &list,
+		vector<string> &items) {
+	string value;
+	for (size_t i = 0; i < list.size(); i++) {
+		expand(list[i].value, value);
+		if (list[i].split) {
+			splitWords(value, items);
+		} else {
+			items.push_back(value);
+		}
+	}
+}
+
+/**
+ * Expands template and converts it into number.
+ */
+int BytecodeInterpreter::expandNumber(const Template &value) {
+	string text;
+	expand(value, text);
+	return atoi(text.c_str());
+}
+
+/**
+ * Splits text into words by whitespaces, quotes are removed.
+ * @param text Splitted text.
+ * @param words Vector where words are appended.
+ */
+void BytecodeInterpreter::splitWords(const string &text,
+		vector<string> &words) {
+	string word;
+	bool inWord = false;
+	char quote = '\0';
+
+	for (size_t i = 0; i < text.size(); i++) {
+		char c = text[i];
+		if (quote == '\0' && (c == ' ' || c == '\t' || c == '\n')) {
+			if (inWord) {
+				words.push_back(word);
+				word.clear();
+				inWord = false;
+			}
+			continue;
+		}
+
+		inWord = true;
+		if (quote == '\0' && (c == '\'' || c == '"')) {
+			quote = c;
+		} else if (c == quote) {
+			quote = '\0';
+		} else if (c == '\\' && quote != '\'' && i + 1 < text.size()) {
+			word += text[++i];
+		} else {
+			word += c;
+		}
+	}
+
+	if (inWord) {
+		words.push_back(word);
+	}
+}
@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       BytecodeInterpreter.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines interpreter of the compiled command
+//             lines.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file BytecodeInterpreter.h
+ *
+ * @brief Header file which defines interpreter of the compiled command lines.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef BYTECODEINTERPRETER_H_INCLUDED
+#define BYTECODEINTERPRETER_H_INCLUDED
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "Bytecode.h"
+#include "BytecodeCompiler.h"
+
+using namespace std;
+
+/**
+ * Interface of the object which runs simple commands for the interpreter.
+ */
+class CommandRunner {
+public:
+	virtual ~CommandRunner() {
+	}
+
+	/**
+	 * Runs expanded simple command.
+	 * @param commandLine Command line with expanded variables.
+	 * @return Exit status of the command.
+	 */
+	virtual int runCommand(const string &commandLine) = 0;
+
+	/**
+	 * Returns stream where errors of the interpreter are written.
+	 */
+	virtual ostream &getErrorStream() {
+		return cerr;
+	}
+};
+
+/**
+ * Interpreter which compiles lines fed by the execute thread and runs them.
+ * Compound commands can continue on the following lines.
+ */
+class BytecodeInterpreter {
+public:
+	BytecodeInterpreter(CommandRunner &runner);
+
+	void feed(const string &line);
+	bool needsMoreInput() const;
+	bool exitRequested() const;
+	int getStatus() const;
+
+	static void splitWords(const string &text, vector<string> &words);
+private:
+	static const int MAX_CALL_DEPTH = 256;
+
+	/**
+	 * State of the running for loop.
+	 */
+	typedef struct {
+		bool isRange;
+		long current;
+		long last;
+		long step;
+		vector<string> items;
+	} LoopState;
+
+	/**
+	 * Value of the variable slot.
+	 */
+	typedef struct {
+		string value;
+		bool defined;
+	} Slot;
+
+	CommandRunner &runner;
+	BytecodeCompiler compiler;
+	string pending;
+
+	vector<Slot> slots;
+	map<string, Program> functions;
+	vector<string> noArguments;
+	vector<string> *arguments;
+	int status;
+	bool exiting;
+	int depth;
+
+	void run(const Program &program);
+	void exec(const string &commandLine);
+	void expand(const Template &value, string &out);
+	void expandList(const vector<ListWord> &list, vector<string> &items);
+	int expandNumber(const Template &value);
+};
+
+#endif // BYTECODEINTERPRETER_H_INCLUDED
@@ -0,0 +1,255 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       ChangeWatcherPThread.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements thread watching changes of
+//             the files for the on-change builtin.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ChangeWatcherPThread.cpp
+ *
+ * @brief Source file which implements thread watching changes of the files
+ *        for the on-change builtin.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+#include "ChangeWatcherPThread.h"
+
+using namespace std;
+
+set<ChangeWatcherPThread *> ChangeWatcherPThread::active;
+pthread_mutex_t ChangeWatcherPThread::activeMutex = PTHREAD_MUTEX_INITIALIZER;
+bool ChangeWatcherPThread::stopped = false;
+
+/**
+ * Events of the watched directories.
+ */
+static const uint32_t WATCHED_EVENTS = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE
+		| IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF
+		| IN_MOVE_SELF;
+
+/**
+ * Constructor, creates inotify instance.
+ * @param debounce Milliseconds without events until the change is reported.
+ * @param cancelRun Whether the change terminates the running command.
+ */
+ChangeWatcherPThread::ChangeWatcherPThread(long debounce, bool cancelRun) :
+		inotifyFd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)), debounce(debounce), cancelRun(
+				cancelRun), firstEvent(0), lastEvent(0), monitor("on-change"), changed(
+				monitor, "changed"), changes(0), taken(0), running(0), stopping(
+				false) {
+	if (inotifyFd == -1) {
+		perror("Failed to watch changes - inotify_init1()");
+	} else {
+		loop.add(inotifyFd, this);
+	}
+
+	pthread_mutex_lock(&activeMutex);
+	active.insert(this);
+	stopping = stopped;
+	pthread_mutex_unlock(&activeMutex);
+}
+
+/**
+ * Destructor, stops the thread.
+ */
+ChangeWatcherPThread::~ChangeWatcherPThread() {
+	PThread::cancel();
+
+	pthread_mutex_lock(&activeMutex);
+	active.erase(this);
+	pthread_mutex_unlock(&activeMutex);
+
+	if (inotifyFd != -1) {
+		close(inotifyFd);
+	}
+}
+
+/**
+ * Starts watching of the file or directory, must be called before
+ * the thread is started. File which does not exist yet is watched too.
+ * @param path Absolute path of the file or directory.
+ * @return True on success, false if its directory cannot be watched.
+ */
+bool ChangeWatcherPThread::watch(const string &path) {
+	if (inotifyFd == -1) {
+		return false;
+	}
+
+	struct stat st;
+	bool directory = stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+	size_t slash = path.find_last_of('/');
+	string dir = directory ? path : path.substr(0, (slash > 0) ? slash : 1);
+
+	int wd = inotify_add_watch(inotifyFd, dir.c_str(), WATCHED_EVENTS);
+	if (wd == -1) {
+		perror(("Failed to watch " + dir + " - inotify_add_watch()").c_str());
+		return false;
+	}
+
+	Watch &watch = watches[wd]; // The same directory has the same descriptor
+	watch.all = watch.all || directory;
+	if (!directory) {
+		watch.names.insert(path.substr(slash + 1));
+	}
+	return true;
+}
+
+/**
+ * Main function where the thread runs the event loop and reports changes
+ * after the debounce time.
+ * @return Exit code of this thread.
+ */
+int ChangeWatcherPThread::run() {
+	while (!isStopRequested()) {
+		int timeout = -1;
+		if (firstEvent != 0) {
+			uint64_t deadline = lastEvent + debounce;
+			if (deadline > firstEvent + debounce * MAX_DEBOUNCES) {
+				deadline = firstEvent + debounce * MAX_DEBOUNCES; // Endless burst
+			}
+			uint64_t current = now();
+			if (current >= deadline) {
+				firstEvent = 0;
+				report();
+				continue;
+			}
+			timeout = (int) (deadline - current);
+		}
+
+		if (loop.runOnce(timeout) == -1) {
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Reads inotify events, events of the watched entries postpone the report.
+ */
+void ChangeWatcherPThread::onEvent(uint32_t) {
+	uint64_t data[512]; // Aligned for struct inotify_event
+	bool matched = false;
+	ssize_t count;
+	while ((count = read(inotifyFd, data, sizeof(data))) > 0) {
+		char *end = reinterpret_cast<char *>(data) + count;
+		char *next = reinterpret_cast<char *>(data);
+		while (next < end) {
+			struct inotify_event *event =
+					reinterpret_cast<struct inotify_event *>(next);
+			map<int, Watch>::iterator it = watches.find(event->wd);
+			if ((event->mask & IN_Q_OVERFLOW) != 0
+					|| (it != watches.end()
+							&& (it->second.all
+									|| (event->len > 0
+											&& it->second.names.count(
+													event->name) > 0)))) {
+				matched = true;
+			}
+			next += sizeof(struct inotify_event) + event->len;
+		}
+	}
+
+	if (matched) {
+		lastEvent = now();
+		firstEvent = (firstEvent != 0) ? firstEvent : lastEvent;
+	}
+}
+
+/**
+ * Reports the change to the executor, running command is terminated
+ * when the run is cancelled by the change.
+ */
+void ChangeWatcherPThread::report() {
+	monitor.enter();
+	changes++;
+	if (cancelRun && running > 0) {
+		kill(-running, SIGTERM);
+		kill(-running, SIGCONT); // Stopped process would not terminate
+	}
+	changed.signal();
+	monitor.exit();
+}
+
+/**
+ * Waits for the change which has not been taken yet, called by the executor.
+ * @return False when the shell is stopping.
+ */
+bool ChangeWatcherPThread::waitChange() {
+	monitor.enter();
+	while (changes == taken && !stopping) {
+		changed.wait();
+	}
+	taken = changes;
+	bool result = !stopping;
+	monitor.exit();
+	return result;
+}
+
+/**
+ * Returns whether the change terminates the running command.
+ */
+bool ChangeWatcherPThread::cancelsRun() const {
+	return cancelRun;
+}
+
+/**
+ * Sets the running command, called by the executor after the spawn
+ * and after the wait.
+ * @param group Process group of the command, 0 when it has finished.
+ */
+void ChangeWatcherPThread::setRunning(pid_t group) {
+	monitor.enter();
+	running = group;
+	if (cancelRun && running > 0 && changes != taken) { // Changed meanwhile
+		kill(-running, SIGTERM);
+	}
+	monitor.exit();
+}
+
+/**
+ * Stops waiting of all executors for the changes, so the shell can be
+ * stopped. Running commands are not terminated.
+ */
+void ChangeWatcherPThread::stopAll() {
+	pthread_mutex_lock(&activeMutex);
+	stopped = true;
+	for (set<ChangeWatcherPThread *>::iterator it = active.begin();
+			it != active.end(); ++it) {
+		(*it)->monitor.enter();
+		(*it)->stopping = true;
+		(*it)->changed.broadcast();
+		(*it)->monitor.exit();
+	}
+	pthread_mutex_unlock(&activeMutex);
+}
+
+/**
+ * Wakes up the event loop when stop is requested.
+ */
+void ChangeWatcherPThread::wakeUp() {
+	loop.wakeUp();
+}
+
+/**
+ * Returns monotonic time in milliseconds.
+ */
+uint64_t ChangeWatcherPThread::now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000UL + ts.tv_nsec / 1000000;
+}
@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       ChangeWatcherPThread.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines thread watching changes of the files
+//             for the on-change builtin.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ChangeWatcherPThread.h
+ *
+ * @brief Header file which defines thread watching changes of the files for
+ *        the on-change builtin.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef CHANGEWATCHERPTHREAD_H_INCLUDED
+#define CHANGEWATCHERPTHREAD_H_INCLUDED
+
+#include <map>
+#include <set>
+#include <string>
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "PThread.h"
+#include "EventLoop.h"
+
+using namespace std;
+
+/**
+ * Thread which watches files and directories by inotify in its event loop.
+ * Burst of events is debounced - change is reported when no event has come
+ * for the debounce time (at most MAX_DEBOUNCES times the debounce after
+ * the first event). Executor waits for the changes and runs the command,
+ * changes during the run are coalesced into one. When the run is cancelled
+ * by a change, its process group gets SIGTERM. A file is watched through
+ * its directory, so it is not lost when an editor replaces it by rename.
+ */
+class ChangeWatcherPThread: public PThread, public EventHandler {
+public:
+	static const long DEFAULT_DEBOUNCE = 20; /**< milliseconds */
+	static const long MAX_DEBOUNCES = 10;
+
+	ChangeWatcherPThread(long debounce, bool cancelRun);
+	virtual ~ChangeWatcherPThread();
+	virtual int run();
+	virtual void onEvent(uint32_t events);
+
+	bool watch(const string &path);
+	bool waitChange();
+	bool cancelsRun() const;
+	void setRunning(pid_t group);
+
+	static void stopAll();
+private:
+	/**
+	 * Watched directory.
+	 */
+	typedef struct {
+		bool all; /**< every entry of the directory is watched */
+		set<string> names; /**< watched entries */
+	} Watch;
+
+	int inotifyFd;
+	EventLoop loop;
+	map<int, Watch> watches; /**< by watch descriptor */
+	long debounce; /**< milliseconds */
+	bool cancelRun;
+	uint64_t firstEvent; /**< monotonic milliseconds, 0 when none pending */
+	uint64_t lastEvent;
+
+	PThreadMonitor monitor;
+	PThreadCondition changed;
+	unsigned long changes; /**< reported changes */
+	unsigned long taken; /**< changes taken by the executor */
+	pid_t running; /**< process group of the run, 0 none */
+	bool stopping;
+
+	static set<ChangeWatcherPThread *> active;
+	static pthread_mutex_t activeMutex;
+	static bool stopped;
+
+	void report();
+	void wakeUp();
+
+	static uint64_t now();
+};
+
+#endif // CHANGEWATCHERPTHREAD_H_INCLUDED
@@ -0,0 +1,869 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       CommandExecutor.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements executor of the command lines
+//             with the state of one shell session.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file CommandExecutor.cpp
+ *
+ * @brief Source file which implements executor of the command lines with
+ *        the state of one shell session.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <sstream>
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <wordexp.h>
+
+#include "Metrics.h"
+#include "Trace.h"
+#include "EventStream.h"
+#include "ForkServer.h"
+#include "WatchdogPThread.h"
+#include "CommandIndex.h"
+#include "ChangeWatcherPThread.h"
+#include "PeriodicPThread.h"
+#include "CommandExecutor.h"
+
+using namespace std;
+
+/**
+ * Characters which need to be expanded by wordexp in the child.
+ */
+const char CommandExecutor::EXPANSION_CHARS[] = "$`*?[]~{}'\"\\";
+
+int CommandExecutor::devnull_fd = -1; /**< clonned FD of the /dev/null */
+
+/**
+ * Constructor.
+ * @param jobTable Table where children of the session are kept.
+ */
+CommandExecutor::CommandExecutor(JobTable &jobTable) :
+		interpreter(*this), lineSeq(0), jobTable(jobTable), out(&cout), err(
+				&cerr), history(NULL), commandCache(COMMAND_CACHE_SIZE), parseTime(0), parseCount(0), timingLog(
+				NULL), foregroundCount(0), commandTimeout(0), commandKillAfter(
+				0), captureFd(-1), changeWatcher(NULL), periodicRun(false), parallelRun(
+				false), spawnedPid(0) {
+	if (devnull_fd == -1) {
+		devnull_fd = open("/dev/null", O_RDWR | O_CLOEXEC);
+	}
+	Scheduling::clear(commandSched);
+	Scheduling::clear(backgroundSched);
+	ResourceLimits::clear(commandLimits);
+	ResourceLimits::clear(sessionLimits);
+}
+
+/**
+ * Destructor.
+ */
+CommandExecutor::~CommandExecutor() {
+	setTimingLog("");
+}
+
+/**
+ * Returns stream where the interpreter writes its errors.
+ */
+ostream &CommandExecutor::getErrorStream() {
+	return *err;
+}
+
+/**
+ * Returns working directory where children of the session are started.
+ */
+string CommandExecutor::getCwd() const {
+	if (!cwd.empty()) {
+		return cwd;
+	}
+
+	char *dir = getcwd(NULL, 0);
+	string result = (dir != NULL) ? dir : "/";
+	free(dir);
+	return result;
+}
+
+/**
+ * Sets history which is listed and searched by the history builtin.
+ * @param history History of the lines, NULL when it is not kept.
+ */
+void CommandExecutor::setHistory(History *history) {
+	this->history = history;
+}
+
+/**
+ * Starts new process and calls its handler function.
+ * 
+ * @param label Name of the process.
+ * @param processHandler Handler function of the process 
+ * @return Return code from the process. 
+ */
+int CommandExecutor::startProcess(int(*processHandler)(void *arg), void *arg) {
+	errno = 0;
+	TRACE_BEGIN(FORK);
+	int pid = fork();
+	int retError = errno;
+
+	if (pid == 0) { // Created - child process
+		_exit((*processHandler)(arg)); // Call handler function of th eprocess
+	} else if (pid == -1) { // An error
+		perror("Failed to create a new process - fork()");
+		TRACE_END(FORK);
+		return (retError != 0) ? -retError : -EXIT_FAILURE;
+	}
+	TRACE_END(FORK);
+
+	return pid;
+}
+
+
+
+
+/**
+ * Opens log where resource usage of every command is written.
+ * @param fileName Name of the log, "-" for stderr, empty string closes log.
+ * @return True on success, false on failure.
+ */
+bool CommandExecutor::setTimingLog(const string &fileName) {
+	if (timingLog != NULL && timingLog != stderr) {
+		fclose(timingLog);
+	}
+	timingLog = NULL;
+
+	if (fileName == "-") {
+		timingLog = stderr;
+	} else if (!fileName.empty()) {
+		if ((timingLog = fopen(fileName.c_str(), "ae")) == NULL) {
+			perror("Failed to open timing log - fopen()");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Writes resource usage of the finished child into timing log
+ * and the event about it into event stream.
+ */
+void CommandExecutor::logJob(const Job &job) {
+	if (timingLog != NULL) {
+		fprintf(timingLog, "%s\n", JobTable::format(job).c_str());
+		fflush(timingLog);
+	}
+	EventStream::command(job);
+}
+
+/**
+ * Formats arguments and redirections of the command for the event stream.
+ * Arguments which need wordexp are split only, globs are not expanded.
+ */
+string CommandExecutor::commandEventFields(const CommandInfo &cmdInfo) {
+	vector<string> argv;
+	if (cmdInfo.expandArgs) {
+		BytecodeInterpreter::splitWords(cmdInfo.programNameArgs, argv);
+	}
+
+	vector<string> redirects;
+	for (size_t i = 0; i < cmdInfo.redirects.size(); i++) {
+		redirects.push_back(
+				(cmdInfo.redirects[i].isOut ? ">" : "<")
+						+ cmdInfo.redirects[i].fileName);
+	}
+
+	return EventStream::commandFields(cmdInfo.expandArgs ? argv : cmdInfo.argv,
+			redirects);
+}
+
+/**
+ * Logs and frees finished background children.
+ */
+void CommandExecutor::reportFinishedJobs() {
+	sigset_t oldmask;
+	PThread::blockChildSignal(&oldmask);
+
+	jobTable.reap(); // Nobody reaps children when SIGCHLD is not handled
+
+	Job *job;
+	while ((job = jobTable.nextFinished(true)) != NULL) {
+		WatchdogPThread::unwatch(job->pid);
+		Metrics::observe(Metrics::COMMAND_DURATION, JobTable::realTime(*job));
+		logJob(*job);
+		jobTable.remove(job);
+	}
+
+	pthread_sigmask(SIG_SETMASK, &oldmask, NULL);
+}
+
+/**
+ * Starts runs of the periodic commands which are due. Runs are not waited
+ * for, their exits are watched by the scheduler.
+ * @param owner This executor.
+ */
+void CommandExecutor::runPeriodic(PeriodicOwner *owner) {
+	reportFinishedJobs();
+
+	vector<PeriodicRun> runs;
+	PeriodicPThread::take(owner, runs);
+	for (size_t i = 0; i < runs.size(); i++) {
+		spawnedPid = 0;
+		periodicRun = true;
+		runCommand(runs[i].command);
+		periodicRun = false;
+		PeriodicPThread::started(runs[i], spawnedPid);
+	}
+}
+
+/**
+ * Splits command line by the delimiters of the scanned line into program
+ * name, arguments, files where to redirect stdin & stdout and background flag:
+ *  PROGRAM [ARG...] [< FILE | > FILE...] [&]
+ * Arguments, redirects and & are preceded by whitespaces, the file may
+ * directly follow its < or >. Character | is kept in the words.
+ * @param cmdInfo Information about parsed line - will be filled.
+ * @param line Command line.
+ * @param bitmap Bitmap of the scanned command line.
+ * @return False if command line is not valid.
+ */
+bool CommandExecutor::processCommand(CommandInfo &cmdInfo, const string &line,
+		const DelimiterBitmap &bitmap) {
+	size_t length = line.size(), programStart = 0, argsEnd = 0;
+	bool named = false, spaced = true, redirected = false, background = false;
+	char redirect = '\0';
+
+	for (size_t pos = 0; pos < length;) {
+		char c = line[pos];
+		if (!DelimiterScanner::isDelimiterAt(bitmap, pos) || c == '|') {
+			size_t end = pos;
+			while ((end = DelimiterScanner::nextDelimiter(bitmap, end, length))
+					< length && line[end] == '|') {
+				end++;
+			}
+
+			if (redirect != '\0') {
+				RedirectInfo redirInfo;
+				redirInfo.fileName = line.substr(pos, end - pos);
+				redirInfo.isOut = redirect == '>';
+				cmdInfo.redirects.push_back(redirInfo);
+				redirect = '\0';
+				redirected = true;
+			} else if (!named) {
+				cmdInfo.programName = line.substr(pos, end - pos);
+				programStart = pos;
+				argsEnd = end;
+				named = true;
+			} else if (spaced && !redirected && !background) {
+				cmdInfo.arguments.push_back(line.substr(pos, end - pos));
+				argsEnd = end;
+			} else {
+				return false;
+			}
+			spaced = false;
+			pos = end;
+			continue;
+		}
+
+		if (c == '<' || c == '>' || c == '&') {
+			if (!named || !spaced || redirect != '\0' || background) {
+				return false;
+			}
+			background = c == '&';
+			redirect = background ? '\0' : c;
+		} else { // Whitespace
+			spaced = true;
+		}
+		pos++;
+	}
+	if (!named || redirect != '\0') {
+		return false;
+	}
+
+	// Arguments are kept with the program name for wordexp
+	cmdInfo.programNameArgs = line.substr(programStart, argsEnd - programStart);
+	cmdInfo.runOnBackground = background;
+
+	// Arguments without special characters are not passed through wordexp
+	cmdInfo.expandArgs = cmdInfo.programNameArgs.find_first_of(
+			EXPANSION_CHARS) != string::npos;
+	if (!cmdInfo.expandArgs) {
+		cmdInfo.argv.push_back(cmdInfo.programName);
+		cmdInfo.argv.insert(cmdInfo.argv.end(), cmdInfo.arguments.begin(),
+				cmdInfo.arguments.end());
+	}
+	return true;
+}
+
+/**
+ * Computes FNV-1a hash of the command line.
+ */
+static uint64_t hashLine(const string &line) {
+	const uint64_t prime = ((uint64_t) 0x100 << 32) | 0x1b3;
+	uint64_t hash = ((uint64_t) 0xcbf29ce4 << 32) | 0x84222325;
+	for (size_t i = 0; i < line.size(); i++) {
+		hash ^= (unsigned char) line[i];
+		hash *= prime;
+	}
+	return hash;
+}
+
+/**
+ * Parses command line or takes already parsed command from the cache.
+ * Parsed command does not depend on values of variables or on files
+ * matched by globs, these are expanded by wordexp in the child, so every
+ * line can be cached.
+ * @param commandLine Command line with expanded variables.
+ * @return Parsed command or NULL if command line is not valid.
+ */
+const CommandExecutor::CommandInfo *CommandExecutor::parseCommand(
+		const string &commandLine) {
+	uint64_t hash = hashLine(commandLine);
+
+	CachedCommand *cached = commandCache.get(hash);
+	if (cached != NULL && cached->line == commandLine) {
+		return &cached->cmdInfo;
+	} else if (cached != NULL) { // Collision of hashes
+		commandCache.reject();
+	}
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	TRACE_BEGIN(PARSE);
+
+	/* Tokens of the line are split by the scanned delimiters */
+	DelimiterScanner::scan(commandLine.data(), commandLine.size(), lineBitmap);
+	CachedCommand entry;
+	if (!processCommand(entry.cmdInfo, commandLine, lineBitmap)) {
+		TRACE_END(PARSE); // Invalid line is not in the average of parses
+		return NULL;
+	}
+	entry.line = commandLine;
+
+	TRACE_END(PARSE);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	parseTime += (end.tv_sec - start.tv_sec)
+			+ (end.tv_nsec - start.tv_nsec) / 1e9;
+	parseCount++;
+
+	return &commandCache.put(hash, entry).cmdInfo;
+}
+
+/**
+ * Executes comand which is retrieved from the cmdInfo.
+ * 
+ * @param cmdInfo Information about parsed line.
+ * @return Exit status of the command, 0 for command on background.
+ */
+int CommandExecutor::executeCommand(const CommandInfo &cmdInfo) {
+	if (isStopping()) { // Rest of the line is not started
+		return EXIT_STOPPED;
+	}
+
+	/* Block SIGCHLD until PID of the child is known */
+	sigset_t oldmask;
+	PThread::blockChildSignal(&oldmask);
+
+	/* Run of the every builtin is not waited for, but it keeps its output,
+	 * command of the tasks builtin is waited for by the builtin */
+	bool background = cmdInfo.runOnBackground || periodicRun;
+	bool waited = !background && !parallelRun;
+
+	/* Child without entry would be neither waited for nor reported */
+	if (!jobTable.hasRoom(background)) {
+		*err << "Too many jobs, " << cmdInfo.programName
+				<< " has not been started!" << endl;
+		pthread_sigmask(SIG_SETMASK, &oldmask, NULL);
+		return EXIT_FAILURE;
+	}
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	ChildArgs args;
+	args.executor = this;
+	args.cmdInfo = &cmdInfo;
+	args.periodic = periodicRun;
+	getChildDescriptors(args.fds);
+	if (captureFd != -1) { // Output of the memo prefix
+		args.fds[STDOUT_FILENO] = captureFd;
+	}
+	Scheduling::clear(args.sched);
+	args.sched.hasAffinity = PThread::getUnpinnedCpus(args.sched.cpus);
+	if (background) {
+		Scheduling::merge(args.sched, backgroundSched);
+	}
+	Scheduling::merge(args.sched, commandSched);
+	args.limits = sessionLimits;
+	ResourceLimits::merge(args.limits, commandLimits);
+	args.newGroup = commandTimeout > 0 // Whole pipeline of the job is killed
+			|| (changeWatcher != NULL && changeWatcher->cancelsRun()
+					&& waited);
+	if (!cmdInfo.expandArgs && cmdInfo.argv[0].find('/') == string::npos) {
+		CommandIndex::lookup(cmdInfo.argv[0], args.program);
+	}
+
+	int cmdPID = ForkServer::isRunning() ?
+			spawnByForkServer(args) : startProcess(executionHandler, &args);
+	if (cmdPID > 0) {
+		Metrics::observeSince(Metrics::SPAWN_LATENCY, start);
+		if (args.newGroup) {
+			setpgid(cmdPID, cmdPID); // Group exists before the signals
+		}
+		if (commandTimeout > 0) {
+			WatchdogPThread::watch(cmdPID, commandTimeout, commandKillAfter);
+		}
+		if (changeWatcher != NULL && waited) {
+			changeWatcher->setRunning(cmdPID);
+		}
+	} else {
+		Metrics::increment(Metrics::EXEC_FAILURES);
+	}
+	spawnedPid = (cmdPID > 0) ? cmdPID : 0;
+
+	Job *job = (cmdPID > 0) ?
+			jobTable.add(cmdPID, cmdInfo.programNameArgs,
+					background, start) :
+			NULL;
+	if (job != NULL && EventStream::isEnabled()) {
+		job->seq = lineSeq;
+		job->eventFields = commandEventFields(cmdInfo);
+	}
+
+	int status = (cmdPID > 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+	if (job != NULL && waited) {
+		status = waitJob(job);
+	}
+
+	pthread_sigmask(SIG_SETMASK, &oldmask, NULL);
+
+	return status;
+}
+
+/**
+ * Waits until the foreground child has exited, SIGCHLD has to be blocked,
+ * so it is not reaped by the handler meanwhile.
+ * @param job Entry of the child, it is removed from the job table.
+ * @return Exit status of the child.
+ */
+int CommandExecutor::waitJob(Job *job) {
+	pid_t cmdPID = job->pid;
+	TRACE_BEGIN(WAIT_CHILD);
+	int childStatus;
+	struct rusage usage;
+	struct timespec end;
+	bool exited = waitExit(cmdPID);
+	if (exited && ForkServer::wait(cmdPID, &childStatus, &usage, 0, &end) == cmdPID) {
+		jobTable.finish(cmdPID, childStatus, usage, &end);
+	}
+	TRACE_END(WAIT_CHILD);
+	if (changeWatcher != NULL) {
+		changeWatcher->setRunning(0);
+	}
+	if (!exited) { // Signalled child is reaped by the handler or the helper
+		WatchdogPThread::unwatch(cmdPID);
+		jobTable.remove(job);
+		return EXIT_STOPPED;
+	}
+
+	int status = JobTable::exitStatus(*job);
+	if (WatchdogPThread::unwatch(cmdPID)) {
+		status = EXIT_TIMED_OUT;
+	}
+	if (status == EXIT_NOT_EXECUTABLE || status == EXIT_NOT_FOUND) {
+		Metrics::increment(Metrics::EXEC_FAILURES);
+	}
+	Metrics::observe(Metrics::COMMAND_DURATION, JobTable::realTime(*job));
+
+	lastJob = *job;
+	foregroundCount++;
+	logJob(*job);
+	jobTable.remove(job);
+	return status;
+}
+
+/**
+ * Tests whether the executor should stop, so no more commands are started.
+ */
+bool CommandExecutor::isStopping() {
+	struct pollfd stop;
+	stop.fd = getStopFd();
+	stop.events = POLLIN;
+	return stop.fd != -1 && poll(&stop, 1, 0) > 0;
+}
+
+/**
+ * Waits until the child has exited or the executor should stop. On stop
+ * the child, or its group when it leads one, gets SIGTERM and is not waited
+ * for. Without pidfd it is waited for until it exits.
+ * @param pid PID of the child.
+ * @return False when the child has been signalled on stop.
+ */
+bool CommandExecutor::waitExit(pid_t pid) {
+	struct pollfd polls[2];
+	polls[0].fd = (getStopFd() != -1) ? syscall(SYS_pidfd_open, pid, 0) : -1;
+	polls[0].events = POLLIN;
+	polls[1].fd = getStopFd();
+	polls[1].events = POLLIN;
+	if (polls[0].fd == -1) { // Also the child reaped by the fork server
+		return true;
+	}
+
+	int count;
+	while ((count = poll(polls, 2, -1)) == -1 && errno == EINTR) {
+	}
+	close(polls[0].fd);
+	if (count <= 0 || polls[0].revents != 0) {
+		return true;
+	}
+
+	pid_t target = (getpgid(pid) == pid) ? -pid : pid;
+	kill(target, SIGTERM);
+	kill(target, SIGCONT);
+	return false;
+}
+
+/**
+ * Starts the command by the fork server. Redirections are opened by
+ * the shell and passed to the helper as descriptors of the child.
+ * @param args Parsed line, descriptors and scheduling of the child.
+ * @return PID of the child, negative number on failure.
+ */
+int CommandExecutor::spawnByForkServer(const ChildArgs &args) {
+	const CommandInfo &cmdInfo = *args.cmdInfo;
+	SpawnRequest request;
+	request.expand = cmdInfo.expandArgs;
+	request.background = cmdInfo.runOnBackground || args.periodic;
+	request.cwd = cwd;
+	if (cmdInfo.expandArgs) {
+		request.argv.push_back(cmdInfo.programNameArgs);
+	} else {
+		request.argv = cmdInfo.argv;
+	}
+	memcpy(request.fds, args.fds, sizeof(request.fds));
+	request.newGroup = args.newGroup;
+	request.program = args.program;
+	request.sched = args.sched;
+	request.limits = args.limits;
+
+	vector<int> opened;
+	bool outRedirected = false, inRedirected = false;
+	for (vector<RedirectInfo>::const_iterator it = cmdInfo.redirects.begin();
+			it != cmdInfo.redirects.end(); it++) {
+		/* Helper does not change directory, relative names are resolved
+		 * in the working directory of the session */
+		string fileName = (cwd.empty() || it->fileName[0] == '/') ?
+				it->fileName : cwd + "/" + it->fileName;
+		int redir_file = it->isOut ?
+				open(fileName.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC,
+						S_IRUSR | S_IRGRP | S_IROTH) :
+				open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+		if (redir_file < 0) {
+			int retError = errno;
+			*err << (it->isOut ?
+					"Failed to open/create file to which should be stdout redirected" :
+					"Failed to open file from which should be stdin taken")
+					<< " - open(): " << strerror(retError) << endl;
+			for (size_t i = 0; i < opened.size(); i++) {
+				close(opened[i]);
+			}
+			return -retError;
+		}
+		opened.push_back(redir_file);
+		request.fds[it->isOut ? STDOUT_FILENO : STDIN_FILENO] = redir_file;
+		outRedirected = outRedirected || it->isOut;
+		inRedirected = inRedirected || !it->isOut;
+	}
+
+	/* Child on background gets no input and its output is discarded */
+	if (cmdInfo.runOnBackground || args.periodic) {
+		request.fds[STDIN_FILENO] =
+				inRedirected ? request.fds[STDIN_FILENO] : devnull_fd;
+	}
+	if (cmdInfo.runOnBackground) {
+		request.fds[STDOUT_FILENO] =
+				outRedirected ? request.fds[STDOUT_FILENO] : devnull_fd;
+	}
+
+	TRACE_BEGIN(FORK);
+	pid_t pid = ForkServer::spawn(request);
+	TRACE_END(FORK);
+	for (size_t i = 0; i < opened.size(); i++) {
+		close(opened[i]);
+	}
+
+	if (pid < 0) {
+		*err << "Failed to create a new process by fork server: "
+				<< strerror(-pid) << endl;
+	}
+	return pid;
+}
+
+/**
+ * Redirects stdin and stdout.
+ * @param cmdInfo Information about parsed line.
+ * @param outRedirected Is set whether some stdout redirection was proceeded.
+ * @param inRedirected Is set whether some stdin redirection was proceeded.
+ * @return Code which signals sucess or failure. 0 is returned on success.
+ */
+int CommandExecutor::redirectStdInOut(const CommandInfo &cmdInfo,
+		bool &outRedirected, bool &inRedirected) {
+	int retError = 0;
+	errno = 0;
+
+	outRedirected = false;
+	inRedirected = false;
+
+	int ret = EXIT_SUCCESS;
+	for (vector<RedirectInfo>::const_iterator it = cmdInfo.redirects.begin();
+			it != cmdInfo.redirects.end(); it++) {
+		const RedirectInfo &info = *it;
+
+		int redir_file, file_no;
+
+		if (info.isOut) {
+			outRedirected = true;
+			file_no = STDOUT_FILENO;
+			if ((redir_file = open(info.fileName.c_str(), O_CREAT | O_WRONLY,
+					S_IRUSR | S_IRGRP | S_IROTH)) < 0) {
+				retError = errno;
+				perror(
+						"Failed to open/create file to which should be stdout redirected - open()");
+				ret = (retError != 0) ? errno : EXIT_FAILURE;
+				break;
+			}
+		} else {
+			inRedirected = true;
+			file_no = STDIN_FILENO;
+			if ((redir_file = open(info.fileName.c_str(), O_RDONLY)) < 0) {
+				retError = errno;
+				perror(
+						"Failed to open file from which should be stdin taken - open()");
+				ret = (retError != 0) ? errno : EXIT_FAILURE;
+				break;
+			}
+		}
+
+		cout << flush;
+
+		if (dup2(redir_file, file_no) < 0) {
+			retError = errno;
+			perror(
+					"Failed to establish redirecting of stdin or stdout - dup2()");
+			close(redir_file);
+			ret = (retError != 0) ? errno : EXIT_FAILURE;
+			break;
+		}
+		close(redir_file);
+
+	}
+
+	return ret;
+}
+
+/**
+ * Redirects passed file descriptor to /dev/null.
+ * @param fd File descriptor which should be redirected do /dev/null.
+ * @return 0 on success, othewise error code
+ */
+int CommandExecutor::detachFD(int fd) {
+	int retError = 0;
+	errno = 0;
+
+	if (dup2(devnull_fd, fd) < 0) {
+		retError = errno;
+		stringstream ss;
+		ss << "Failed to detach file descriptor " << fd
+				<< " for background process to /dev/null  - dup2()";
+		string msg = ss.str();
+		perror(msg.c_str());
+		return (retError != 0) ? errno : EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Handle function for new forked process.
+ * Executes parsed command from command line.
+ * @param arg Informations about parsed line.
+ * @return Exit code of the new process.
+ */
+int CommandExecutor::executionHandler(void *arg) {
+	ChildArgs &args = *static_cast<ChildArgs *>(arg);
+	const CommandInfo &cmdInfo = *args.cmdInfo;
+
+	int retError = 0;
+	errno = 0;
+
+	bool outRedirected, inRedirected;
+
+	/* SIGCHLD has been blocked by the parent */
+
+	sigset_t mask;
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	sigprocmask(SIG_UNBLOCK, &mask, NULL);
+
+	if (args.newGroup) {
+		setpgid(0, 0);
+	}
+
+	/* Set up descriptors of the session and redirections */
+
+	TRACE_BEGIN(REDIRECT);
+	for (int fd = STDIN_FILENO; fd <= STDERR_FILENO; fd++) {
+		if (args.fds[fd] != fd && dup2(args.fds[fd], fd) == -1) {
+			perror("Failed to set up descriptors of the session - dup2()");
+			return EXIT_FAILURE;
+		}
+	}
+	if (!args.executor->cwd.empty() && chdir(args.executor->cwd.c_str()) != 0) {
+		perror("Failed to change working directory - chdir()");
+		return EXIT_FAILURE;
+	}
+
+	if ((retError = redirectStdInOut(cmdInfo, outRedirected, inRedirected))
+			!= EXIT_SUCCESS) {
+		return retError;
+	}
+
+	/* If running of command on background is demanded then redirect stdin/stdout/stderr to /dev/null
+	 * Shell does not recieves any feedback from the process on the background 
+	 * Periodic run of the every builtin gets no input, but keeps its output
+	 */
+	if ((cmdInfo.runOnBackground || args.periodic) && !inRedirected
+			&& ((retError = detachFD(STDIN_FILENO)) != EXIT_SUCCESS)) {
+		return retError;
+	}
+	if (cmdInfo.runOnBackground) {
+
+		/*if ((retError = detachFD(STDERR_FILENO)) != EXIT_SUCCESS) {
+		 return retError; 
+		 }*/
+
+		if (!outRedirected
+				&& ((retError = detachFD(STDOUT_FILENO)) != EXIT_SUCCESS)) {
+			return retError;
+		}
+	}
+	TRACE_CHILD_END(REDIRECT);
+	TRACE_BEGIN(EXEC);
+
+	/* Setup behaviour on SIGINT command */
+
+	struct sigaction sa;
+	bool background = cmdInfo.runOnBackground || args.periodic;
+	sa.sa_flags = (background) ? 0 : SA_RESTART | SA_SIGINFO;
+	sa.sa_handler = (background) ? SIG_IGN : SIG_DFL;
+
+	sigemptyset(&sa.sa_mask);
+	sigaddset(&sa.sa_mask, SIGINT);
+
+	if (sigaction(SIGINT, &sa, NULL) == -1) {
+		retError = errno;
+		perror("Failed - sigaction(SIGINT)");
+		return (retError != 0) ? errno : EXIT_FAILURE;
+	}
+
+	/* Affinity, nice, policy and I/O priority of the sched prefix */
+
+	if ((retError = Scheduling::apply(args.sched)) != EXIT_SUCCESS) {
+		return retError;
+	}
+
+	/* CPU time, address space, files and processes of the ulimit */
+
+	if ((retError = ResourceLimits::apply(args.limits)) != EXIT_SUCCESS) {
+		return retError;
+	}
+
+	/*vector<char *> argv(cmdInfo.arguments.size() + 2);
+
+	 argv[0] = &cmdInfo.programName[0];
+	 int i = 1;
+	 for (vector<string>::iterator it = cmdInfo.arguments.begin(); it != cmdInfo.arguments.end(); it++) {
+	 argv[i++] = &(*it)[0];
+	 }
+	 argv[argv.size() - 1] = NULL;          */
+
+	/* Executes command with the arguments known from parsing */
+
+	if (!cmdInfo.expandArgs) {
+		vector<char *> argv(cmdInfo.argv.size() + 1);
+		for (size_t i = 0; i < cmdInfo.argv.size(); i++) {
+			argv[i] = const_cast<char *>(cmdInfo.argv[i].c_str());
+		}
+		argv[cmdInfo.argv.size()] = NULL;
+		TRACE_CHILD_END(EXEC);
+		if (!args.program.empty()) { // PATH is searched when it fails
+			execv(args.program.c_str(), &argv[0]);
+		}
+		execvp(argv[0], &argv[0]);
+		retError = errno;
+
+		perror("Failed - execv()");
+		return (retError == ENOENT) ? EXIT_NOT_FOUND : EXIT_NOT_EXECUTABLE;
+	}
+
+	/* Executes command with the argumetns parsed by wordexp */
+
+	wordexp_t res;
+	if (wordexp(cmdInfo.programNameArgs.c_str(), &res, 0) != 0) {
+		return EXIT_FAILURE;
+	}
+	TRACE_CHILD_END(EXEC);
+	execvp(res.we_wordv[0], res.we_wordv);
+
+	/*execvp(&cmdInfo.programName[0], &argv[0]);*/
+	retError = errno;
+
+	perror("Failed - execv()");
+	return (retError == ENOENT) ? EXIT_NOT_FOUND : EXIT_NOT_EXECUTABLE;
+
+}
+
+/**
+ * Runs simple command - parses it and starts new process.
+ * @param commandLine Command line with expanded variables.
+ * @return Exit status of the command.
+ */
+int CommandExecutor::runCommand(const string &commandLine) {
+	bool found;
+	int status = runBuiltin(commandLine, found);
+	if (found) {
+		return status;
+	}
+
+	const CommandInfo *cmdInfo = parseCommand(commandLine);
+	if (cmdInfo == NULL) {
+		Metrics::increment(Metrics::PARSE_FAILURES);
+		*err << "Typed invalid command!" << endl;
+		return EXIT_FAILURE;
+	}
+	Metrics::increment(Metrics::COMMANDS_PARSED);
+
+	/* Executing command */
+	return executeCommand(*cmdInfo);
+}
+
+
@@ -0,0 +1,230 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       CommandExecutor.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines executor of the command lines
+//             with the state of one shell session.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file CommandExecutor.h
+ *
+ * @brief Header file which defines executor of the command lines with
+ *        the state of one shell session.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef COMMANDEXECUTOR_H_INCLUDED
+#define COMMANDEXECUTOR_H_INCLUDED
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <cstdio>
+#include <stdint.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "BytecodeInterpreter.h"
+#include "LRUCache.h"
+#include "DelimiterScanner.h"
+#include "JobTable.h"
+#include "Scheduling.h"
+#include "ResourceLimits.h"
+#include "History.h"
+#include "Completer.h"
+
+using namespace std;
+
+class ChangeWatcherPThread;
+class PeriodicOwner;
+class TaskGraph;
+
+/**
+ * Executor of the lines of one session - variables and functions of the
+ * interpreter, working directory, children and cache of parsed commands.
+ * Lines are compiled and run by the interpreter, which passes simple
+ * commands back to the executor. Output of the builtins is written into
+ * the out and err streams of the executor.
+ */
+class CommandExecutor: public CommandRunner {
+public:
+	static const size_t STACK_SIZE = 512 * 1024; /**< of threads running lines, functions recurse */
+
+	CommandExecutor(JobTable &jobTable);
+	virtual ~CommandExecutor();
+	virtual int runCommand(const string &commandLine);
+	virtual ostream &getErrorStream();
+	string getCwd() const;
+	bool setTimingLog(const string &fileName);
+	void setHistory(History *history);
+protected:
+	BytecodeInterpreter interpreter;
+	unsigned long lineSeq; /**< number of the line being run */
+	JobTable &jobTable;
+	string cwd; /**< working directory of children, empty for the one of shell */
+	ostream *out; /**< output of the builtins */
+	ostream *err; /**< errors of the builtins and the interpreter */
+	History *history; /**< lines of the terminal, NULL when not kept */
+
+	static int devnull_fd;
+
+	void reportFinishedJobs();
+	void runPeriodic(PeriodicOwner *owner);
+
+	/**
+	 * Returns stdin, stdout and stderr of the children before redirections.
+	 * @param fds Array of three descriptors which will be filled.
+	 */
+	virtual void getChildDescriptors(int *fds) {
+		fds[0] = STDIN_FILENO;
+		fds[1] = STDOUT_FILENO;
+		fds[2] = STDERR_FILENO;
+	}
+
+	/**
+	 * Returns descriptor which becomes readable when the executor should stop,
+	 * -1 when it is stopped only after its commands finish.
+	 */
+	virtual int getStopFd() {
+		return -1;
+	}
+	bool isStopping();
+private:
+	friend class ShellBench; /**< measures parsing and spawning directly */
+
+	/**
+	 * Keeps informations about redirect files.
+	 */
+	typedef struct {
+		bool isOut;
+		string fileName;
+	} RedirectInfo;
+
+	/**
+	 * Structure which hold informations about parsed command line.
+	 */
+	typedef struct {
+		string programName;
+		string programNameArgs;
+		vector<string> arguments;
+		vector<RedirectInfo> redirects;
+		bool runOnBackground;
+		bool expandArgs; /**< wordexp is needed, otherwise argv is used */
+		vector<string> argv;
+	} CommandInfo;
+
+	/**
+	 * Parsed command stored in the cache, line is kept to detect collisions.
+	 */
+	typedef struct {
+		string line;
+		CommandInfo cmdInfo;
+	} CachedCommand;
+
+	/**
+	 * Arguments of the forked child.
+	 */
+	typedef struct {
+		CommandExecutor *executor;
+		const CommandInfo *cmdInfo;
+		int fds[3]; /**< descriptors of the session */
+		bool newGroup; /**< child leads its own process group */
+		bool periodic; /**< run of the every builtin, it gets no input */
+		string program; /**< path of argv[0] from the command index */
+		SchedAttrs sched; /**< applied before exec */
+		LimitAttrs limits; /**< applied before exec */
+	} ChildArgs;
+
+	typedef int (CommandExecutor::*BuiltinHandler)(const vector<string> &args,
+			const string &commandLine);
+
+	/**
+	 * Command which is run by the shell itself.
+	 */
+	typedef struct {
+		const char *name;
+		BuiltinHandler handler;
+	} Builtin;
+
+	static const Builtin BUILTINS[];
+	static const size_t COMMAND_CACHE_SIZE = 256;
+	static const int EXIT_NOT_EXECUTABLE = 126;
+	static const int EXIT_NOT_FOUND = 127;
+	static const int EXIT_TIMED_OUT = 124;
+	static const int EXIT_STOPPED = 128 + SIGTERM;
+	static const size_t MAX_TASK_JOBS = JobTable::MAX_JOBS / 2; /**< of tasks */
+	static const char EXPANSION_CHARS[];
+
+	LRUCache<uint64_t, CachedCommand> commandCache;
+	DelimiterBitmap lineBitmap; /**< of the parsed line, reused */
+	double parseTime; /**< seconds spent by parsing of not cached lines */
+	unsigned long parseCount; /**< valid lines whose parsing is in parseTime */
+	FILE *timingLog; /**< one line with resource usage per command */
+	unsigned long foregroundCount; /**< number of finished foreground children */
+	Job lastJob; /**< the last finished foreground child */
+	SchedAttrs commandSched; /**< set by the sched prefix of the command */
+	SchedAttrs backgroundSched; /**< default of the background children */
+	LimitAttrs commandLimits; /**< set by the ulimit prefix of the command */
+	LimitAttrs sessionLimits; /**< default of all children */
+	long commandTimeout; /**< milliseconds set by the timeout prefix, 0 none */
+	long commandKillAfter; /**< milliseconds between SIGTERM and SIGKILL */
+	int captureFd; /**< stdout of the memoized command, -1 none */
+	ChangeWatcherPThread *changeWatcher; /**< of the running on-change */
+	bool periodicRun; /**< command is run by every, it is not waited for */
+	bool parallelRun; /**< command is run by tasks, which waits for it */
+	pid_t spawnedPid; /**< the last started child */
+	Completer completer;
+
+	bool processCommand(CommandInfo &cmdInfo, const string &line,
+			const DelimiterBitmap &bitmap);
+	const CommandInfo *parseCommand(const string &commandLine);
+
+	int executeCommand(const CommandInfo &cmdInfo);
+	int waitJob(Job *job);
+	bool waitExit(pid_t pid);
+	int spawnByForkServer(const ChildArgs &args);
+	void logJob(const Job &job);
+	string commandEventFields(const CommandInfo &cmdInfo);
+
+	int runBuiltin(const string &commandLine, bool &found);
+	int builtinParseCache(const vector<string> &args, const string &commandLine);
+	int builtinTime(const vector<string> &args, const string &commandLine);
+	int builtinTiming(const vector<string> &args, const string &commandLine);
+	int builtinStats(const vector<string> &args, const string &commandLine);
+	int builtinMonitors(const vector<string> &args, const string &commandLine);
+	int builtinCd(const vector<string> &args, const string &commandLine);
+	int builtinPwd(const vector<string> &args, const string &commandLine);
+	int builtinSched(const vector<string> &args, const string &commandLine);
+	int builtinUlimit(const vector<string> &args, const string &commandLine);
+	int builtinTimeout(const vector<string> &args, const string &commandLine);
+	int builtinHistory(const vector<string> &args, const string &commandLine);
+	int builtinComplete(const vector<string> &args, const string &commandLine);
+	int builtinMemo(const vector<string> &args, const string &commandLine);
+	int builtinOnChange(const vector<string> &args, const string &commandLine);
+	int builtinEvery(const vector<string> &args, const string &commandLine);
+	int builtinTasks(const vector<string> &args, const string &commandLine);
+
+	uint64_t memoKey(const string &commandLine, const vector<string> &files,
+			const vector<string> &names);
+	off_t serveOutput(int fd);
+	int runTasks(TaskGraph &graph, size_t jobs, bool keepGoing, bool force);
+
+	static string skipWords(const string &commandLine, size_t count);
+	int startProcess(int(*processHandler)(void *arg), void *arg);
+
+	static int executionHandler(void *arg);
+	static int redirectStdInOut(const CommandInfo &cmdInfo, bool &outRedirected,
+			bool &inRedirected);
+	static int detachFD(int fd);
+
+	CommandExecutor(const CommandExecutor &);
+	CommandExecutor &operator=(const CommandExecutor &);
+};
+
+#endif // COMMANDEXECUTOR_H_INCLUDED
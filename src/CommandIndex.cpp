@@ -0,0 +1,303 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       CommandIndex.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements index of the executables in PATH.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file CommandIndex.cpp
+ *
+ * @brief Source file which implements index of the executables in PATH.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+#include <cstdlib>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+
+#include "CommandIndex.h"
+
+using namespace std;
+
+CommandIndex *CommandIndex::instance = NULL;
+pthread_mutex_t CommandIndex::instanceMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Constructor.
+ */
+CommandIndex::CommandIndex() :
+		monitor("commandindex"), changed(monitor, "changed"), built(false), refreshRequested(
+				false), usable(false), lastRefresh(now()) {
+}
+
+/**
+ * Destructor, stops the thread.
+ */
+CommandIndex::~CommandIndex() {
+	cancel();
+}
+
+/**
+ * Returns the index, it is created and its building is started on demand.
+ */
+CommandIndex *CommandIndex::getInstance() {
+	pthread_mutex_lock(&instanceMutex);
+	if (instance == NULL) {
+		instance = new CommandIndex();
+		instance->start();
+	}
+	CommandIndex *index = instance;
+	pthread_mutex_unlock(&instanceMutex);
+	return index;
+}
+
+/**
+ * Main function where index thread builds the index and refreshes it
+ * when it is requested.
+ * @return Exit code of this thread.
+ */
+int CommandIndex::run() {
+	while (!isStopRequested()) {
+		rebuild();
+
+		monitor.enter();
+		while (!refreshRequested && !isStopRequested()) {
+			changed.wait();
+		}
+		refreshRequested = false;
+		monitor.exit();
+	}
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Finds executable in the index.
+ * @param name Name of the command without slash.
+ * @param path Path of the executable, found in the first directory of PATH.
+ * @return True if executable has been found, false if it has not been found
+ * or the index is not built yet.
+ */
+bool CommandIndex::lookup(const string &name, string &path) {
+	CommandIndex *index = getInstance();
+	bool found = false;
+
+	index->monitor.enter();
+	if (index->built && index->usable) {
+		Entries::const_iterator it = index->find(name);
+		if (it != index->entries.end() && it->first == name) {
+			path = it->second;
+			found = true;
+		}
+	}
+	index->requestRefresh();
+	index->monitor.exit();
+
+	return found;
+}
+
+/**
+ * Finds names of the executables starting with prefix, waits until
+ * the index is built for the first time.
+ * @param prefix Prefix of the command name.
+ * @param names Sorted names are appended here.
+ */
+void CommandIndex::complete(const string &prefix, vector<string> &names) {
+	CommandIndex *index = getInstance();
+
+	index->monitor.enter();
+	while (!index->built) {
+		index->changed.wait();
+	}
+	for (Entries::const_iterator it = index->find(prefix);
+			it != index->entries.end()
+					&& it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+		names.push_back(it->first);
+	}
+	index->requestRefresh();
+	index->monitor.exit();
+}
+
+/**
+ * Returns number of the indexed executables, waits until the index is built.
+ */
+size_t CommandIndex::size() {
+	CommandIndex *index = getInstance();
+
+	index->monitor.enter();
+	while (!index->built) {
+		index->changed.wait();
+	}
+	size_t result = index->entries.size();
+	index->monitor.exit();
+	return result;
+}
+
+/**
+ * Stops and deletes the index.
+ */
+void CommandIndex::stop() {
+	pthread_mutex_lock(&instanceMutex);
+	CommandIndex *index = instance;
+	instance = NULL;
+	pthread_mutex_unlock(&instanceMutex);
+
+	delete index;
+}
+
+/**
+ * Scans directories of PATH whose mtime has changed and replaces the index
+ * if any of them has changed. Relative directories depend on the working
+ * directory of the session, so the index is not used for lookups then.
+ */
+void CommandIndex::rebuild() {
+	const char *env = getenv("PATH");
+	string currentPath = (env != NULL) ? env : "/bin:/usr/bin";
+	bool modified = currentPath != path;
+	bool absolute = true;
+
+	vector<string> order;
+	set<string> seen;
+	stringstream ss(currentPath);
+	string dir;
+	while (getline(ss, dir, ':')) {
+		if (dir.empty() || dir[0] != '/') {
+			absolute = false;
+		} else if (seen.insert(dir).second) {
+			order.push_back(dir);
+		}
+	}
+
+	map<string, Directory> scanned;
+	for (size_t i = 0; i < order.size(); i++) {
+		map<string, Directory>::iterator it = directories.find(order[i]);
+		struct stat st;
+		if (stat(order[i].c_str(), &st) == -1 || !S_ISDIR(st.st_mode)) {
+			modified = modified || it != directories.end();
+			continue;
+		}
+
+		Directory &directory = scanned[order[i]];
+		if (it != directories.end() && it->second.device == st.st_dev
+				&& it->second.inode == st.st_ino
+				&& it->second.mtime.tv_sec == st.st_mtim.tv_sec
+				&& it->second.mtime.tv_nsec == st.st_mtim.tv_nsec) {
+			directory.names.swap(it->second.names);
+		} else {
+			scan(order[i], directory);
+			modified = true;
+		}
+		directory.device = st.st_dev;
+		directory.inode = st.st_ino;
+		directory.mtime = st.st_mtim;
+	}
+	modified = modified || scanned.size() != directories.size();
+	directories.swap(scanned);
+	path = currentPath;
+
+	if (!modified) {
+		return;
+	}
+
+	/* The first directory of PATH wins */
+	map<string, string> merged;
+	for (size_t i = 0; i < order.size(); i++) {
+		map<string, Directory>::iterator it = directories.find(order[i]);
+		if (it == directories.end()) {
+			continue;
+		}
+		const vector<string> &names = it->second.names;
+		for (size_t j = 0; j < names.size(); j++) {
+			merged.insert(make_pair(names[j], order[i] + "/" + names[j]));
+		}
+	}
+	Entries sorted(merged.begin(), merged.end());
+
+	monitor.enter();
+	entries.swap(sorted);
+	usable = absolute;
+	built = true;
+	changed.broadcast();
+	monitor.exit();
+}
+
+/**
+ * Requests refresh of the index, at most once per REFRESH_INTERVAL.
+ * Must be called inside of the monitor.
+ */
+void CommandIndex::requestRefresh() {
+	uint64_t current = now();
+	if (current - lastRefresh >= (uint64_t) REFRESH_INTERVAL) {
+		lastRefresh = current;
+		refreshRequested = true;
+		changed.broadcast();
+	}
+}
+
+/**
+ * Wakes up the index thread when its stop is requested.
+ */
+void CommandIndex::wakeUp() {
+	monitor.enter();
+	changed.broadcast();
+	monitor.exit();
+}
+
+/**
+ * Returns the first entry which is not less than prefix, must be called
+ * inside of the monitor.
+ */
+CommandIndex::Entries::const_iterator CommandIndex::find(
+		const string &prefix) const {
+	return lower_bound(entries.begin(), entries.end(),
+			make_pair(prefix, string()));
+}
+
+/**
+ * Finds executable regular files of the directory.
+ * @return True on success, false if the directory cannot be read.
+ */
+bool CommandIndex::scan(const string &dir, Directory &directory) {
+	directory.names.clear();
+	DIR *stream = opendir(dir.c_str());
+	if (stream == NULL) {
+		return false;
+	}
+
+	struct dirent *entry;
+	while ((entry = readdir(stream)) != NULL) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0
+				|| (entry->d_type != DT_REG && entry->d_type != DT_LNK
+						&& entry->d_type != DT_UNKNOWN)) {
+			continue;
+		}
+		struct stat st;
+		if (fstatat(dirfd(stream), entry->d_name, &st, 0) == 0
+				&& S_ISREG(st.st_mode) && (st.st_mode & 0111) != 0) {
+			directory.names.push_back(entry->d_name);
+		}
+	}
+	closedir(stream);
+	return true;
+}
+
+/**
+ * Returns monotonic time in milliseconds.
+ */
+uint64_t CommandIndex::now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000UL + ts.tv_nsec / 1000000;
+}
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       CommandIndex.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines index of the executables in PATH.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file CommandIndex.h
+ *
+ * @brief Header file which defines index of the executables in PATH.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef COMMANDINDEX_H_INCLUDED
+#define COMMANDINDEX_H_INCLUDED
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+
+#include "PThread.h"
+
+using namespace std;
+
+/**
+ * Index of the executables in the directories of PATH, sorted by name,
+ * shared by all sessions. It completes command names and it is the PATH
+ * lookup cache of the children, which are executed by their path instead
+ * of trying every directory. Index is built by background thread started
+ * by the first use. Lookups request refresh, at most once per
+ * REFRESH_INTERVAL, then only directories whose mtime has changed are
+ * scanned again.
+ */
+class CommandIndex: public PThread {
+public:
+	static const long REFRESH_INTERVAL = 1000; /**< milliseconds */
+
+	virtual ~CommandIndex();
+	virtual int run();
+
+	static bool lookup(const string &name, string &path);
+	static void complete(const string &prefix, vector<string> &names);
+	static size_t size();
+	static void stop();
+private:
+	/**
+	 * Scanned directory of PATH.
+	 */
+	typedef struct {
+		dev_t device;
+		ino_t inode;
+		struct timespec mtime;
+		vector<string> names; /**< executables */
+	} Directory;
+
+	typedef vector<pair<string, string> > Entries; /**< name and path */
+
+	PThreadMonitor monitor;
+	PThreadCondition changed; /**< index is built or refresh is requested */
+	bool built;
+	bool refreshRequested;
+	bool usable; /**< PATH has no relative directory */
+	uint64_t lastRefresh; /**< monotonic milliseconds */
+	Entries entries;
+	string path; /**< PATH of the index, used by index thread only */
+	map<string, Directory> directories; /**< used by index thread only */
+
+	static CommandIndex *instance;
+	static pthread_mutex_t instanceMutex;
+
+	CommandIndex();
+	void rebuild();
+	void requestRefresh();
+	void wakeUp();
+	Entries::const_iterator find(const string &prefix) const;
+
+	static CommandIndex *getInstance();
+	static bool scan(const string &dir, Directory &directory);
+	static uint64_t now();
+};
+
+#endif // COMMANDINDEX_H_INCLUDED
@@ -0,0 +1,140 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       Completer.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements completion of the command names
+//             and file names.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Completer.cpp
+ *
+ * @brief Source file which implements completion of the command names
+ *        and file names.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "CommandIndex.h"
+#include "Completer.h"
+
+using namespace std;
+
+/**
+ * Constructor.
+ */
+Completer::Completer() :
+		directories(DIRECTORY_CACHE_SIZE) {
+}
+
+/**
+ * Completes the last word of the line.
+ * @param words Words of the line, the last one is completed.
+ * @param cwd Working directory of the session.
+ * @param builtins Names of the builtins.
+ * @param candidates Sorted unique candidates are appended here.
+ */
+void Completer::complete(const vector<string> &words, const string &cwd,
+		const vector<string> &builtins, vector<string> &candidates) {
+	const string &word = words.empty() ? "" : words.back();
+	if (words.size() > 1 || word.find('/') != string::npos) {
+		completeFile(word, cwd, candidates);
+		return;
+	}
+
+	vector<string> names;
+	CommandIndex::complete(word, names);
+	for (size_t i = 0; i < builtins.size(); i++) {
+		if (builtins[i].compare(0, word.size(), word) == 0) {
+			names.push_back(builtins[i]);
+		}
+	}
+	sort(names.begin(), names.end());
+	names.erase(unique(names.begin(), names.end()), names.end());
+	candidates.insert(candidates.end(), names.begin(), names.end());
+}
+
+/**
+ * Completes file name, directories end by slash.
+ * @param word Absolute or relative path which is completed.
+ * @param cwd Working directory of the session.
+ * @param candidates Sorted candidates are appended here.
+ */
+void Completer::completeFile(const string &word, const string &cwd,
+		vector<string> &candidates) {
+	size_t slash = word.rfind('/');
+	string head = (slash != string::npos) ? word.substr(0, slash + 1) : "";
+	string base = word.substr(head.size());
+	string dir = head.empty() ? cwd : (head[0] == '/') ? head : cwd + "/" + head;
+
+	const Listing *listing = list(dir.empty() ? "." : dir);
+	if (listing == NULL) {
+		return;
+	}
+
+	const vector<string> &names = listing->names;
+	for (vector<string>::const_iterator it = lower_bound(names.begin(),
+			names.end(), base);
+			it != names.end() && it->compare(0, base.size(), base) == 0; ++it) {
+		if ((*it)[0] != '.' || (!base.empty() && base[0] == '.')) {
+			candidates.push_back(head + *it);
+		}
+	}
+}
+
+/**
+ * Returns listing of the directory, it is read again when its mtime has
+ * changed.
+ * @return Listing or NULL if the directory cannot be read.
+ */
+const Completer::Listing *Completer::list(const string &dir) {
+	struct stat st;
+	if (stat(dir.c_str(), &st) == -1 || !S_ISDIR(st.st_mode)) {
+		return NULL;
+	}
+
+	Listing *cached = directories.get(dir);
+	if (cached != NULL && cached->device == st.st_dev
+			&& cached->inode == st.st_ino
+			&& cached->mtime.tv_sec == st.st_mtim.tv_sec
+			&& cached->mtime.tv_nsec == st.st_mtim.tv_nsec) {
+		return cached;
+	}
+
+	DIR *stream = opendir(dir.c_str());
+	if (stream == NULL) {
+		return NULL;
+	}
+	Listing listing;
+	listing.device = st.st_dev;
+	listing.inode = st.st_ino;
+	listing.mtime = st.st_mtim;
+	struct dirent *entry;
+	while ((entry = readdir(stream)) != NULL) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+			continue;
+		}
+		bool isDir = entry->d_type == DT_DIR;
+		struct stat entrySt;
+		if ((entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN)
+				&& fstatat(dirfd(stream), entry->d_name, &entrySt, 0) == 0) {
+			isDir = S_ISDIR(entrySt.st_mode);
+		}
+		listing.names.push_back(string(entry->d_name) + (isDir ? "/" : ""));
+	}
+	closedir(stream);
+	sort(listing.names.begin(), listing.names.end());
+
+	return &directories.put(dir, listing);
+}
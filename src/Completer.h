@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       Completer.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines completion of the command names
+//             and file names.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Completer.h
+ *
+ * @brief Header file which defines completion of the command names and file
+ *        names.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef COMPLETER_H_INCLUDED
+#define COMPLETER_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include <time.h>
+#include <sys/types.h>
+
+#include "LRUCache.h"
+
+using namespace std;
+
+/**
+ * Completes the last word of the line - the first word by the names
+ * of the builtins and the executables of the command index, other words
+ * and words with slash by the file names. Listings of the directories
+ * are cached while their mtime does not change. Completer belongs
+ * to one session, it is not thread safe.
+ */
+class Completer {
+public:
+	static const size_t DIRECTORY_CACHE_SIZE = 64;
+
+	Completer();
+
+	void complete(const vector<string> &words, const string &cwd,
+			const vector<string> &builtins, vector<string> &candidates);
+	void completeFile(const string &word, const string &cwd,
+			vector<string> &candidates);
+private:
+	/**
+	 * Sorted listing of the directory, directories end by slash.
+	 */
+	typedef struct {
+		dev_t device;
+		ino_t inode;
+		struct timespec mtime;
+		vector<string> names;
+	} Listing;
+
+	LRUCache<string, Listing> directories;
+
+	const Listing *list(const string &dir);
+};
+
+#endif // COMPLETER_H_INCLUDED
@@ -0,0 +1,329 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       DelimiterScanner.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements vectorized scanner of token
+//             delimiters in the input blocks.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file DelimiterScanner.cpp
+ *
+ * @brief Source file which implements vectorized scanner of token delimiters
+ *        in the input blocks.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstring>
+
+#include "DelimiterScanner.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCANNER_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+/**
+ * Classes of all bytes for the scalar scanner, bit 0 is set for delimiters
+ * and bit 1 for newlines.
+ */
+static const struct ByteClasses {
+	unsigned char of[256];
+
+	ByteClasses() {
+		const char delimiters[] = " \t\r\n&<>|";
+		memset(of, 0, sizeof(of));
+		for (const char *c = delimiters; *c != '\0'; c++) {
+			of[(unsigned char) *c] = 1;
+		}
+		of[(unsigned char) '\n'] |= 2;
+	}
+} BYTE_CLASSES;
+
+/**
+ * Tests whether character separates tokens of the command line.
+ * @param c Tested character.
+ * @return True if character is delimiter.
+ */
+bool DelimiterScanner::isDelimiter(char c) {
+	return (BYTE_CLASSES.of[(unsigned char) c] & 1) != 0;
+}
+
+/**
+ * Scans block by the best variant supported by this CPU.
+ * @param data Scanned block.
+ * @param length Length of the block.
+ * @param bitmap Bitmap which will be filled.
+ */
+void DelimiterScanner::scan(const char *data, size_t length,
+		DelimiterBitmap &bitmap) {
+	static Variant best = bestVariant();
+	scan(data, length, bitmap, best);
+}
+
+/**
+ * Scans block by the demanded variant.
+ * @param data Scanned block.
+ * @param length Length of the block.
+ * @param bitmap Bitmap which will be filled.
+ * @param variant Variant of the scanner, must be supported.
+ */
+void DelimiterScanner::scan(const char *data, size_t length,
+		DelimiterBitmap &bitmap, Variant variant) {
+	size_t words = (length + 63) / 64;
+	bitmap.delimiters.assign(words, 0);
+	bitmap.newlines.assign(words, 0);
+
+	if (words == 0) {
+		return;
+	}
+
+	switch (variant) {
+	case AVX2:
+		scanAVX2(data, length, &bitmap.delimiters[0], &bitmap.newlines[0]);
+		break;
+	case SSE2:
+		scanSSE2(data, length, &bitmap.delimiters[0], &bitmap.newlines[0]);
+		break;
+	default:
+		scanScalar(data, length, &bitmap.delimiters[0], &bitmap.newlines[0]);
+		break;
+	}
+}
+
+/**
+ * Tests whether variant can be run on this CPU.
+ * @param variant Tested variant.
+ * @return True if variant is supported.
+ */
+bool DelimiterScanner::isSupported(Variant variant) {
+	switch (variant) {
+	case SCALAR:
+		return true;
+#ifdef SCANNER_X86
+	case SSE2:
+		return __builtin_cpu_supports("sse2");
+	case AVX2:
+		return __builtin_cpu_supports("avx2");
+#endif
+	default:
+		return false;
+	}
+}
+
+/**
+ * Returns the fastest variant supported by this CPU.
+ * @return Variant of the scanner.
+ */
+DelimiterScanner::Variant DelimiterScanner::bestVariant() {
+	if (isSupported(AVX2)) {
+		return AVX2;
+	} else if (isSupported(SSE2)) {
+		return SSE2;
+	}
+	return SCALAR;
+}
+
+/**
+ * Returns printable name of the variant.
+ * @param variant Variant of the scanner.
+ * @return Name of the variant.
+ */
+const char *DelimiterScanner::variantName(Variant variant) {
+	switch (variant) {
+	case AVX2:
+		return "avx2";
+	case SSE2:
+		return "sse2";
+	default:
+		return "scalar";
+	}
+}
+
+/**
+ * Finds position of the next newline in the scanned block.
+ * @param bitmap Bitmap of the scanned block.
+ * @param from Position where to start searching.
+ * @param length Length of the scanned block.
+ * @return Position of the newline or length if there is no other newline.
+ */
+size_t DelimiterScanner::nextNewline(const DelimiterBitmap &bitmap,
+		size_t from, size_t length) {
+	return nextSet(bitmap.newlines, from, length);
+}
+
+/**
+ * Finds position of the next delimiter in the scanned block, so the token
+ * starting at from ends there.
+ * @param bitmap Bitmap of the scanned block.
+ * @param from Position where to start searching.
+ * @param length Length of the scanned block.
+ * @return Position of the delimiter or length if there is no other one.
+ */
+size_t DelimiterScanner::nextDelimiter(const DelimiterBitmap &bitmap,
+		size_t from, size_t length) {
+	return nextSet(bitmap.delimiters, from, length);
+}
+
+/**
+ * Tests whether byte of the scanned block is a delimiter.
+ * @param bitmap Bitmap of the scanned block.
+ * @param pos Position of the byte, less than length of the block.
+ */
+bool DelimiterScanner::isDelimiterAt(const DelimiterBitmap &bitmap,
+		size_t pos) {
+	return (bitmap.delimiters[pos / 64] >> (pos % 64)) & 1;
+}
+
+/**
+ * Finds the next set bit of the bitmap.
+ * @param bits Words of the bitmap.
+ * @param from Position where to start searching.
+ * @param length Length of the scanned block.
+ * @return Position of the bit or length if there is no other one.
+ */
+size_t DelimiterScanner::nextSet(const vector<uint64_t> &bits, size_t from,
+		size_t length) {
+	size_t word = from / 64;
+	if (from >= length) {
+		return length;
+	}
+
+	uint64_t set = bits[word] & (~(uint64_t) 0 << (from % 64));
+	while (set == 0) {
+		if (++word >= bits.size()) {
+			return length;
+		}
+		set = bits[word];
+	}
+
+	size_t pos = word * 64 + __builtin_ctzll(set);
+	return (pos < length) ? pos : length;
+}
+
+/**
+ * Portable variant of the scanner. Bits of one word are accumulated
+ * without branches from the classes of the bytes.
+ */
+void DelimiterScanner::scanScalar(const char *data, size_t length,
+		uint64_t *delims, uint64_t *newlines) {
+	for (size_t base = 0; base < length; base += 64) {
+		size_t end = (length - base < 64) ? length - base : 64;
+		uint64_t d = 0, n = 0;
+		for (size_t i = 0; i < end; i++) {
+			uint64_t cls = BYTE_CLASSES.of[(unsigned char) data[base + i]];
+			d |= (cls & 1) << i;
+			n |= (cls >> 1) << i;
+		}
+		delims[base / 64] |= d;
+		newlines[base / 64] |= n;
+	}
+}
+
+#ifdef SCANNER_X86
+
+/**
+ * SSE2 variant of the scanner, processes 16 bytes per compare.
+ */
+void DelimiterScanner::scanSSE2(const char *data, size_t length,
+		uint64_t *delims, uint64_t *newlines) {
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i cr = _mm_set1_epi8('\r');
+	const __m128i nl = _mm_set1_epi8('\n');
+	const __m128i amp = _mm_set1_epi8('&');
+	const __m128i lt = _mm_set1_epi8('<');
+	const __m128i gt = _mm_set1_epi8('>');
+	const __m128i bar = _mm_set1_epi8('|');
+
+	size_t blocks = length / 64;
+	for (size_t b = 0; b < blocks; b++) {
+		uint64_t d = 0, n = 0;
+		for (int part = 0; part < 4; part++) {
+			__m128i v = _mm_loadu_si128(
+					reinterpret_cast<const __m128i *>(data + b * 64 + part * 16));
+			__m128i isNl = _mm_cmpeq_epi8(v, nl);
+			__m128i m = _mm_or_si128(
+					_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), isNl),
+							_mm_or_si128(_mm_cmpeq_epi8(v, tab),
+									_mm_cmpeq_epi8(v, cr))),
+					_mm_or_si128(
+							_mm_or_si128(_mm_cmpeq_epi8(v, amp),
+									_mm_cmpeq_epi8(v, lt)),
+							_mm_or_si128(_mm_cmpeq_epi8(v, gt),
+									_mm_cmpeq_epi8(v, bar))));
+			d |= (uint64_t) (uint16_t) _mm_movemask_epi8(m) << (part * 16);
+			n |= (uint64_t) (uint16_t) _mm_movemask_epi8(isNl) << (part * 16);
+		}
+		delims[b] = d;
+		newlines[b] = n;
+	}
+
+	scanScalar(data + blocks * 64, length - blocks * 64, delims + blocks,
+			newlines + blocks);
+}
+
+/**
+ * AVX2 variant of the scanner, processes 32 bytes per compare.
+ */
+__attribute__((target("avx2"))) void DelimiterScanner::scanAVX2(
+		const char *data, size_t length, uint64_t *delims,
+		uint64_t *newlines) {
+	const __m256i space = _mm256_set1_epi8(' ');
+	const __m256i tab = _mm256_set1_epi8('\t');
+	const __m256i cr = _mm256_set1_epi8('\r');
+	const __m256i nl = _mm256_set1_epi8('\n');
+	const __m256i amp = _mm256_set1_epi8('&');
+	const __m256i lt = _mm256_set1_epi8('<');
+	const __m256i gt = _mm256_set1_epi8('>');
+	const __m256i bar = _mm256_set1_epi8('|');
+
+	size_t blocks = length / 64;
+	for (size_t b = 0; b < blocks; b++) {
+		uint64_t d = 0, n = 0;
+		for (int part = 0; part < 2; part++) {
+			__m256i v = _mm256_loadu_si256(
+					reinterpret_cast<const __m256i *>(data + b * 64 + part * 32));
+			__m256i isNl = _mm256_cmpeq_epi8(v, nl);
+			__m256i m = _mm256_or_si256(
+					_mm256_or_si256(
+							_mm256_or_si256(_mm256_cmpeq_epi8(v, space), isNl),
+							_mm256_or_si256(_mm256_cmpeq_epi8(v, tab),
+									_mm256_cmpeq_epi8(v, cr))),
+					_mm256_or_si256(
+							_mm256_or_si256(_mm256_cmpeq_epi8(v, amp),
+									_mm256_cmpeq_epi8(v, lt)),
+							_mm256_or_si256(_mm256_cmpeq_epi8(v, gt),
+									_mm256_cmpeq_epi8(v, bar))));
+			d |= (uint64_t) (uint32_t) _mm256_movemask_epi8(m) << (part * 32);
+			n |= (uint64_t) (uint32_t) _mm256_movemask_epi8(isNl)
+					<< (part * 32);
+		}
+		delims[b] = d;
+		newlines[b] = n;
+	}
+
+	scanScalar(data + blocks * 64, length - blocks * 64, delims + blocks,
+			newlines + blocks);
+}
+
+#else
+
+void DelimiterScanner::scanSSE2(const char *data, size_t length,
+		uint64_t *delims, uint64_t *newlines) {
+	scanScalar(data, length, delims, newlines);
+}
+
+void DelimiterScanner::scanAVX2(const char *data, size_t length,
+		uint64_t *delims, uint64_t *newlines) {
+	scanScalar(data, length, delims, newlines);
+}
+
+#endif
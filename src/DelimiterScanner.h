@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       DelimiterScanner.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines vectorized scanner of token
+//             delimiters in the input blocks.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file DelimiterScanner.h
+ *
+ * @brief Header file which defines vectorized scanner of token delimiters
+ *        in the input blocks.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef DELIMITERSCANNER_H_INCLUDED
+#define DELIMITERSCANNER_H_INCLUDED
+
+#include <stdint.h>
+#include <cstddef>
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Bitmap of the scanned block. Bit i of the word i / 64 is set when
+ * the i-th byte of the block is a delimiter (newline).
+ */
+typedef struct {
+	vector<uint64_t> delimiters; /**< whitespaces, newlines and & < > | */
+	vector<uint64_t> newlines; /**< only newlines */
+} DelimiterBitmap;
+
+/**
+ * Scanner which finds newlines, whitespaces and metacharacters in a whole
+ * block of the input at once. Reader splits lines by the newlines, parser
+ * of the commands splits tokens by the delimiters. The best variant is
+ * selected at runtime, all variants give identical results.
+ */
+class DelimiterScanner {
+public:
+	enum Variant {
+		SCALAR, SSE2, AVX2
+	};
+
+	static void scan(const char *data, size_t length, DelimiterBitmap &bitmap);
+	static void scan(const char *data, size_t length, DelimiterBitmap &bitmap,
+			Variant variant);
+
+	static bool isSupported(Variant variant);
+	static Variant bestVariant();
+	static const char *variantName(Variant variant);
+
+	static bool isDelimiter(char c);
+	static bool isDelimiterAt(const DelimiterBitmap &bitmap, size_t pos);
+	static size_t nextNewline(const DelimiterBitmap &bitmap, size_t from,
+			size_t length);
+	static size_t nextDelimiter(const DelimiterBitmap &bitmap, size_t from,
+			size_t length);
+private:
+	static size_t nextSet(const vector<uint64_t> &bits, size_t from,
+			size_t length);
+
+	static void scanScalar(const char *data, size_t length, uint64_t *delims,
+			uint64_t *newlines);
+	static void scanSSE2(const char *data, size_t length, uint64_t *delims,
+			uint64_t *newlines);
+	static void scanAVX2(const char *data, size_t length, uint64_t *delims,
+			uint64_t *newlines);
+};
+
+#endif // DELIMITERSCANNER_H_INCLUDED
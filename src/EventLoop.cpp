@@ -0,0 +1,159 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       EventLoop.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements loop dispatching readiness events
+//             of the descriptors.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file EventLoop.cpp
+ *
+ * @brief Source file which implements loop dispatching readiness events of
+ *        the descriptors.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cerrno>
+#include <cstdio>
+
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "EventLoop.h"
+
+using namespace std;
+
+/**
+ * Constructor, creates epoll instance with the wake up descriptor.
+ */
+EventLoop::EventLoop() :
+		epollFd(epoll_create1(EPOLL_CLOEXEC)), wakeFd(
+				eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
+	if (epollFd == -1) {
+		perror("Failed to create event loop - epoll_create1()");
+	}
+	if (wakeFd == -1) {
+		perror("Failed to create event loop - eventfd()");
+	}
+	if (isOpened()) {
+		struct epoll_event event;
+		event.events = EPOLLIN;
+		event.data.ptr = NULL;
+		if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) == -1) {
+			perror("Failed to create event loop - epoll_ctl()");
+		}
+	}
+}
+
+/**
+ * Destructor, registered descriptors are not closed.
+ */
+EventLoop::~EventLoop() {
+	if (epollFd != -1) {
+		close(epollFd);
+	}
+	if (wakeFd != -1) {
+		close(wakeFd);
+	}
+}
+
+/**
+ * Returns whether the loop has been created.
+ */
+bool EventLoop::isOpened() const {
+	return epollFd != -1 && wakeFd != -1;
+}
+
+/**
+ * Registers handler of the descriptor which becomes readable.
+ * @param fd Watched descriptor.
+ * @param handler Handler of its events.
+ * @param oneShot Whether descriptor is disabled after every event.
+ * @return True on success, false on failure.
+ */
+bool EventLoop::add(int fd, EventHandler *handler, bool oneShot) {
+	struct epoll_event event;
+	event.events = EPOLLIN | EPOLLRDHUP;
+	if (oneShot) {
+		event.events |= EPOLLONESHOT;
+	}
+	event.data.ptr = handler;
+	if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == -1) {
+		perror("Failed to watch descriptor - epoll_ctl()");
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Enables one-shot descriptor again after its event has been served.
+ * @param fd Watched descriptor.
+ * @param handler Handler of its events.
+ * @return True on success, false on failure.
+ */
+bool EventLoop::rearm(int fd, EventHandler *handler) {
+	struct epoll_event event;
+	event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+	event.data.ptr = handler;
+	if (epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event) == -1) {
+		perror("Failed to rearm descriptor - epoll_ctl()");
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Stops watching of the descriptor.
+ * @param fd Watched descriptor.
+ */
+void EventLoop::remove(int fd) {
+	struct epoll_event event; // Ignored, but required by old kernels
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, &event);
+}
+
+/**
+ * Waits for the events and calls their handlers.
+ * @param timeout Maximal time of waiting in milliseconds, -1 for no limit.
+ * @return Number of handled events, 0 on timeout or wake up, -1 on failure.
+ */
+int EventLoop::runOnce(int timeout) {
+	struct epoll_event events[MAX_EVENTS];
+	int count = epoll_wait(epollFd, events, MAX_EVENTS, timeout);
+	if (count == -1) {
+		if (errno == EINTR) {
+			return 0;
+		}
+		perror("Failed to wait for events - epoll_wait()");
+		return -1;
+	}
+
+	int handled = 0;
+	for (int i = 0; i < count; i++) {
+		if (events[i].data.ptr == NULL) {
+			uint64_t value;
+			while (read(wakeFd, &value, sizeof(value)) > 0) {
+			}
+			continue;
+		}
+		static_cast<EventHandler *>(events[i].data.ptr)->onEvent(
+				events[i].events);
+		handled++;
+	}
+	return handled;
+}
+
+/**
+ * Interrupts waiting of runOnce(), can be called by any thread.
+ */
+void EventLoop::wakeUp() {
+	uint64_t one = 1;
+	if (write(wakeFd, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+		perror("Failed to wake up event loop - write()");
+	}
+}
@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       EventLoop.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines loop dispatching readiness events
+//             of the descriptors.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file EventLoop.h
+ *
+ * @brief Header file which defines loop dispatching readiness events of
+ *        the descriptors.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef EVENTLOOP_H_INCLUDED
+#define EVENTLOOP_H_INCLUDED
+
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ * Object which is notified about the events of its descriptor.
+ */
+class EventHandler {
+public:
+	virtual ~EventHandler() {
+	}
+
+	/**
+	 * Called by the thread running the loop.
+	 * @param events Mask of the epoll events.
+	 */
+	virtual void onEvent(uint32_t events) = 0;
+};
+
+/**
+ * Loop above epoll. Descriptors are registered with their handlers, which
+ * are called by the thread running runOnce(). Handler registered as one-shot
+ * is disabled after its event until it is rearmed, so the event can be
+ * served by another thread. Registration can be changed by any thread.
+ */
+class EventLoop {
+public:
+	EventLoop();
+	~EventLoop();
+	bool isOpened() const;
+
+	bool add(int fd, EventHandler *handler, bool oneShot = false);
+	bool rearm(int fd, EventHandler *handler);
+	void remove(int fd);
+	int runOnce(int timeout);
+	void wakeUp();
+private:
+	static const int MAX_EVENTS = 64;
+
+	int epollFd;
+	int wakeFd; /**< eventfd which interrupts waiting of runOnce() */
+
+	EventLoop(const EventLoop &);
+	EventLoop &operator=(const EventLoop &);
+};
+
+#endif // EVENTLOOP_H_INCLUDED
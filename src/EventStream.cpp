@@ -0,0 +1,175 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       EventStream.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements stream of JSON lines events
+//             about the finished commands.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file EventStream.cpp
+ *
+ * @brief Source file which implements stream of JSON lines events about
+ *        the finished commands.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdio>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "EventStream.h"
+
+using namespace std;
+
+int EventStream::fd = -1;
+
+/**
+ * Starts writing events into the file descriptor.
+ * Standard descriptor is duplicated above 2 first, children keep it
+ * as their stdio.
+ * @param fd Opened file descriptor, it is not inherited by children.
+ * @return True on success, false if descriptor is not opened.
+ */
+bool EventStream::open(int fd) {
+	if (fd <= STDERR_FILENO) {
+		if ((fd = fcntl(fd, F_DUPFD_CLOEXEC, STDERR_FILENO + 1)) == -1) {
+			perror("Invalid event file descriptor - fcntl()");
+			return false;
+		}
+	} else if (fcntl(fd, F_SETFD, FD_CLOEXEC) == -1) {
+		perror("Invalid event file descriptor - fcntl()");
+		return false;
+	}
+	EventStream::fd = fd;
+	return true;
+}
+
+/**
+ * Tests whether events are written.
+ */
+bool EventStream::isEnabled() {
+	return fd >= 0;
+}
+
+/**
+ * Converts text into JSON string including quotes.
+ */
+string EventStream::quote(const string &text) {
+	string out = "\"";
+	char escaped[8];
+
+	for (size_t i = 0; i < text.size(); i++) {
+		unsigned char c = text[i];
+		switch (c) {
+		case '"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		case '\t':
+			out += "\\t";
+			break;
+		default:
+			if (c < 0x20) {
+				snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				out += escaped;
+			} else {
+				out += c;
+			}
+		}
+	}
+
+	return out + "\"";
+}
+
+/**
+ * Formats arguments and redirections of the command, fields are stored
+ * with the job until it finishes.
+ * @param argv Arguments of the command.
+ * @param redirects Redirections, operator followed by the file name.
+ * @return Fields of the command event.
+ */
+string EventStream::commandFields(const vector<string> &argv,
+		const vector<string> &redirects) {
+	string out = "\"argv\":[";
+	for (size_t i = 0; i < argv.size(); i++) {
+		out += (i > 0) ? "," : "";
+		out += quote(argv[i]);
+	}
+
+	out += "],\"redirects\":[";
+	for (size_t i = 0; i < redirects.size(); i++) {
+		out += (i > 0) ? "," : "";
+		out += "{\"op\":" + quote(redirects[i].substr(0, 1)) + ",\"file\":"
+				+ quote(redirects[i].substr(1)) + "}";
+	}
+
+	return out + "]";
+}
+
+/**
+ * Writes event about the finished child.
+ */
+void EventStream::command(const Job &job) {
+	if (fd < 0) {
+		return;
+	}
+
+	char times[160];
+	snprintf(times, sizeof(times),
+			",\"pid\":%d,\"background\":%s,\"start\":%ld.%09ld,"
+					"\"end\":%ld.%09ld,\"status\":%d}\n", (int) job.pid,
+			job.background ? "true" : "false", (long) job.start.tv_sec,
+			job.start.tv_nsec, (long) job.end.tv_sec, job.end.tv_nsec,
+			JobTable::exitStatus(job));
+
+	char seq[64];
+	snprintf(seq, sizeof(seq), "{\"event\":\"command\",\"seq\":%lu,",
+			job.seq);
+
+	emit(seq + job.eventFields + times);
+}
+
+/**
+ * Writes event about the processed line.
+ * @param seq Number of the line.
+ * @param status Exit status of the last command of the line.
+ */
+void EventStream::done(unsigned long seq, int status) {
+	if (fd < 0) {
+		return;
+	}
+
+	char line[96];
+	snprintf(line, sizeof(line), "{\"event\":\"done\",\"seq\":%lu,\"status\":%d}\n",
+			seq, status);
+	emit(line);
+}
+
+/**
+ * Writes whole line at once, so events are not interleaved.
+ */
+void EventStream::emit(const string &line) {
+	size_t written = 0;
+	while (written < line.size()) {
+		ssize_t ret = write(fd, line.data() + written, line.size() - written);
+		if (ret < 0 && errno == EINTR) {
+			continue;
+		} else if (ret < 0) {
+			perror("Failed to write event - write()");
+			return;
+		}
+		written += ret;
+	}
+}
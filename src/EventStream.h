@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       EventStream.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines stream of JSON lines events about
+//             the finished commands.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file EventStream.h
+ *
+ * @brief Header file which defines stream of JSON lines events about
+ *        the finished commands.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef EVENTSTREAM_H_INCLUDED
+#define EVENTSTREAM_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "JobTable.h"
+
+using namespace std;
+
+/**
+ * Machine readable events for the program which drives the shell.
+ * Every event is one JSON object on one line written into the event fd:
+ *  - {"event":"command","seq":N,"argv":[...],"redirects":[...],"pid":P,
+ *     "background":B,"start":S,"end":E,"status":X} for every finished child,
+ *  - {"event":"done","seq":N,"status":X} when the line N has been processed.
+ * Lines are numbered from 1, start and end are seconds of CLOCK_MONOTONIC.
+ */
+class EventStream {
+public:
+	static bool open(int fd);
+	static bool isEnabled();
+
+	static string quote(const string &text);
+	static string commandFields(const vector<string> &argv,
+			const vector<string> &redirects);
+
+	static void command(const Job &job);
+	static void done(unsigned long seq, int status);
+private:
+	static int fd;
+
+	static void emit(const string &line);
+};
+
+#endif // EVENTSTREAM_H_INCLUDED
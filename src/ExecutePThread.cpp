@@ -19,98 +19,66 @@
  */
 
 #include <iostream>
-#include <algorithm>
-#include <sstream>
 
 #include <cstdio>
 
 #include <signal.h>
 #include <unistd.h>
-#include <errno.h>
 #include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
 #include <sys/wait.h>
-#include <wordexp.h>
+#include <sys/resource.h>
 
-#include "RegExp.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "EventStream.h"
+#include "SessionRecorder.h"
 #include "ExecutePThread.h"
 
 using namespace std;
-using namespace regexp;
 
-/**
- * Parses whole command line.
- */
-string ExecutePThread::REGEX_CMDLINE_TEST =
-		"^[[:space:]]*([^&><\t\r\n ]+)(([[:space:]]+([^&><\t\r\n ]+))*)(([[:space:]]+([><])[[:space:]]*([^&><\t\r\n ]+))*)[[:space:]]*([[:space:]]+(&))?[[:space:]]*$";
-
-/**
- * Parses argument segment only.
- */
-string ExecutePThread::REGEX_ARG_PARSE = "^(([[:space:]]+([^&><\t\r\n ]+))+)$";
+JobTable ExecutePThread::jobTable; /**< Children started by the shell */
 
 /**
- * Parses redirect segment only.
+ * Wakes up execute thread waiting for the line when its stop is requested.
  */
-string ExecutePThread::REGEX_REDIRECT_PARSE =
-		"^(([[:space:]]+([><])[[:space:]]*([^&><\t\r\n ]+))+)$";
-
-/**
- * Matches white spaces.
- */
-string ExecutePThread::REGEX_SPACES = "^[[:space:]]+$";
+void ExecutePThread::wakeUp() {
+	bufferMonitor.enter();
+	bufferFilled.broadcast();
+	bufferMonitor.exit();
+}
 
 /**
- * Matches exit command.
+ * Terminates the running command and prevents the next ones, so the stop
+ * of the thread does not wait for them. Without it the line which has been
+ * picked up finishes first.
  */
-string ExecutePThread::REGEX_EXIT = "^[[:space:]]*exit[[:space:]]*$";
-
-int ExecutePThread::stdin_dup = -1; /**< clonned FD of the STDIN */
-int ExecutePThread::stdout_dup = -1; /**< clonned FD of the STDOUT */
-int ExecutePThread::stderr_dup = -1; /**< clonned FD of the STDERR */
-int ExecutePThread::devnull_fd = -1; /**< clonned FD of the /dev/null */
-bool ExecutePThread::child_exited = false; /**< Determines whether child currently exited */
+void ExecutePThread::interrupt() {
+	uint64_t one = 1;
+	if (stopFd != -1 && write(stopFd, &one, sizeof(one)) == -1) {
+		perror("Failed to interrupt execute thread - write()");
+	}
+}
 
 /**
- * Cancels execute thread.
+ * Returns descriptor which becomes readable when the thread is interrupted,
+ * waits for the children poll it.
  */
-void ExecutePThread::cancel() {
-	bufferMonitor.signal();
-	PThread::cancel();
+int ExecutePThread::getStopFd() {
+	return stopFd;
 }
 
 /**
- * Starts new process and calls its handler function.
- * 
- * @param label Name of the process.
- * @param processHandler Handler function of the process 
- * @return Return code from the process. 
+ * Wakes up execute thread waiting for the line, so it starts the runs
+ * of the periodic commands.
  */
-int ExecutePThread::startProcess(int(*processHandler)(void *arg), void *arg) {
-	errno = 0;
-	int pid = fork();
-	int retError = errno;
-
-	if (pid == 0) { // Created - child process
-		exit((*processHandler)(arg)); // Call handler function of th eprocess
-	} else if (pid == -1) { // An error
-		perror("Failed to create a new process - fork()");
-		return (retError != 0) ? -errno : -EXIT_FAILURE;
-	}
-
-	return pid;
+void ExecutePThread::periodicDue() {
+	wakeUp();
 }
 
 /**
  * Callback function which is called when this thread is going to start.
  */
 void ExecutePThread::onStart() {
-	stdin_dup = dup(STDIN_FILENO);
-	stdout_dup = dup(STDOUT_FILENO);
-	//stderr_dup = dup(STDERR_FILENO);
-	devnull_fd = open("/dev/null", O_RDWR);
-
 	struct sigaction sa;
 	sa.sa_handler = child_exited_handler;
 	sa.sa_flags = 0;
@@ -125,308 +93,20 @@ void ExecutePThread::onStart() {
  * Callback function which is called when this thread is going to finish.
  */
 void ExecutePThread::onFinish() {
-	close(stdin_dup);
-	close(stdout_dup);
-	close(stderr_dup);
-	close(devnull_fd);
+	setTimingLog("");
 }
 
 /**
  * Serves SIGCHLG signals.
+ * Signal is blocked in all threads but the execute thread waiting for
+ * the line, so the job table is not in use meanwhile. Only children of the
+ * table are reaped, others are left to their waiters. Exit status and
+ * resource usage are recorded into the job table.
  * @param signo Number of signal which entranced into this handler.
  */
 void ExecutePThread::child_exited_handler(int signo) {
 	signo = signo;
-	pid_t pid;
-	int status;
-	while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
-		child_exited = true;
-	}
-}
-
-/**
- * Parses redirect records into information structure from the array of matches.
- * @param cmdInfo Information about parsed line - will be filled.
- * @param matches Array of matches.
- */
-void ExecutePThread::parseRedirects(CommandInfo &cmdInfo,
-		const vector<string> &matches) {
-	RegExp cmdExpr(REGEX_REDIRECT_PARSE, REG_EXTENDED);
-	vector < string > redirectsMatches;
-	string redirs = matches[5];
-
-	while (!(redirectsMatches = cmdExpr.exec(redirs)).empty()) {
-		RedirectInfo redirInfo;
-		redirInfo.fileName = redirectsMatches[4];
-		redirInfo.isOut = !redirectsMatches[3].compare(">");
-		cmdInfo.redirects.push_back(redirInfo);
-		redirs.erase(redirs.size() - redirectsMatches[2].size(),
-				redirectsMatches[2].size());
-	}
-
-	reverse(cmdInfo.redirects.begin(), cmdInfo.redirects.end());
-}
-
-/**
- * Parses arguments into information structure from the array of matches.
- * @param cmdInfo Information about parsed line - will be filled.
- * @param matches Array of matches.
- */
-void ExecutePThread::parseArguments(CommandInfo &cmdInfo,
-		const vector<string> &matches) {
-	RegExp cmdExpr(REGEX_ARG_PARSE, REG_EXTENDED);
-	vector < string > argsMatches;
-	string args = matches[2];
-
-	while (!(argsMatches = cmdExpr.exec(args)).empty()) {
-		cmdInfo.arguments.push_back(argsMatches[3]);
-		args.erase(args.size() - argsMatches[2].size(), argsMatches[2].size());
-	}
-
-	reverse(cmdInfo.arguments.begin(), cmdInfo.arguments.end());
-}
-
-/**
- * Parses program name, argumetns & files where to redirect stdin & stdout if are specified.
- * @param cmdInfo Information about parsed line - will be filled.
- * @param matches Array of matches.
- */
-void ExecutePThread::processCommand(CommandInfo &cmdInfo,
-		const vector<string> &matches) {
-	// Program name
-	cmdInfo.programName = matches[1];
-	cmdInfo.programNameArgs = cmdInfo.programName;
-
-	// Getting arguments 
-	if (!matches[2].empty()) {
-		parseArguments(cmdInfo, matches);
-		cmdInfo.programNameArgs += matches[2];
-	}
-
-	// Getting redirects 
-	if (!matches[5].empty()) {
-		parseRedirects(cmdInfo, matches);
-	}
-
-	// Run command on background
-	cmdInfo.runOnBackground = !matches[10].empty();
-}
-
-/**
- * Executes comand which is retrieved from the cmdInfo.
- * 
- * @param cmdInfo Information about parsed line.
- * @return True on success, false on failure.
- */
-bool ExecutePThread::executeCommand(CommandInfo &cmdInfo) {
-	child_exited = false;
-	int cmdPID = startProcess(executionHandler, &cmdInfo);
-
-	/* Close stdin/stdout because it is not demanded to 
-	 * recieve data from the child process */
-
-	close(STDIN_FILENO);
-	close(STDOUT_FILENO);
-	//close(STDERR_FILENO);
-
-	if (cmdPID > 0) {
-		if (!cmdInfo.runOnBackground) {
-			sigset_t newmask, oldmask;
-			sigemptyset(&newmask);
-			sigaddset(&newmask, SIGCHLD);
-
-			pthread_sigmask(SIG_BLOCK, &newmask, &oldmask);
-
-			/* Wait until child has exited. */
-			while (!child_exited) {
-				sigsuspend(&oldmask);
-			}
-
-			pthread_sigmask(SIG_UNBLOCK, &newmask, NULL);
-		} else {
-
-		}
-	}
-
-	/* Restore std file descriptors */
-
-	dup2(stdin_dup, STDIN_FILENO);
-	dup2(stdout_dup, STDOUT_FILENO);
-	//dup2(stderr_dup, STDERR_FILENO);
-
-	return true;
-
-}
-
-/**
- * Redirects stdin and stdout.
- * @param cmdInfo Information about parsed line.
- * @param outRedirected Is set whether some stdout redirection was proceeded.
- * @param inRedirected Is set whether some stdin redirection was proceeded.
- * @return Code which signals sucess or failure. 0 is returned on success.
- */
-int ExecutePThread::redirectStdInOut(CommandInfo &cmdInfo, bool &outRedirected,
-		bool &inRedirected) {
-	int retError = 0;
-	errno = 0;
-
-	outRedirected = false;
-	inRedirected = false;
-
-	int ret = EXIT_SUCCESS;
-	for (vector<RedirectInfo>::iterator it = cmdInfo.redirects.begin();
-			it != cmdInfo.redirects.end(); it++) {
-		RedirectInfo &info = *it;
-
-		int redir_file, file_no;
-
-		if (info.isOut) {
-			outRedirected = true;
-			file_no = STDOUT_FILENO;
-			if ((redir_file = open(&info.fileName[0], O_CREAT | O_WRONLY,
-					S_IRUSR | S_IRGRP | S_IROTH)) < 0) {
-				retError = errno;
-				perror(
-						"Failed to open/create file to which should be stdout redirected - open()");
-				ret = (retError != 0) ? errno : EXIT_FAILURE;
-				break;
-			}
-		} else {
-			inRedirected = true;
-			file_no = STDIN_FILENO;
-			if ((redir_file = open(&info.fileName[0], O_RDONLY)) < 0) {
-				retError = errno;
-				perror(
-						"Failed to open file from which should be stdin taken - open()");
-				ret = (retError != 0) ? errno : EXIT_FAILURE;
-				break;
-			}
-		}
-
-		cout << flush;
-
-		if (dup2(redir_file, file_no) < 0) {
-			retError = errno;
-			perror(
-					"Failed to establish redirecting of stdin or stdout - dup2()");
-			close(redir_file);
-			ret = (retError != 0) ? errno : EXIT_FAILURE;
-			break;
-		}
-		close(redir_file);
-
-	}
-
-	return ret;
-}
-
-/**
- * Redirects passed file descriptor to /dev/null.
- * @param fd File descriptor which should be redirected do /dev/null.
- * @return 0 on success, othewise error code
- */
-int ExecutePThread::detachFD(int fd) {
-	int retError = 0;
-	errno = 0;
-
-	if (dup2(devnull_fd, fd) < 0) {
-		retError = errno;
-		stringstream ss;
-		ss << "Failed to detach file descriptor " << fd
-				<< " for background process to /dev/null  - dup2()";
-		string msg = ss.str();
-		perror(msg.c_str());
-		return (retError != 0) ? errno : EXIT_FAILURE;
-	}
-
-	return EXIT_SUCCESS;
-}
-
-/**
- * Handle function for new forked process.
- * Executes parsed command from command line.
- * @param arg Informations about parsed line.
- * @return Exit code of the new process.
- */
-int ExecutePThread::executionHandler(void *arg) {
-	CommandInfo &cmdInfo = *static_cast<CommandInfo *>(arg);
-
-	int retError = 0;
-	errno = 0;
-
-	bool outRedirected, inRedirected;
-
-	/* Set up redirections */
-
-	if ((retError = redirectStdInOut(cmdInfo, outRedirected, inRedirected))
-			!= EXIT_SUCCESS) {
-		return retError;
-	}
-
-	/* If running of command on background is demanded then redirect stdin/stdout/stderr to /dev/null
-	 * Shell does not recieves any feedback from the process on the background 
-	 */
-	if (cmdInfo.runOnBackground) {
-
-		if (!inRedirected
-				&& ((retError = detachFD(STDIN_FILENO)) != EXIT_SUCCESS)) {
-			return retError;
-		}
-
-		/*if ((retError = detachFD(STDERR_FILENO)) != EXIT_SUCCESS) {
-		 return retError; 
-		 }*/
-
-		if (!outRedirected
-				&& ((retError = detachFD(STDOUT_FILENO)) != EXIT_SUCCESS)) {
-			return retError;
-		}
-	}
-
-	/* Setup behaviour on SIGINT command */
-
-	struct sigaction sa;
-	sa.sa_flags = (cmdInfo.runOnBackground) ? 0 : SA_RESTART | SA_SIGINFO;
-	sa.sa_handler = (cmdInfo.runOnBackground) ? SIG_IGN : SIG_DFL;
-
-	sigemptyset(&sa.sa_mask);
-	sigaddset(&sa.sa_mask, SIGINT);
-
-	if (sigaction(SIGINT, &sa, NULL) == -1) {
-		retError = errno;
-		perror("Failed - sigaction(SIGINT)");
-		return (retError != 0) ? errno : EXIT_FAILURE;
-	}
-
-	/*vector<char *> argv(cmdInfo.arguments.size() + 2);
-
-	 argv[0] = &cmdInfo.programName[0];
-	 int i = 1;
-	 for (vector<string>::iterator it = cmdInfo.arguments.begin(); it != cmdInfo.arguments.end(); it++) {
-	 argv[i++] = &(*it)[0];
-	 }
-	 argv[argv.size() - 1] = NULL;          */
-
-	/* Executes command with the argumetns parsed by wordexp */
-
-	wordexp_t res;
-	if (wordexp(cmdInfo.programNameArgs.c_str(), &res, 0) != 0) {
-		return EXIT_FAILURE;
-	}
-	execvp(res.we_wordv[0], res.we_wordv);
-
-	/*execvp(&cmdInfo.programName[0], &argv[0]);*/
-	retError = errno;
-
-	/*if (dup2(stderr_dup, STDERR_FILENO) < 0) {
-	 retError = errno;
-	 perror("Failed execv() and to restore stderr for background process - dup2()");
-	 return (retError != 0)? errno : EXIT_FAILURE;  
-	 }*/
-
-	perror("Failed - execv()");
-	return (retError != 0) ? errno : EXIT_FAILURE;
-
+	jobTable.reapChildren();
 }
 
 /**
@@ -436,50 +116,81 @@ int ExecutePThread::executionHandler(void *arg) {
 int ExecutePThread::run() {
 
 	while (1) {
-		cout << "$ " << flush;
+		reportFinishedJobs();
+		if (!EventStream::isEnabled()) { // Prompt is not printed for machines
+			cout << (interpreter.needsMoreInput() ? "> " : "$ ") << flush;
+		}
 
-		cancelPoint();
+		TRACE_BEGIN(PICKUP);
 		bufferMonitor.enter();
 
-		/* Reading command from stdin */
-		while (buffer[0] == '\0') {
-			cancelPoint();
-			bufferMonitor.wait();
+		/* Reading command from stdin, periodic commands run meanwhile */
+		while (buffer[0] == '\0' && !isStopRequested()) {
+			if (PeriodicPThread::hasWork(this)) {
+				bufferMonitor.exit();
+				runPeriodic(this);
+				bufferMonitor.enter();
+				continue;
+			}
+
+			/* Background children are reaped as they exit, not with the next
+			 * line, the pending signal is served right away */
+			sigset_t oldmask;
+			PThread::unblockChildSignal(&oldmask);
+			bufferFilled.wait();
+			pthread_sigmask(SIG_SETMASK, &oldmask, NULL);
+		}
+		if (isStopRequested()) {
+			bufferMonitor.exit();
+			TRACE_END(PICKUP);
+			break;
 		}
 
 		string command(&buffer[0]);
 		buffer[0] = '\0';
-		bufferMonitor.signal();
+		Metrics::linePicked();
+		bufferEmptied.signal();
 		bufferMonitor.exit();
-
-		/* Checking command syntax */
-		RegExp spacesExpr(REGEX_SPACES, REG_EXTENDED);
-		RegExp exitExpr(REGEX_EXIT, REG_EXTENDED);
-
-		if (spacesExpr.test(command)) {
-			continue;
-		} else if (exitExpr.test(command)) {
-			break;
+		TRACE_END(PICKUP);
+		uint64_t takenAt =
+				SessionRecorder::isEnabled() ? SessionRecorder::now() : 0;
+
+		/* History reference is replaced by the entry, which is echoed */
+		if (history != NULL) {
+			string line = command.substr(0,
+					command.find_last_not_of("\r\n") + 1);
+			string expanded, error;
+			if (history->expand(line, expanded, error)) {
+				command = expanded + command.substr(line.size());
+				line = expanded;
+				cout << line << endl;
+			} else if (!error.empty()) {
+				cerr << error << endl;
+				continue;
+			}
+			history->add(line);
 		}
 
-		RegExp cmdExpr(REGEX_CMDLINE_TEST, REG_EXTENDED);
-		vector < string > matches;
+		/* Compiling and running command */
+		lineSeq++;
+		TRACE_BEGIN(RUN_LINE);
+		interpreter.feed(command);
+		TRACE_END(RUN_LINE);
 
-		matches = cmdExpr.exec(command);
-		if (matches.empty()) {
-			cerr << "Typed invalid command!" << endl;
-			continue;
+		if (SessionRecorder::isEnabled()) {
+			SessionRecorder::record(takenAt,
+					command.substr(0, command.find_last_not_of("\r\n") + 1),
+					!interpreter.needsMoreInput());
 		}
 
-		/* Getting command - parsing it */
-
-		CommandInfo cmdInfo;
-		processCommand(cmdInfo, matches);
+		if (!interpreter.needsMoreInput()) {
+			EventStream::done(lineSeq, interpreter.getStatus());
+		}
 
-		/* Executing command */
-		executeCommand(cmdInfo);
+		if (interpreter.exitRequested()) {
+			break;
+		}
 	}
 
-	return 0;
+	return interpreter.getStatus();
 }
-
@@ -21,74 +21,56 @@
 #define EXECUTEPTHREAD_H_INCLUDED
 
 #include <vector>
-#include <string>
+
+#include <unistd.h>
+#include <sys/eventfd.h>
 
 #include "PThread.h"
+#include "CommandExecutor.h"
+#include "PeriodicPThread.h"
+#include "JobTable.h"
 
 using namespace std;
 
 /**
  * Thread class which executes commands fromt he buffer shared with read thread.
+ * Lines are run by the executor of the shell session on the terminal,
+ * runs of the periodic commands are started while it waits for the line.
  */
-class ExecutePThread: public PThread {
+class ExecutePThread: public PThread,
+		public CommandExecutor,
+		public PeriodicOwner {
 public:
-	ExecutePThread(vector<char> &buffer, PThreadMonitor &bufferMonitor) :
-			buffer(buffer), bufferMonitor(bufferMonitor) {
+	ExecutePThread(vector<char> &buffer, PThreadMonitor &bufferMonitor,
+			PThreadCondition &bufferFilled, PThreadCondition &bufferEmptied) :
+			CommandExecutor(jobTable), buffer(buffer), bufferMonitor(
+					bufferMonitor), bufferFilled(bufferFilled), bufferEmptied(
+					bufferEmptied), stopFd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
+		setStackSize(STACK_SIZE);
 	}
 	virtual ~ExecutePThread() {
+		cancel();
+		if (stopFd != -1) {
+			close(stopFd);
+		}
 	}
 	virtual int run();
-	virtual void cancel();
+	virtual void periodicDue();
+	void interrupt();
 private:
-
-	/**
-	 * Keeps informations about redirect files.
-	 */
-	typedef struct {
-		bool isOut;
-		string fileName;
-	} RedirectInfo;
-
-	/**
-	 * Structure which hold informations about parsed command line.
-	 */
-	typedef struct {
-		string programName;
-		string programNameArgs;
-		vector<string> arguments;
-		vector<RedirectInfo> redirects;
-		bool runOnBackground;
-	} CommandInfo;
-
-	static string REGEX_CMDLINE_TEST;
-	static string REGEX_ARG_PARSE;
-	static string REGEX_REDIRECT_PARSE;
-	static string REGEX_SPACES;
-	static string REGEX_EXIT;
-
 	vector<char> &buffer;
 	PThreadMonitor &bufferMonitor;
+	PThreadCondition &bufferFilled; /**< waited for until line is passed */
+	PThreadCondition &bufferEmptied; /**< signalled when line is taken */
+	int stopFd; /**< readable when the thread is interrupted */
 
-	static bool child_exited;
-	static int stdin_dup;
-	static int stdout_dup;
-	static int stderr_dup;
-	static int devnull_fd;
-
-	void parseRedirects(CommandInfo &cmdInfo, const vector<string> &matches);
-	void parseArguments(CommandInfo &cmdInfo, const vector<string> &matches);
-	void processCommand(CommandInfo &cmdInfo, const vector<string> &matches);
-
-	bool executeCommand(CommandInfo &cmdInfo);
-	int startProcess(int(*processHandler)(void *arg), void *arg);
+	static JobTable jobTable;
 
 	void onStart();
 	void onFinish();
+	void wakeUp();
+	int getStopFd();
 
-	static int executionHandler(void *arg);
-	static int redirectStdInOut(CommandInfo &cmdInfo, bool &outRedirected,
-			bool &inRedirected);
-	static int detachFD(int fd);
 	static void child_exited_handler(int signo);
 };
 
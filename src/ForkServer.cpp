@@ -0,0 +1,507 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       ForkServer.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements helper process forking children
+//             on behalf of the shell.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ForkServer.cpp
+ *
+ * @brief Source file which implements helper process forking children on
+ *        behalf of the shell.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <wordexp.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "ForkServer.h"
+
+using namespace std;
+
+static const int EXIT_NOT_EXECUTABLE = 126;
+static const int EXIT_NOT_FOUND = 127;
+
+ForkServer *ForkServer::instance = NULL;
+
+/**
+ * Thread which receives messages of the helper.
+ */
+class ForkServer::Receiver: public PThread {
+public:
+	Receiver(ForkServer &server) :
+			server(server) {
+	}
+	virtual ~Receiver() {
+		cancel();
+	}
+	virtual int run() {
+		server.receive();
+		return 0;
+	}
+private:
+	ForkServer &server;
+};
+
+/**
+ * Constructor.
+ * @param sock Socket connected to the helper.
+ * @param helper PID of the helper.
+ */
+ForkServer::ForkServer(int sock, pid_t helper) :
+		sock(sock), helper(helper), receiver(NULL), monitor("forkserver"), changed(
+				monitor, "changed"), closed(false), nextId(0) {
+}
+
+/**
+ * Destructor, helper has to be finished.
+ */
+ForkServer::~ForkServer() {
+	delete receiver;
+	close(sock);
+}
+
+/**
+ * Forks the helper. It should be called before the shell starts its threads
+ * and allocates its state, the helper keeps the memory of that moment.
+ * @return True on success, false on failure.
+ */
+bool ForkServer::start() {
+	if (instance != NULL) {
+		return true;
+	}
+
+	int pair[2];
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, pair) == -1) {
+		perror("Failed to create fork server socket - socketpair()");
+		return false;
+	}
+
+	pid_t pid = fork();
+	if (pid == -1) {
+		perror("Failed to create fork server - fork()");
+		close(pair[0]);
+		close(pair[1]);
+		return false;
+	} else if (pid == 0) {
+		close(pair[0]);
+		helperMain(pair[1]);
+	}
+
+	close(pair[1]);
+	instance = new ForkServer(pair[0], pid);
+	instance->receiver = new Receiver(*instance);
+	instance->receiver->start();
+	return true;
+}
+
+/**
+ * Stops the helper, children which are still running are not affected.
+ * Must not be called while other threads spawn or wait for children.
+ */
+void ForkServer::stop() {
+	ForkServer *server = instance;
+	if (server == NULL) {
+		return;
+	}
+	instance = NULL;
+
+	shutdown(server->sock, SHUT_WR); // Helper exits on end of requests
+	server->receiver->join();
+	waitpid(server->helper, NULL, 0);
+	delete server;
+}
+
+/**
+ * Returns whether children are spawned by the helper.
+ */
+bool ForkServer::isRunning() {
+	ForkServer *server = instance;
+	return server != NULL && !__atomic_load_n(&server->closed, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Sends the request to the helper and waits for its reply.
+ * @param request Child which should be started.
+ * @return PID of the child or negative errno on failure.
+ */
+pid_t ForkServer::spawn(const SpawnRequest &request) {
+	ForkServer *server = instance;
+
+	/* Header is filled when the request gets its ID */
+	vector<char> data(sizeof(RequestHeader));
+	data.insert(data.end(), request.cwd.begin(), request.cwd.end());
+	data.push_back('\0');
+	data.insert(data.end(), request.program.begin(), request.program.end());
+	data.push_back('\0');
+	for (size_t i = 0; i < request.argv.size(); i++) {
+		data.insert(data.end(), request.argv[i].begin(), request.argv[i].end());
+		data.push_back('\0');
+	}
+	uint32_t envc = 0;
+	for (char **env = environ; *env != NULL; env++, envc++) {
+		data.insert(data.end(), *env, *env + strlen(*env) + 1);
+	}
+	if (data.size() > MAX_REQUEST) {
+		return -E2BIG;
+	}
+
+	server->monitor.enter();
+	uint32_t id = ++server->nextId;
+	server->monitor.exit();
+
+	RequestHeader header;
+	header.id = id;
+	header.argc = request.argv.size();
+	header.envc = envc;
+	header.expand = request.expand;
+	header.background = request.background;
+	header.newGroup = request.newGroup;
+	header.sched = request.sched;
+	header.limits = request.limits;
+	memcpy(&data[0], &header, sizeof(header));
+
+	/* Descriptors of the child are attached to the request */
+	struct iovec iov;
+	iov.iov_base = &data[0];
+	iov.iov_len = data.size();
+
+	char control[CMSG_SPACE(sizeof(request.fds))];
+	memset(control, 0, sizeof(control));
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(request.fds));
+	memcpy(CMSG_DATA(cmsg), request.fds, sizeof(request.fds));
+
+	ssize_t sent;
+	while ((sent = sendmsg(server->sock, &msg, MSG_NOSIGNAL)) == -1
+			&& errno == EINTR) {
+	}
+	if (sent == -1) {
+		return -errno;
+	}
+
+	server->monitor.enter();
+	map<uint32_t, pair<pid_t, int> >::iterator it;
+	while ((it = server->spawned.find(id)) == server->spawned.end()
+			&& !server->closed) {
+		server->changed.wait();
+	}
+	pid_t pid = -EPIPE;
+	if (it != server->spawned.end()) {
+		pid = (it->second.first > 0) ? it->second.first : -it->second.second;
+		server->spawned.erase(it);
+	}
+	server->monitor.exit();
+
+	return pid;
+}
+
+/**
+ * Waits for the child like wait4(), but children of the helper are waited
+ * for by their forwarded exit statuses.
+ * @param pid PID of the child.
+ * @param status Exit status of the child is stored here, can be NULL.
+ * @param usage Resource usage of the child is stored here, can be NULL.
+ * @param options 0 or WNOHANG.
+ * @param end Monotonic time of the exit is stored here, can be NULL.
+ * @return PID of the child, 0 if it has not exited yet, -1 on failure.
+ */
+pid_t ForkServer::wait(pid_t pid, int *status, struct rusage *usage,
+		int options, struct timespec *end) {
+	ForkServer *server = instance;
+	if (server != NULL) {
+		server->monitor.enter();
+		map<pid_t, Exit>::iterator it;
+		while ((it = server->exits.find(pid)) == server->exits.end()
+				&& !server->closed && !(options & WNOHANG)) {
+			server->changed.wait();
+		}
+		bool found = it != server->exits.end();
+		bool closed = server->closed;
+		if (found) {
+			if (status != NULL) {
+				*status = it->second.status;
+			}
+			if (usage != NULL) {
+				*usage = it->second.usage;
+			}
+			if (end != NULL) {
+				*end = it->second.end;
+			}
+			server->exits.erase(it);
+		}
+		server->monitor.exit();
+
+		if (found) {
+			return pid;
+		} else if (!closed) {
+			return 0;
+		}
+		/* Helper has gone, child has been started by the shell itself */
+	}
+
+	pid_t result;
+	while ((result = wait4(pid, status, options, usage)) == -1 && errno == EINTR) {
+	}
+	if (result > 0 && end != NULL) {
+		clock_gettime(CLOCK_MONOTONIC, end);
+	}
+	return result;
+}
+
+/**
+ * Receives replies and exits of the children until the helper exits.
+ */
+void ForkServer::receive() {
+	Reply reply;
+	while (1) {
+		ssize_t count = recv(sock, &reply, sizeof(reply), 0);
+		if (count == -1 && errno == EINTR) {
+			continue;
+		} else if (count != sizeof(reply)) {
+			break;
+		}
+
+		monitor.enter();
+		if (reply.type == SPAWNED) {
+			spawned[reply.id] = make_pair(reply.pid, reply.error);
+		} else {
+			Exit &exit = exits[reply.pid];
+			exit.status = reply.status;
+			exit.usage = reply.usage;
+			exit.end = reply.end;
+		}
+		changed.broadcast();
+		monitor.exit();
+	}
+
+	monitor.enter();
+	__atomic_store_n(&closed, true, __ATOMIC_RELEASE);
+	changed.broadcast();
+	monitor.exit();
+}
+
+/**
+ * Main function of the helper process, it never returns. Requests and
+ * SIGCHLD are served by one loop, so reply always precedes exit.
+ * @param sock Socket connected to the shell.
+ */
+void ForkServer::helperMain(int sock) {
+	/* Descriptors inherited by the shell (e.g. its event stream) would leak
+	 * into every child and keep the pipes of the shell open */
+	if (sock > 3) {
+		close_range(3, sock - 1, 0);
+	}
+	close_range(sock + 1, ~0U, 0);
+
+	struct sigaction sa;
+	sa.sa_handler = SIG_DFL;
+	sa.sa_flags = 0;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGTERM, &sa, NULL);
+	sigaction(SIGQUIT, &sa, NULL);
+
+	sigset_t mask;
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	sigprocmask(SIG_BLOCK, &mask, NULL);
+	int sigFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+	if (sigFd == -1) {
+		perror("Failed to watch children of fork server - signalfd()");
+		_exit(EXIT_FAILURE);
+	}
+
+	vector<char> data(MAX_REQUEST);
+	struct pollfd pfds[2];
+	pfds[0].fd = sock;
+	pfds[0].events = POLLIN;
+	pfds[1].fd = sigFd;
+	pfds[1].events = POLLIN;
+
+	while (1) {
+		if (poll(pfds, 2, -1) == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			_exit(EXIT_FAILURE);
+		}
+
+		if (pfds[1].revents != 0) {
+			struct signalfd_siginfo info;
+			while (read(sigFd, &info, sizeof(info)) > 0) {
+			}
+			helperReap(sock);
+		}
+
+		if (pfds[0].revents == 0) {
+			continue;
+		}
+
+		int fds[3];
+		char control[CMSG_SPACE(sizeof(fds))];
+		struct iovec iov;
+		iov.iov_base = &data[0];
+		iov.iov_len = data.size();
+		struct msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+
+		ssize_t count = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+		if (count == -1 && errno == EINTR) {
+			continue;
+		} else if (count <= 0) { // Shell has finished
+			_exit(EXIT_SUCCESS);
+		}
+
+		struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+		if (cmsg == NULL || cmsg->cmsg_type != SCM_RIGHTS
+				|| cmsg->cmsg_len != CMSG_LEN(sizeof(fds))
+				|| (size_t) count < sizeof(RequestHeader)) {
+			continue; // Malformed request, the shell does not send it
+		}
+		memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+
+		helperSpawn(sock, &data[0], count, fds);
+		for (int i = 0; i < 3; i++) {
+			close(fds[i]);
+		}
+	}
+}
+
+/**
+ * Forks the child of the request and replies its PID.
+ */
+void ForkServer::helperSpawn(int sock, const char *data, size_t length,
+		int *fds) {
+	RequestHeader header;
+	memcpy(&header, data, sizeof(header));
+
+	Reply reply;
+	memset(&reply, 0, sizeof(reply));
+	reply.type = SPAWNED;
+	reply.id = header.id;
+	reply.pid = fork();
+	if (reply.pid == 0) {
+		execChild(data, length, fds);
+	} else if (reply.pid == -1) {
+		reply.error = errno;
+	} else if (header.newGroup) {
+		setpgid(reply.pid, reply.pid); // Group exists before the reply
+	}
+
+	send(sock, &reply, sizeof(reply), MSG_NOSIGNAL);
+}
+
+/**
+ * Reaps exited children and forwards their statuses.
+ */
+void ForkServer::helperReap(int sock) {
+	Reply reply;
+	memset(&reply, 0, sizeof(reply));
+	reply.type = EXITED;
+	while ((reply.pid = wait4(-1, &reply.status, WNOHANG, &reply.usage)) > 0) {
+		clock_gettime(CLOCK_MONOTONIC, &reply.end);
+		send(sock, &reply, sizeof(reply), MSG_NOSIGNAL);
+	}
+}
+
+/**
+ * Sets up the forked child and executes its program, it never returns.
+ */
+void ForkServer::execChild(const char *data, size_t length, int *fds) {
+	RequestHeader header;
+	memcpy(&header, data, sizeof(header));
+
+	sigset_t mask;
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	sigprocmask(SIG_UNBLOCK, &mask, NULL);
+
+	if (header.newGroup) {
+		setpgid(0, 0);
+	}
+
+	struct sigaction sa;
+	sa.sa_flags = (header.background) ? 0 : SA_RESTART | SA_SIGINFO;
+	sa.sa_handler = (header.background) ? SIG_IGN : SIG_DFL;
+	sigemptyset(&sa.sa_mask);
+	sigaddset(&sa.sa_mask, SIGINT);
+	sigaction(SIGINT, &sa, NULL);
+
+	for (int i = 0; i < 3; i++) {
+		if (dup2(fds[i], i) == -1) {
+			_exit(EXIT_FAILURE);
+		}
+	}
+
+	/* Strings follow the header: cwd, program, argv and environment */
+	vector<char *> strings;
+	const char *end = data + length;
+	for (const char *str = data + sizeof(header); str < end;
+			str += strlen(str) + 1) {
+		strings.push_back(const_cast<char *>(str));
+	}
+	if (strings.size() != 2 + header.argc + header.envc || header.argc == 0) {
+		_exit(EXIT_FAILURE);
+	}
+
+	vector<char *> argv(strings.begin() + 2, strings.begin() + 2 + header.argc);
+	argv.push_back(NULL);
+	vector<char *> env(strings.begin() + 2 + header.argc, strings.end());
+	env.push_back(NULL);
+	environ = &env[0];
+
+	if (strings[0][0] != '\0' && chdir(strings[0]) != 0) {
+		perror("Failed to change working directory - chdir()");
+		_exit(EXIT_FAILURE);
+	}
+	if (Scheduling::apply(header.sched) != EXIT_SUCCESS
+			|| ResourceLimits::apply(header.limits) != EXIT_SUCCESS) {
+		_exit(EXIT_FAILURE);
+	}
+
+	wordexp_t res;
+	if (header.expand) {
+		if (wordexp(argv[0], &res, 0) != 0) {
+			_exit(EXIT_FAILURE);
+		}
+		execvp(res.we_wordv[0], res.we_wordv);
+	} else {
+		if (strings[1][0] != '\0') { // PATH is searched when it fails
+			execv(strings[1], &argv[0]);
+		}
+		execvp(argv[0], &argv[0]);
+	}
+
+	int retError = errno;
+	perror("Failed - execv()");
+	_exit((retError == ENOENT) ? EXIT_NOT_FOUND : EXIT_NOT_EXECUTABLE);
+}
@@ -0,0 +1,145 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       ForkServer.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines helper process forking children
+//             on behalf of the shell.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ForkServer.h
+ *
+ * @brief Header file which defines helper process forking children on behalf
+ *        of the shell.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef FORKSERVER_H_INCLUDED
+#define FORKSERVER_H_INCLUDED
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include "PThread.h"
+#include "Scheduling.h"
+#include "ResourceLimits.h"
+
+using namespace std;
+
+/**
+ * Child which should be started by the fork server.
+ */
+typedef struct {
+	vector<string> argv; /**< program and arguments, or one line for wordexp */
+	bool expand; /**< argv[0] is expanded by wordexp */
+	bool background; /**< child ignores SIGINT */
+	bool newGroup; /**< child leads its own process group */
+	string cwd; /**< working directory, empty for the one of the helper */
+	string program; /**< path of argv[0], empty when PATH is searched */
+	int fds[3]; /**< stdin, stdout and stderr of the child */
+	SchedAttrs sched; /**< applied before exec */
+	LimitAttrs limits; /**< applied before exec */
+} SpawnRequest;
+
+/**
+ * Fork server (zygote) - small helper process forked when the shell starts,
+ * before its threads run and its heap grows. Children are forked by
+ * the helper, so cost of the fork does not depend on the state of the shell.
+ * Requests are sent over the socket pair with descriptors of the child
+ * attached (SCM_RIGHTS), helper replies with PID. Helper is the parent
+ * of all children and forwards their exit statuses, which are waited for
+ * by wait() instead of wait4().
+ */
+class ForkServer {
+public:
+	static bool start();
+	static void stop();
+	static bool isRunning();
+
+	static pid_t spawn(const SpawnRequest &request);
+	static pid_t wait(pid_t pid, int *status, struct rusage *usage,
+			int options, struct timespec *end = NULL);
+private:
+	class Receiver;
+	friend class Receiver;
+
+	static const int SPAWNED = 1;
+	static const int EXITED = 2;
+	static const size_t MAX_REQUEST = 131072;
+
+	/**
+	 * Fixed part of the request, followed by cwd, program, argv and environment
+	 * as NUL terminated strings.
+	 */
+	typedef struct {
+		uint32_t id;
+		uint32_t argc;
+		uint32_t envc;
+		uint8_t expand;
+		uint8_t background;
+		uint8_t newGroup;
+		SchedAttrs sched;
+		LimitAttrs limits;
+	} RequestHeader;
+
+	/**
+	 * Message of the helper - reply to the request or exit of the child.
+	 */
+	typedef struct {
+		uint32_t type;
+		uint32_t id; /**< request of the spawned child */
+		pid_t pid;
+		int error; /**< errno of the failed fork */
+		int status;
+		struct rusage usage;
+		struct timespec end; /**< monotonic time of the exit */
+	} Reply;
+
+	/**
+	 * Exit of the child which has not been waited for.
+	 */
+	typedef struct {
+		int status;
+		struct rusage usage;
+		struct timespec end;
+	} Exit;
+
+	int sock;
+	pid_t helper;
+	Receiver *receiver;
+	PThreadMonitor monitor;
+	PThreadCondition changed; /**< reply or exit has been received */
+	bool closed; /**< helper has exited */
+	uint32_t nextId;
+	map<uint32_t, pair<pid_t, int> > spawned; /**< replies by request */
+	map<pid_t, Exit> exits;
+
+	static ForkServer *instance;
+
+	ForkServer(int sock, pid_t helper);
+	~ForkServer();
+	void receive();
+
+	static void helperMain(int sock);
+	static void helperSpawn(int sock, const char *data, size_t length,
+			int *fds);
+	static void helperReap(int sock);
+	static void execChild(const char *data, size_t length, int *fds);
+
+	ForkServer(const ForkServer &);
+	ForkServer &operator=(const ForkServer &);
+};
+
+#endif // FORKSERVER_H_INCLUDED
@@ -0,0 +1,524 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       History.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements persistent history of the command
+//             lines.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file History.cpp
+ *
+ * @brief Source file which implements persistent history of the command
+ *        lines.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <set>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "History.h"
+
+using namespace std;
+
+/**
+ * Thread which sorts the mapped entries by their text.
+ */
+class History::Indexer: public PThread {
+public:
+	Indexer(History &history) :
+			history(history) {
+	}
+	virtual ~Indexer() {
+		cancel();
+	}
+	virtual int run() {
+		history.sortEntries();
+		return 0;
+	}
+private:
+	History &history;
+};
+
+/**
+ * Orders mapped entries by their text, entries are given by their indexes.
+ */
+class History::TextLess {
+public:
+	TextLess(const History &history) :
+			history(history) {
+	}
+	bool operator()(uint32_t a, uint32_t b) const {
+		size_t lengthA, lengthB;
+		const char *textA = text(a, lengthA), *textB = text(b, lengthB);
+		int result = memcmp(textA, textB, min(lengthA, lengthB));
+		return (result != 0) ? result < 0 : lengthA < lengthB;
+	}
+	bool operator()(uint32_t a, const string &b) const {
+		size_t lengthA;
+		const char *textA = text(a, lengthA);
+		int result = memcmp(textA, b.data(), min(lengthA, b.size()));
+		return (result != 0) ? result < 0 : lengthA < b.size();
+	}
+	const char *text(uint32_t index, size_t &length) const {
+		const vector<uint32_t> &starts = history.starts;
+		size_t end = (index + 1 < starts.size()) ?
+				starts[index + 1] : history.length;
+		length = end - starts[index] - 1; // Without newline
+		return history.data + starts[index];
+	}
+private:
+	const History &history;
+};
+
+/**
+ * Constructor.
+ */
+History::History() :
+		data(NULL), mappedSize(0), length(0), indexer(NULL), released(0) {
+}
+
+/**
+ * Destructor, stops the indexer and unmaps the file.
+ */
+History::~History() {
+	delete indexer;
+	if (data != NULL) {
+		munmap(const_cast<char *>(data), mappedSize);
+	}
+}
+
+/**
+ * Maps the history file and starts building of its index on background.
+ * Entries which are appended by other shells later are not seen.
+ * @param fileName File of the history, it is created if it does not exist.
+ * @return True on success, false on failure.
+ */
+bool History::open(const string &fileName) {
+	this->fileName = fileName;
+
+	int fd = -1;
+	struct stat st;
+	for (int attempt = 0; attempt < 2; attempt++) {
+		fd = ::open(fileName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+		if (fd == -1) {
+			perror("Failed to open history - open()");
+			return false;
+		}
+		flock(fd, LOCK_SH); // Appends are not seen halfway
+		if (fstat(fd, &st) == -1 || (size_t) st.st_size <= MAX_SIZE
+				|| !compact(fd, st.st_size)) {
+			break;
+		}
+		close(fd);
+		fd = -1;
+	}
+	if (fd == -1) {
+		return false;
+	}
+
+	if (st.st_size > 0) {
+		void *mapped = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (mapped == MAP_FAILED) {
+			perror("Failed to map history - mmap()");
+		} else {
+			data = static_cast<const char *>(mapped);
+			mappedSize = st.st_size;
+			madvise(mapped, mappedSize, MADV_RANDOM);
+
+			/* Entry which is not complete is ignored */
+			const char *last = static_cast<const char *>(memrchr(data, '\n',
+					mappedSize));
+			length = (last != NULL) ? last - data + 1 : 0;
+		}
+	}
+	flock(fd, LOCK_UN); // Mapping keeps the file open, lock would stay
+	close(fd);
+	return true;
+}
+
+/**
+ * Appends line to the history, empty lines and repeated lines are skipped.
+ * @param line Command line without newline.
+ */
+void History::add(const string &line) {
+	if (line.find_first_not_of(" \t\r\n") == string::npos
+			|| line.find('\n') != string::npos) {
+		return;
+	}
+
+	vector<string> previous;
+	newest(1, previous);
+	if (!previous.empty() && previous[0] == line) {
+		return;
+	}
+
+	/* Released entries stay in the file, numbers of the others are kept */
+	if (added.size() >= MAX_ADDED) {
+		added.erase(added.begin(), added.begin() + MAX_ADDED / 2);
+		released += MAX_ADDED / 2;
+	}
+	added.push_back(line);
+	append(line);
+}
+
+/**
+ * Expands history reference at the start of the line: !! the last entry,
+ * !N entry number N, !-N N-th entry from the end and !PREFIX the newest
+ * entry starting with PREFIX. Rest of the line follows the entry.
+ * @param line Command line.
+ * @param expanded Expanded command line.
+ * @param error Description of the reference which has not been found.
+ * @return True if the line has been expanded, false if it has no reference
+ * or reference has not been found (error is set).
+ */
+bool History::expand(const string &line, string &expanded, string &error) {
+	error.clear();
+	size_t start = line.find_first_not_of(" \t");
+	if (start == string::npos || line[start] != '!' || start + 1 >= line.size()
+			|| strchr(" \t=(", line[start + 1]) != NULL) {
+		return false;
+	}
+
+	size_t end = line.find_first_of(" \t", start);
+	string reference = line.substr(start + 1,
+			(end != string::npos) ? end - start - 1 : string::npos);
+
+	HistoryEntry entry;
+	vector<string> texts;
+	bool found;
+	char *numberEnd;
+	long number = strtol(reference.c_str(), &numberEnd, 10);
+	if (reference == "!" || (*numberEnd == '\0' && number < 0)) {
+		size_t count = (reference == "!") ? 1 : -number;
+		newest(count, texts);
+		found = texts.size() == count;
+		entry.second = found ? texts.back() : "";
+	} else if (*numberEnd == '\0') {
+		found = findNumber(number, entry);
+	} else {
+		found = findPrefix(reference, entry);
+	}
+
+	if (!found) {
+		error = "!" + reference + ": event not found";
+		return false;
+	}
+	expanded = line.substr(0, start) + entry.second
+			+ ((end != string::npos) ? line.substr(end) : "");
+	return true;
+}
+
+/**
+ * Returns number of the entries, waits for the index.
+ */
+size_t History::size() {
+	findEntries();
+	return starts.size() + released + added.size();
+}
+
+/**
+ * Returns the newest entries, the oldest first, waits for the index.
+ * @param count Maximal number of the entries.
+ * @param entries Entries are appended here.
+ */
+void History::last(size_t count, vector<HistoryEntry> &entries) {
+	vector<string> texts;
+	newest(count, texts);
+
+	size_t number = size() - texts.size() + 1;
+	for (size_t i = texts.size(); i > 0; i--) {
+		entries.push_back(HistoryEntry(number++, texts[i - 1]));
+	}
+}
+
+/**
+ * Finds unique entries containing text, the newest first.
+ * @param text Searched text.
+ * @param entries Entries are appended here.
+ */
+void History::search(const string &text, vector<HistoryEntry> &entries) {
+	findEntries();
+	set<string> seen;
+	for (size_t i = added.size(); i > 0; i--) {
+		if (added[i - 1].find(text) != string::npos
+				&& seen.insert(added[i - 1]).second) {
+			entries.push_back(
+					HistoryEntry(starts.size() + released + i, added[i - 1]));
+		}
+	}
+
+	/* Mapped entries are searched by memmem, matches are mapped to the
+	 * entries by their offsets */
+	vector<uint32_t> matched;
+	const char *position = data, *end = data + length;
+	while (!text.empty() && position < end) {
+		const char *match = static_cast<const char *>(memmem(position,
+				end - position, text.data(), text.size()));
+		if (match == NULL) {
+			break;
+		}
+		uint32_t index = upper_bound(starts.begin(), starts.end(),
+				(uint32_t) (match - data)) - starts.begin() - 1;
+		matched.push_back(index);
+		position = data
+				+ ((index + 1 < starts.size()) ? starts[index + 1] : length);
+	}
+	for (size_t i = matched.size(); i > 0; i--) {
+		string entry = entryText(matched[i - 1]);
+		if (seen.insert(entry).second) {
+			entries.push_back(HistoryEntry(matched[i - 1] + 1, entry));
+		}
+	}
+}
+
+/**
+ * Finds offsets of the mapped entries, it is done once, when the entries
+ * are numbered for the first time.
+ */
+void History::findEntries() {
+	if (!starts.empty()) {
+		return;
+	}
+	const char *position = data, *end = data + length;
+	while (position < end) {
+		starts.push_back(position - data);
+		position = static_cast<const char *>(memchr(position, '\n',
+				end - position)) + 1;
+	}
+}
+
+/**
+ * Sorts the unique mapped entries by their text, it runs on the indexer
+ * thread. Newer entries go first, so stable sort keeps them first among
+ * the same ones and only the newest is kept.
+ */
+void History::sortEntries() {
+	sorted.resize(starts.size());
+	for (size_t i = 0; i < sorted.size(); i++) {
+		sorted[i] = sorted.size() - i - 1;
+	}
+	TextLess less(*this);
+	stable_sort(sorted.begin(), sorted.end(), less);
+
+	vector<uint32_t>::iterator last = sorted.begin();
+	for (vector<uint32_t>::iterator it = sorted.begin(); it != sorted.end();
+			++it) {
+		if (it == sorted.begin() || less(*(last - 1), *it)) {
+			*last++ = *it;
+		}
+	}
+	sorted.erase(last, sorted.end());
+	vector<uint32_t>(sorted).swap(sorted); // Releases the duplicates
+}
+
+/**
+ * Finds the newest entry starting with prefix. Entries of this shell
+ * are searched first, then the mapped ones by the sorted index. Index
+ * is built on background with the first lookup, until it is ready, entries
+ * are searched from the end.
+ */
+bool History::findPrefix(const string &prefix, HistoryEntry &entry) {
+	for (size_t i = added.size(); i > 0; i--) {
+		if (added[i - 1].compare(0, prefix.size(), prefix) == 0) {
+			entry = HistoryEntry(0, added[i - 1]); // Number is not needed
+			return true;
+		}
+	}
+
+	if (length == 0) {
+		return false;
+	} else if (indexer == NULL) {
+		findEntries();
+		indexer = new Indexer(*this);
+		indexer->start();
+	}
+
+	if (!indexer->getCompletion().isFinished()) {
+		const char *end = data + length;
+		while (end > data) {
+			const char *begin = previousEntry(end);
+			if ((size_t) (end - 1 - begin) >= prefix.size()
+					&& memcmp(begin, prefix.data(), prefix.size()) == 0) {
+				entry = HistoryEntry(0, string(begin, end - 1));
+				return true;
+			}
+			end = begin;
+		}
+		return false;
+	}
+
+	TextLess less(*this);
+	uint32_t latest = 0;
+	bool found = false;
+	for (vector<uint32_t>::iterator it = lower_bound(sorted.begin(),
+			sorted.end(), prefix, less); it != sorted.end(); ++it) {
+		size_t textLength;
+		const char *text = less.text(*it, textLength);
+		if (textLength < prefix.size()
+				|| memcmp(text, prefix.data(), prefix.size()) != 0) {
+			break;
+		}
+		latest = (!found || *it > latest) ? *it : latest;
+		found = true;
+	}
+	if (found) {
+		entry = HistoryEntry(latest + 1, entryText(latest));
+	}
+	return found;
+}
+
+/**
+ * Finds entry by its number.
+ */
+bool History::findNumber(size_t number, HistoryEntry &entry) {
+	findEntries();
+	if (number >= 1 && number <= starts.size()) {
+		entry = HistoryEntry(number, entryText(number - 1));
+		return true;
+	} else if (number > starts.size() + released
+			&& number <= starts.size() + released + added.size()) {
+		entry = HistoryEntry(number,
+				added[number - starts.size() - released - 1]);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Returns texts of the newest entries, the newest first. Mapped entries
+ * are found from the end, so the index is not needed.
+ * @param count Maximal number of the entries.
+ * @param texts Texts are appended here.
+ */
+void History::newest(size_t count, vector<string> &texts) {
+	for (size_t i = added.size(); i > 0 && texts.size() < count; i--) {
+		texts.push_back(added[i - 1]);
+	}
+
+	const char *end = data + length;
+	while (texts.size() < count && end > data) {
+		const char *begin = previousEntry(end);
+		texts.push_back(string(begin, end - 1));
+		end = begin;
+	}
+}
+
+/**
+ * Returns start of the mapped entry which ends by newline before end.
+ */
+const char *History::previousEntry(const char *end) const {
+	const char *begin = end - 1;
+	while (begin > data && begin[-1] != '\n') {
+		begin--;
+	}
+	return begin;
+}
+
+/**
+ * Returns text of the mapped entry, the index has to be built.
+ */
+string History::entryText(size_t index) const {
+	size_t textLength;
+	const char *text = TextLess(*this).text(index, textLength);
+	return string(text, textLength);
+}
+
+/**
+ * Appends line to the history file under exclusive lock. File is opened
+ * for every append, so the file replaced by compaction of other shell
+ * is not written.
+ * @return True on success, false on failure.
+ */
+bool History::append(const string &line) {
+	for (int attempt = 0; attempt < 3; attempt++) {
+		int fd = ::open(fileName.c_str(),
+				O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+		if (fd == -1) {
+			return false;
+		}
+		flock(fd, LOCK_EX);
+
+		struct stat opened, current;
+		if (fstat(fd, &opened) == -1 || stat(fileName.c_str(), &current) == -1
+				|| opened.st_ino != current.st_ino) {
+			close(fd); // Replaced meanwhile
+			continue;
+		}
+
+		/* Entry left incomplete by a crashed shell is terminated */
+		char lastChar = '\n';
+		if (opened.st_size > 0) {
+			int readFd = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+			if (readFd != -1) {
+				if (pread(readFd, &lastChar, 1, opened.st_size - 1) != 1) {
+					lastChar = '\n';
+				}
+				close(readFd);
+			}
+		}
+		string record = ((lastChar != '\n') ? "\n" : "") + line + "\n";
+		bool written = write(fd, record.data(), record.size())
+				== (ssize_t) record.size();
+		close(fd);
+		return written;
+	}
+	return false;
+}
+
+/**
+ * Replaces the history file by its newer half, it is called under shared
+ * lock which is upgraded. Other shells keep their mappings of the replaced
+ * file.
+ * @param fd Opened history file.
+ * @param size Size of the file.
+ * @return True if the file has been replaced.
+ */
+bool History::compact(int fd, size_t size) {
+	flock(fd, LOCK_EX);
+	struct stat st;
+	if (fstat(fd, &st) == -1 || (size_t) st.st_size <= MAX_SIZE) {
+		return false; // Compacted by other shell meanwhile
+	}
+	size = st.st_size;
+
+	size_t keep = MAX_SIZE / 2;
+	vector<char> tail(keep);
+	if (pread(fd, &tail[0], keep, size - keep) != (ssize_t) keep) {
+		return false;
+	}
+	vector<char>::iterator begin = find(tail.begin(), tail.end(), '\n');
+	begin = (begin != tail.end()) ? begin + 1 : tail.begin();
+
+	string tmpName = fileName + ".tmp";
+	int tmp = ::open(tmpName.c_str(),
+			O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+	if (tmp == -1) {
+		return false;
+	}
+	bool written = write(tmp, &*begin, tail.end() - begin)
+			== tail.end() - begin;
+	close(tmp);
+	if (!written || rename(tmpName.c_str(), fileName.c_str()) == -1) {
+		perror("Failed to compact history");
+		unlink(tmpName.c_str());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       History.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines persistent history of the command
+//             lines.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file History.h
+ *
+ * @brief Header file which defines persistent history of the command lines.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef HISTORY_H_INCLUDED
+#define HISTORY_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <stdint.h>
+
+#include "PThread.h"
+
+using namespace std;
+
+/**
+ * Numbered entry of the history.
+ */
+typedef pair<size_t, string> HistoryEntry;
+
+/**
+ * History of the command lines kept in append-only file, one line per entry.
+ * File is memory mapped when the shell starts, it is not parsed, so startup
+ * does not depend on its size. Offsets of the entries are found when they
+ * are numbered for the first time, unique entries sorted by text for prefix
+ * lookups are built on background thread with the first lookup. Lines
+ * of this shell are appended to the file under
+ * flock, so concurrent shells do not interleave, and kept in memory. File
+ * which grows over MAX_SIZE is compacted to its newer half when the shell
+ * starts, lines of this shell over MAX_ADDED are released by the older half,
+ * so memory stays bounded.
+ */
+class History {
+public:
+	static const size_t MAX_SIZE = 32 << 20;
+	static const size_t MAX_ADDED = 4096; /**< lines of this shell in memory */
+
+	History();
+	~History();
+
+	bool open(const string &fileName);
+	void add(const string &line);
+	bool expand(const string &line, string &expanded, string &error);
+
+	size_t size();
+	void last(size_t count, vector<HistoryEntry> &entries);
+	void search(const string &text, vector<HistoryEntry> &entries);
+private:
+	class Indexer;
+	friend class Indexer;
+
+	string fileName;
+	const char *data; /**< mapped file */
+	size_t mappedSize;
+	size_t length; /**< mapped bytes up to the last complete entry */
+	Indexer *indexer;
+	vector<uint32_t> starts; /**< offsets of the mapped entries */
+	vector<uint32_t> sorted; /**< unique mapped entries sorted by text */
+	vector<string> added; /**< entries added by this shell */
+	size_t released; /**< older entries of this shell only in the file */
+
+	void findEntries();
+	void sortEntries();
+	bool findPrefix(const string &prefix, HistoryEntry &entry);
+	bool findNumber(size_t number, HistoryEntry &entry);
+	void newest(size_t count, vector<string> &texts);
+	const char *previousEntry(const char *end) const;
+	string entryText(size_t index) const;
+	bool append(const string &line);
+	bool compact(int fd, size_t size);
+
+	class TextLess;
+
+	History(const History &);
+	History &operator=(const History &);
+};
+
+#endif // HISTORY_H_INCLUDED
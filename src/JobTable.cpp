@@ -0,0 +1,228 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       JobTable.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements table of the running children
+//             and their resource usage.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file JobTable.cpp
+ *
+ * @brief Source file which implements table of the running children and
+ *        their resource usage.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <sys/wait.h>
+
+#include "ForkServer.h"
+#include "JobTable.h"
+
+using namespace std;
+
+/**
+ * Constructor, allocates all entries.
+ * @param capacity Number of entries, one of them is kept for foreground.
+ */
+JobTable::JobTable(int capacity) {
+	Job empty = Job(); // Value initialized - all members are zeroed
+	jobs.resize(capacity, empty);
+}
+
+/**
+ * Tests whether the child can be added, so it is not started needlessly.
+ * The last entry is kept for the foreground child.
+ * @param background Whether child runs on background.
+ * @return False if table is full.
+ */
+bool JobTable::hasRoom(bool background) const {
+	int free = 0;
+	for (size_t i = 0; i < jobs.size(); i++) {
+		free += (jobs[i].pid == 0) ? 1 : 0;
+	}
+	return free > (background ? 1 : 0);
+}
+
+/**
+ * Adds started child into the table.
+ * @param pid PID of the child.
+ * @param command Command line of the child.
+ * @param background Whether child runs on background.
+ * @param start Time when the child has been forked.
+ * @return Entry of the child or NULL if table is full.
+ */
+Job *JobTable::add(pid_t pid, const string &command, bool background,
+		const struct timespec &start) {
+	if (!hasRoom(background)) {
+		return NULL;
+	}
+
+	for (size_t i = 0; i < jobs.size(); i++) {
+		if (jobs[i].pid == 0) {
+			Job &job = jobs[i];
+			job.background = background;
+			job.finished = false;
+			job.status = 0;
+			job.command = command;
+			job.seq = 0;
+			job.eventFields.clear();
+			job.start = start;
+			job.pid = pid;
+			return &job;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Finds entry of the child.
+ * @param pid PID of the child.
+ * @return Entry of the child or NULL if there is no such child.
+ */
+Job *JobTable::find(pid_t pid) {
+	for (size_t i = 0; i < jobs.size(); i++) {
+		if (jobs[i].pid == pid) {
+			return &jobs[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Finds child which has finished.
+ * @param background Whether background or foreground child is searched.
+ * @return Entry of the child or NULL if there is no such child.
+ */
+Job *JobTable::nextFinished(bool background) {
+	for (size_t i = 0; i < jobs.size(); i++) {
+		if (jobs[i].pid != 0 && jobs[i].finished
+				&& jobs[i].background == background) {
+			return &jobs[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Frees entry of the child.
+ */
+void JobTable::remove(Job *job) {
+	job->pid = 0;
+}
+
+/**
+ * Records exit of the child, safe to be called from the signal handler.
+ * @param pid PID of the child.
+ * @param status Status returned by wait4().
+ * @param usage Resource usage returned by wait4().
+ * @param end Monotonic time of the exit, NULL for now.
+ */
+void JobTable::finish(pid_t pid, int status, const struct rusage &usage,
+		const struct timespec *end) {
+	for (size_t i = 0; i < jobs.size(); i++) {
+		if (jobs[i].pid == pid) {
+			if (end != NULL) {
+				jobs[i].end = *end;
+			} else {
+				clock_gettime(CLOCK_MONOTONIC, &jobs[i].end);
+			}
+			jobs[i].status = status;
+			jobs[i].usage = usage;
+			jobs[i].finished = true;
+			return;
+		}
+	}
+}
+
+/**
+ * Reaps children of the table which have exited, does not block.
+ * Only children of this table are waited for, so other children of the
+ * process are not taken from their waiters.
+ */
+void JobTable::reap() {
+	int status;
+	struct rusage usage;
+	struct timespec end;
+	for (size_t i = 0; i < jobs.size(); i++) {
+		if (jobs[i].pid != 0 && !jobs[i].finished
+				&& ForkServer::wait(jobs[i].pid, &status, &usage, WNOHANG, &end)
+						> 0) {
+			finish(jobs[i].pid, status, usage, &end);
+		}
+	}
+}
+
+/**
+ * Reaps children of the table forked by the shell itself which have exited,
+ * safe to be called from the signal handler. Children of the fork server
+ * are reaped by the helper, their statuses are taken by reap().
+ */
+void JobTable::reapChildren() {
+	int status;
+	struct rusage usage;
+	for (size_t i = 0; i < jobs.size(); i++) {
+		pid_t pid = jobs[i].pid;
+		if (pid != 0 && !jobs[i].finished
+				&& wait4(pid, &status, WNOHANG, &usage) == pid) {
+			finish(pid, status, usage);
+		}
+	}
+}
+
+/**
+ * Frees all entries, children which have not been reaped are passed
+ * to the caller.
+ * @param running PIDs of the children are appended here.
+ */
+void JobTable::release(vector<pid_t> &running) {
+	for (size_t i = 0; i < jobs.size(); i++) {
+		if (jobs[i].pid != 0 && !jobs[i].finished) {
+			running.push_back(jobs[i].pid);
+		}
+		jobs[i].pid = 0;
+	}
+}
+
+/**
+ * Returns wall time of the finished child in seconds.
+ */
+double JobTable::realTime(const Job &job) {
+	return (job.end.tv_sec - job.start.tv_sec)
+			+ (job.end.tv_nsec - job.start.tv_nsec) / 1e9;
+}
+
+/**
+ * Converts status of the finished child into exit status.
+ */
+int JobTable::exitStatus(const Job &job) {
+	if (WIFEXITED(job.status)) {
+		return WEXITSTATUS(job.status);
+	} else if (WIFSIGNALED(job.status)) {
+		return 128 + WTERMSIG(job.status);
+	}
+	return EXIT_FAILURE;
+}
+
+/**
+ * Formats resource usage of the finished child into one line.
+ */
+string JobTable::format(const Job &job) {
+	char line[256];
+	snprintf(line, sizeof(line),
+			"pid=%d status=%d real=%.6f user=%.6f sys=%.6f maxrss_kb=%ld "
+					"nvcsw=%ld nivcsw=%ld bg=%d cmd=", (int) job.pid,
+			exitStatus(job), realTime(job),
+			job.usage.ru_utime.tv_sec + job.usage.ru_utime.tv_usec / 1e6,
+			job.usage.ru_stime.tv_sec + job.usage.ru_stime.tv_usec / 1e6,
+			job.usage.ru_maxrss, job.usage.ru_nvcsw, job.usage.ru_nivcsw,
+			job.background ? 1 : 0);
+	return line + job.command;
+}
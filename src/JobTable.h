@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       JobTable.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines table of the running children
+//             and their resource usage.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file JobTable.h
+ *
+ * @brief Header file which defines table of the running children and their
+ *        resource usage.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef JOBTABLE_H_INCLUDED
+#define JOBTABLE_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <time.h>
+
+using namespace std;
+
+/**
+ * Child process started by the shell.
+ */
+typedef struct {
+	pid_t pid; /**< 0 for free entry */
+	bool background;
+	volatile bool finished;
+	int status;
+	struct timespec start;
+	struct timespec end;
+	struct rusage usage;
+	string command;
+	unsigned long seq; /**< number of the input line which started child */
+	string eventFields; /**< arguments and redirections for event stream */
+} Job;
+
+/**
+ * Table of the children started by the shell. Entries are allocated at once,
+ * so reapChildren() and finish() do not allocate and can be called from
+ * the signal handler. Other methods must be called with SIGCHLD blocked.
+ */
+class JobTable {
+public:
+	static const int MAX_JOBS = 128;
+
+	JobTable(int capacity = MAX_JOBS);
+
+	bool hasRoom(bool background) const;
+	Job *add(pid_t pid, const string &command, bool background,
+			const struct timespec &start);
+	Job *find(pid_t pid);
+	Job *nextFinished(bool background);
+	void remove(Job *job);
+	void finish(pid_t pid, int status, const struct rusage &usage,
+			const struct timespec *end = NULL);
+	void reap();
+	void reapChildren();
+	void release(vector<pid_t> &running);
+
+	static double realTime(const Job &job);
+	static int exitStatus(const Job &job);
+	static string format(const Job &job);
+private:
+	vector<Job> jobs;
+};
+
+#endif // JOBTABLE_H_INCLUDED
@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       LRUCache.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines bounded cache which evicts the least
+//             recently used entries.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file LRUCache.h
+ *
+ * @brief Header file which defines bounded cache which evicts the least
+ *        recently used entries.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef LRUCACHE_H_INCLUDED
+#define LRUCACHE_H_INCLUDED
+
+#include <cstddef>
+
+#include <list>
+#include <map>
+#include <utility>
+
+using namespace std;
+
+/**
+ * Bounded cache, the least recently used entry is evicted when the cache
+ * is full. Cache is not thread safe.
+ */
+template<typename Key, typename Value>
+class LRUCache {
+public:
+	LRUCache(size_t capacity) :
+			capacity(capacity), hits(0), misses(0) {
+	}
+
+	/**
+	 * Finds entry and marks it as the most recently used.
+	 * @param key Key of the entry.
+	 * @return Value of the entry or NULL if there is no such entry.
+	 */
+	Value *get(const Key &key) {
+		typename Index::iterator it = index.find(key);
+		if (it == index.end()) {
+			misses++;
+			return NULL;
+		}
+
+		entries.splice(entries.begin(), entries, it->second);
+		hits++;
+		return &it->second->second;
+	}
+
+	/**
+	 * Inserts or replaces entry, the least recently used entry is evicted
+	 * when the cache is full.
+	 * @param key Key of the entry.
+	 * @param value Value of the entry.
+	 * @return Value stored in the cache.
+	 */
+	Value &put(const Key &key, const Value &value) {
+		typename Index::iterator it = index.find(key);
+		if (it != index.end()) {
+			entries.erase(it->second);
+			index.erase(it);
+		} else if (index.size() >= capacity && !entries.empty()) {
+			index.erase(entries.back().first);
+			entries.pop_back();
+		}
+
+		entries.push_front(make_pair(key, value));
+		index[key] = entries.begin();
+		return entries.front().second;
+	}
+
+	/**
+	 * Counts lookup which has been rejected by the caller as a miss.
+	 */
+	void reject() {
+		hits--;
+		misses++;
+	}
+
+	void clear() {
+		entries.clear();
+		index.clear();
+	}
+
+	size_t size() const {
+		return index.size();
+	}
+
+	size_t getCapacity() const {
+		return capacity;
+	}
+
+	unsigned long getHits() const {
+		return hits;
+	}
+
+	unsigned long getMisses() const {
+		return misses;
+	}
+
+private:
+	typedef list<pair<Key, Value> > Entries;
+	typedef map<Key, typename Entries::iterator> Index;
+
+	size_t capacity;
+	Entries entries;
+	Index index;
+	unsigned long hits;
+	unsigned long misses;
+};
+
+#endif // LRUCACHE_H_INCLUDED
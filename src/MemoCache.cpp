@@ -0,0 +1,380 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       MemoCache.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements on-disk cache of the output
+//             of memoized commands.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file MemoCache.cpp
+ *
+ * @brief Source file which implements on-disk cache of the output of memoized
+ *        commands.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "MemoCache.h"
+
+using namespace std;
+
+pthread_mutex_t MemoCache::mutex = PTHREAD_MUTEX_INITIALIZER;
+off_t MemoCache::storeSize = -1;
+
+/**
+ * Temporary files older than this are left by crashed shells.
+ */
+static const time_t STALE_TEMP_AGE = 3600;
+
+/**
+ * Continues FNV-1a hash with the data.
+ * @param seed Hash of the preceding data.
+ * @param data Hashed data.
+ * @return Hash of the preceding data and the data.
+ */
+uint64_t MemoCache::hash(uint64_t seed, const string &data) {
+	const uint64_t prime = ((uint64_t) 0x100 << 32) | 0x1b3;
+	for (size_t i = 0; i < data.size(); i++) {
+		seed ^= (unsigned char) data[i];
+		seed *= prime;
+	}
+	return seed;
+}
+
+/**
+ * Computes FNV-1a hash of the data.
+ */
+uint64_t MemoCache::hash(const string &data) {
+	return hash(((uint64_t) 0xcbf29ce4 << 32) | 0x84222325, data);
+}
+
+/**
+ * Returns directory of the store - SHELL_MEMO_DIR, otherwise shell-memo
+ * in XDG_CACHE_HOME or in ~/.cache.
+ */
+string MemoCache::getDir() {
+	const char *dir = getenv("SHELL_MEMO_DIR");
+	if (dir != NULL && *dir != '\0') {
+		return dir;
+	}
+	dir = getenv("XDG_CACHE_HOME");
+	if (dir != NULL && *dir != '\0') {
+		return string(dir) + "/shell-memo";
+	}
+	dir = getenv("HOME");
+	return string((dir != NULL) ? dir : "/tmp") + "/.cache/shell-memo";
+}
+
+/**
+ * Looks up output of the command.
+ * @param key Hash of the command and of everything its output depends on.
+ * @param fd Opened object with the output, it is closed by the caller.
+ * @param status Exit status of the command.
+ * @return True if the output is cached.
+ */
+bool MemoCache::lookup(uint64_t key, int &fd, int &status) {
+	string dir = getDir();
+	string keyName = dir + "/keys/" + hex(key);
+	int keyFd = open(keyName.c_str(), O_RDONLY | O_CLOEXEC);
+	if (keyFd == -1) {
+		return false;
+	}
+
+	char record[128];
+	ssize_t count = read(keyFd, record, sizeof(record) - 1);
+	close(keyFd);
+	record[(count > 0) ? count : 0] = '\0';
+
+	char object[64];
+	if (sscanf(record, "%63s %d", object, &status) != 2
+			|| strspn(object, "0123456789abcdef-") != strlen(object)) {
+		return false;
+	}
+
+	fd = open((dir + "/objects/" + object).c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd == -1) { // Object has been evicted
+		unlink(keyName.c_str());
+		return false;
+	}
+	futimens(fd, NULL); // The least recently served objects are evicted first
+	return true;
+}
+
+/**
+ * Creates temporary file in the store where the output is captured.
+ * @param tempName Name of the created file.
+ * @return Descriptor of the file, -1 on failure.
+ */
+int MemoCache::createTemp(string &tempName) {
+	string dir = getDir();
+	if (!makeDirs(dir + "/objects") || !makeDirs(dir + "/keys")) {
+		return -1;
+	}
+
+	tempName = dir + "/objects/.tmp-XXXXXX";
+	int fd = mkostemp(&tempName[0], O_CLOEXEC);
+	if (fd == -1) {
+		perror("Failed to create memo output - mkostemp()");
+	}
+	return fd;
+}
+
+/**
+ * Stores captured output under its content hash and the key pointing
+ * to it. The descriptor is closed.
+ * @param key Hash of the command and of everything its output depends on.
+ * @param fd Temporary file with the output.
+ * @param tempName Name of the temporary file.
+ * @param status Exit status of the command.
+ * @return True on success.
+ */
+bool MemoCache::store(uint64_t key, int fd, const string &tempName,
+		int status) {
+	uint64_t content = hash("");
+	char data[64 * 1024];
+	ssize_t count;
+	off_t offset = 0;
+	while ((count = pread(fd, data, sizeof(data), offset)) > 0
+			|| (count == -1 && errno == EINTR)) {
+		if (count > 0) {
+			content = hash(content, string(data, count));
+			offset += count;
+		}
+	}
+	close(fd);
+	if (count == -1) {
+		perror("Failed to read memo output - pread()");
+		unlink(tempName.c_str());
+		return false;
+	}
+
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), "-%ld", (long) offset);
+	string object = hex(content) + suffix;
+	string path = getDir() + "/objects/" + object;
+
+	pthread_mutex_lock(&mutex);
+	bool added = access(path.c_str(), F_OK) != 0;
+	if (!added) { // The same output is stored once
+		unlink(tempName.c_str());
+	} else if (rename(tempName.c_str(), path.c_str()) == -1) {
+		perror("Failed to store memo output - rename()");
+		unlink(tempName.c_str());
+		pthread_mutex_unlock(&mutex);
+		return false;
+	}
+	bool stored = writeKey(key, object, status);
+
+	if (storeSize < 0) {
+		storeSize = scan(false);
+	} else if (added) {
+		storeSize += offset;
+	}
+	if (storeSize > MAX_SIZE) {
+		storeSize = scan(true);
+	}
+	pthread_mutex_unlock(&mutex);
+
+	return stored;
+}
+
+/**
+ * Removes temporary file of the output which is not stored.
+ */
+void MemoCache::discard(int fd, const string &tempName) {
+	close(fd);
+	unlink(tempName.c_str());
+}
+
+/**
+ * Returns bytes of the objects in the store.
+ */
+off_t MemoCache::size() {
+	pthread_mutex_lock(&mutex);
+	if (storeSize < 0) {
+		storeSize = scan(false);
+	}
+	off_t result = storeSize;
+	pthread_mutex_unlock(&mutex);
+	return result;
+}
+
+/**
+ * Removes all keys and objects of the store.
+ * @return True on success.
+ */
+bool MemoCache::clear() {
+	string dir = getDir();
+	const char *subdirs[] = { "/keys", "/objects" };
+	bool cleared = true;
+
+	pthread_mutex_lock(&mutex);
+	for (size_t i = 0; i < sizeof(subdirs) / sizeof(subdirs[0]); i++) {
+		string subdir = dir + subdirs[i];
+		DIR *entries = opendir(subdir.c_str());
+		if (entries == NULL) {
+			continue;
+		}
+		struct dirent *entry;
+		while ((entry = readdir(entries)) != NULL) {
+			if (strcmp(entry->d_name, ".") != 0
+					&& strcmp(entry->d_name, "..") != 0
+					&& unlinkat(dirfd(entries), entry->d_name, 0) == -1) {
+				cleared = false;
+			}
+		}
+		closedir(entries);
+	}
+	storeSize = -1;
+	pthread_mutex_unlock(&mutex);
+
+	if (!cleared) {
+		perror("Failed to clear memo store - unlinkat()");
+	}
+	return cleared;
+}
+
+/**
+ * Creates directory and its parents.
+ * @return True if the directory exists.
+ */
+bool MemoCache::makeDirs(const string &dir) {
+	for (size_t end = dir.find('/', 1); ; end = dir.find('/', end + 1)) {
+		string parent = dir.substr(0, end);
+		if (mkdir(parent.c_str(), 0700) == -1 && errno != EEXIST) {
+			perror(("Failed to create memo store " + parent + " - mkdir()").c_str());
+			return false;
+		}
+		if (end == string::npos) {
+			return true;
+		}
+	}
+}
+
+/**
+ * Sums sizes of the objects. Eviction removes the least recently served
+ * objects until the store shrinks to 3/4 of MAX_SIZE, so it does not run
+ * at every store, and the keys pointing to them. Must be called with
+ * the mutex locked.
+ * @param evict Whether the objects are evicted.
+ * @return Bytes of the remaining objects.
+ */
+off_t MemoCache::scan(bool evict) {
+	string dir = getDir();
+	DIR *objects = opendir((dir + "/objects").c_str());
+	if (objects == NULL) {
+		return 0;
+	}
+
+	vector<pair<pair<time_t, long>, pair<string, off_t> > > found;
+	off_t total = 0;
+	time_t current = time(NULL);
+	struct dirent *entry;
+	struct stat st;
+	while ((entry = readdir(objects)) != NULL) {
+		if (entry->d_name[0] == '.') { // Temporary output
+			if (evict && strncmp(entry->d_name, ".tmp-", 5) == 0
+					&& fstatat(dirfd(objects), entry->d_name, &st, 0) == 0
+					&& st.st_mtime + STALE_TEMP_AGE < current) {
+				unlinkat(dirfd(objects), entry->d_name, 0);
+			}
+		} else if (fstatat(dirfd(objects), entry->d_name, &st, 0) == 0) {
+			found.push_back(
+					make_pair(make_pair(st.st_mtim.tv_sec, st.st_mtim.tv_nsec),
+							make_pair(string(entry->d_name), st.st_size)));
+			total += st.st_size;
+		}
+	}
+
+	set<string> evicted;
+	if (evict && total > MAX_SIZE) {
+		sort(found.begin(), found.end());
+		for (size_t i = 0; i < found.size() && total > MAX_SIZE / 4 * 3; i++) {
+			if (unlinkat(dirfd(objects), found[i].second.first.c_str(), 0)
+					== 0) {
+				evicted.insert(found[i].second.first);
+				total -= found[i].second.second;
+			}
+		}
+	}
+	closedir(objects);
+
+	DIR *keys = evicted.empty() ? NULL : opendir((dir + "/keys").c_str());
+	while (keys != NULL && (entry = readdir(keys)) != NULL) {
+		int keyFd = openat(dirfd(keys), entry->d_name, O_RDONLY | O_CLOEXEC);
+		char record[128], object[64];
+		ssize_t count = (keyFd != -1) ? read(keyFd, record, sizeof(record) - 1) : -1;
+		if (keyFd != -1) {
+			close(keyFd);
+		}
+		record[(count > 0) ? count : 0] = '\0';
+		if (sscanf(record, "%63s", object) == 1 && evicted.count(object) > 0) {
+			unlinkat(dirfd(keys), entry->d_name, 0);
+		}
+	}
+	if (keys != NULL) {
+		closedir(keys);
+	}
+
+	return total;
+}
+
+/**
+ * Writes the key, it is replaced by rename, so readers see either the old
+ * or the new record.
+ * @param key Hash of the command.
+ * @param object Name of the object with the output.
+ * @param status Exit status of the command.
+ * @return True on success.
+ */
+bool MemoCache::writeKey(uint64_t key, const string &object, int status) {
+	string dir = getDir() + "/keys/";
+	string tempName = dir + ".tmp-XXXXXX";
+	int fd = mkostemp(&tempName[0], O_CLOEXEC);
+	if (fd == -1) {
+		perror("Failed to create memo key - mkostemp()");
+		return false;
+	}
+
+	char record[128];
+	int length = snprintf(record, sizeof(record), "%s %d\n", object.c_str(),
+			status);
+	bool written = write(fd, record, length) == length;
+	close(fd);
+	if (!written || rename(tempName.c_str(), (dir + hex(key)).c_str()) == -1) {
+		perror("Failed to store memo key");
+		unlink(tempName.c_str());
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Formats the value as 16 hexadecimal digits.
+ */
+string MemoCache::hex(uint64_t value) {
+	char digits[17];
+	snprintf(digits, sizeof(digits), "%08lx%08lx",
+			(unsigned long) (value >> 32), (unsigned long) (value & 0xffffffffUL));
+	return digits;
+}
@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       MemoCache.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines on-disk cache of the output
+//             of memoized commands.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file MemoCache.h
+ *
+ * @brief Header file which defines on-disk cache of the output of memoized
+ *        commands.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef MEMOCACHE_H_INCLUDED
+#define MEMOCACHE_H_INCLUDED
+
+#include <string>
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+using namespace std;
+
+/**
+ * Content addressed store of the output of the commands run by the memo
+ * builtin, shared by all shells of the user:
+ *  DIR/objects/HASH-SIZE  output of the command, named by its content
+ *  DIR/keys/KEY           name of the object and exit status
+ * KEY is hash of everything the output depends on, the same output of
+ * different commands is stored once. Objects are replaced by rename, so
+ * readers never see a partial one. When the store grows over MAX_SIZE,
+ * the least recently served objects are removed.
+ */
+class MemoCache {
+public:
+	static const off_t MAX_SIZE = 64 * 1024 * 1024; /**< bytes of objects */
+
+	static uint64_t hash(uint64_t seed, const string &data);
+	static uint64_t hash(const string &data);
+
+	static bool lookup(uint64_t key, int &fd, int &status);
+	static int createTemp(string &tempName);
+	static bool store(uint64_t key, int fd, const string &tempName,
+			int status);
+	static void discard(int fd, const string &tempName);
+
+	static string getDir();
+	static off_t size();
+	static bool clear();
+private:
+	static pthread_mutex_t mutex;
+	static off_t storeSize; /**< bytes of objects, -1 until scanned */
+
+	static bool makeDirs(const string &dir);
+	static off_t scan(bool evict);
+	static bool writeKey(uint64_t key, const string &object, int status);
+	static string hex(uint64_t value);
+};
+
+#endif // MEMOCACHE_H_INCLUDED
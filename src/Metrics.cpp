@@ -0,0 +1,273 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       Metrics.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements runtime counters and latency
+//             histograms of the shell.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Metrics.cpp
+ *
+ * @brief Source file which implements runtime counters and latency
+ *        histograms of the shell.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "Metrics.h"
+
+using namespace std;
+
+/**
+ * Upper bounds of the histogram buckets in seconds, the last bucket is +Inf.
+ */
+const double Metrics::BUCKET_BOUNDS[BUCKET_COUNT - 1] = { 0.00001, 0.00005,
+		0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1, 5, 10 };
+
+__thread Metrics::Shard *Metrics::localShard = NULL;
+vector<Metrics::Shard *> Metrics::shards;
+vector<Metrics::Shard *> Metrics::freeShards;
+pthread_mutex_t Metrics::shardsMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_key_t Metrics::shardKey;
+pthread_once_t Metrics::shardKeyOnce = PTHREAD_ONCE_INIT;
+struct timespec Metrics::queuedAt = { 0, 0 };
+
+/**
+ * Names, types and descriptions of the counters.
+ */
+static const char * const COUNTER_NAMES[][2] = {
+		{ "shell_commands_parsed_total", "Number of parsed commands." },
+		{ "shell_parse_failures_total", "Number of invalid command lines." },
+		{ "shell_exec_failures_total",
+				"Number of commands which could not be executed." },
+		{ "shell_memo_hits_total",
+				"Number of memoized commands served from the cache." },
+		{ "shell_memo_misses_total",
+				"Number of memoized commands which have been run." },
+		{ "shell_memo_served_bytes_total",
+				"Bytes of output served from the cache of memoized commands." } };
+
+/**
+ * Names and descriptions of the histograms.
+ */
+static const char * const HISTOGRAM_NAMES[][2] = {
+		{ "shell_spawn_latency_seconds", "Time spent by forking of the child." },
+		{ "shell_queue_latency_seconds",
+				"Time from queueing of the line by reader to its pickup by executor." },
+		{ "shell_command_duration_seconds", "Wall time of the commands." } };
+
+/**
+ * Returns shard of the calling thread, shard of a finished thread is reused,
+ * new one is registered only when there is none.
+ */
+Metrics::Shard *Metrics::shard() {
+	if (localShard == NULL) {
+		pthread_once(&shardKeyOnce, createShardKey);
+
+		pthread_mutex_lock(&shardsMutex);
+		Shard *taken;
+		if (!freeShards.empty()) {
+			taken = freeShards.back();
+			freeShards.pop_back();
+		} else {
+			taken = new Shard;
+			memset(taken, 0, sizeof(Shard));
+			shards.push_back(taken);
+		}
+		pthread_mutex_unlock(&shardsMutex);
+
+		pthread_setspecific(shardKey, taken);
+		localShard = taken;
+	}
+	return localShard;
+}
+
+/**
+ * Creates key whose destructor releases the shard of the finishing thread.
+ */
+void Metrics::createShardKey() {
+	pthread_key_create(&shardKey, releaseShard);
+}
+
+/**
+ * Returns shard of the finished thread to the free shards, its values stay
+ * in the sums.
+ * @param shard Shard of the thread.
+ */
+void Metrics::releaseShard(void *shard) {
+	pthread_mutex_lock(&shardsMutex);
+	freeShards.push_back(static_cast<Shard *>(shard));
+	pthread_mutex_unlock(&shardsMutex);
+}
+
+/**
+ * Adds to the value of the shard, only the owning thread writes it,
+ * so plain store which is not torn for readers is sufficient.
+ */
+void Metrics::add(uint64_t &value, uint64_t delta) {
+	__atomic_store_n(&value, __atomic_load_n(&value, __ATOMIC_RELAXED) + delta,
+			__ATOMIC_RELAXED);
+}
+
+/**
+ * Increments counter.
+ * @param counter Counter to be incremented.
+ * @param delta Added value.
+ */
+void Metrics::increment(Counter counter, uint64_t delta) {
+	add(shard()->counters[counter], delta);
+}
+
+/**
+ * Returns sum of the counter of all shards.
+ */
+uint64_t Metrics::total(Counter counter) {
+	uint64_t sum = 0;
+	pthread_mutex_lock(&shardsMutex);
+	for (size_t s = 0; s < shards.size(); s++) {
+		sum += __atomic_load_n(&shards[s]->counters[counter], __ATOMIC_RELAXED);
+	}
+	pthread_mutex_unlock(&shardsMutex);
+	return sum;
+}
+
+/**
+ * Records one observation into the histogram.
+ * @param histogram Histogram to be updated.
+ * @param seconds Observed latency.
+ */
+void Metrics::observe(Histogram histogram, double seconds) {
+	Shard *local = shard();
+
+	int bucket = 0;
+	while (bucket < BUCKET_COUNT - 1 && seconds > BUCKET_BOUNDS[bucket]) {
+		bucket++;
+	}
+
+	add(local->buckets[histogram][bucket], 1);
+	add(local->sumNanos[histogram], (uint64_t) (seconds * 1e9));
+}
+
+/**
+ * Records time elapsed since start into the histogram.
+ */
+void Metrics::observeSince(Histogram histogram, const struct timespec &start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	observe(histogram,
+			(now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9);
+}
+
+/**
+ * Marks time when the reader put line into buffer.
+ * Must be called inside of the buffer monitor.
+ */
+void Metrics::lineQueued() {
+	clock_gettime(CLOCK_MONOTONIC, &queuedAt);
+}
+
+/**
+ * Records latency of the line taken by the executor.
+ * Must be called inside of the buffer monitor.
+ */
+void Metrics::linePicked() {
+	if (queuedAt.tv_sec != 0 || queuedAt.tv_nsec != 0) {
+		observeSince(QUEUE_LATENCY, queuedAt);
+		queuedAt.tv_sec = queuedAt.tv_nsec = 0;
+	}
+}
+
+/**
+ * Formats sum of all shards in Prometheus text exposition format.
+ */
+string Metrics::format() {
+	uint64_t counters[COUNTER_COUNT] = { 0 };
+	uint64_t buckets[HISTOGRAM_COUNT][BUCKET_COUNT];
+	uint64_t sumNanos[HISTOGRAM_COUNT] = { 0 };
+	memset(buckets, 0, sizeof(buckets));
+
+	pthread_mutex_lock(&shardsMutex);
+	for (size_t s = 0; s < shards.size(); s++) {
+		for (int c = 0; c < COUNTER_COUNT; c++) {
+			counters[c] += __atomic_load_n(&shards[s]->counters[c],
+					__ATOMIC_RELAXED);
+		}
+		for (int h = 0; h < HISTOGRAM_COUNT; h++) {
+			for (int b = 0; b < BUCKET_COUNT; b++) {
+				buckets[h][b] += __atomic_load_n(&shards[s]->buckets[h][b],
+						__ATOMIC_RELAXED);
+			}
+			sumNanos[h] += __atomic_load_n(&shards[s]->sumNanos[h],
+					__ATOMIC_RELAXED);
+		}
+	}
+	pthread_mutex_unlock(&shardsMutex);
+
+	string out;
+	char line[256];
+
+	for (int c = 0; c < COUNTER_COUNT; c++) {
+		snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s counter\n%s %lu\n",
+				COUNTER_NAMES[c][0], COUNTER_NAMES[c][1], COUNTER_NAMES[c][0],
+				COUNTER_NAMES[c][0], (unsigned long) counters[c]);
+		out += line;
+	}
+
+	for (int h = 0; h < HISTOGRAM_COUNT; h++) {
+		const char *name = HISTOGRAM_NAMES[h][0];
+		snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s histogram\n",
+				name, HISTOGRAM_NAMES[h][1], name);
+		out += line;
+
+		uint64_t cumulative = 0;
+		for (int b = 0; b < BUCKET_COUNT; b++) {
+			cumulative += buckets[h][b];
+			if (b < BUCKET_COUNT - 1) {
+				snprintf(line, sizeof(line), "%s_bucket{le=\"%g\"} %lu\n", name,
+						BUCKET_BOUNDS[b], (unsigned long) cumulative);
+			} else {
+				snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %lu\n",
+						name, (unsigned long) cumulative);
+			}
+			out += line;
+		}
+
+		snprintf(line, sizeof(line), "%s_sum %.9f\n%s_count %lu\n", name,
+				sumNanos[h] / 1e9, name, (unsigned long) cumulative);
+		out += line;
+	}
+
+	return out;
+}
+
+/**
+ * Writes metrics into file, file is replaced atomically, so collectors
+ * never read partially written file.
+ * @param fileName Name of the file.
+ * @return True on success, false on failure.
+ */
+bool Metrics::writeFile(const string &fileName) {
+	string tmpName = fileName + ".tmp";
+	FILE *file = fopen(tmpName.c_str(), "we");
+	if (file == NULL) {
+		perror("Failed to write metrics - fopen()");
+		return false;
+	}
+
+	string text = format();
+	bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+	written = (fclose(file) == 0) && written;
+
+	if (!written || rename(tmpName.c_str(), fileName.c_str()) != 0) {
+		perror("Failed to write metrics - rename()");
+		return false;
+	}
+	return true;
+}
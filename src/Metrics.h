@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       Metrics.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines runtime counters and latency
+//             histograms of the shell.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Metrics.h
+ *
+ * @brief Header file which defines runtime counters and latency histograms
+ *        of the shell.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef METRICS_H_INCLUDED
+#define METRICS_H_INCLUDED
+
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Counters and histograms of the hot path. Every thread updates only its own
+ * shard without locks, shards are summed when metrics are formatted. Shard
+ * of the finished thread keeps its values and is taken by the next new
+ * thread, so short-lived threads do not add shards.
+ */
+class Metrics {
+public:
+	enum Counter {
+		COMMANDS_PARSED,
+		PARSE_FAILURES,
+		EXEC_FAILURES,
+		MEMO_HITS,
+		MEMO_MISSES,
+		MEMO_SERVED_BYTES,
+		COUNTER_COUNT
+	};
+
+	enum Histogram {
+		SPAWN_LATENCY, QUEUE_LATENCY, COMMAND_DURATION, HISTOGRAM_COUNT
+	};
+
+	static void increment(Counter counter, uint64_t delta = 1);
+	static uint64_t total(Counter counter);
+	static void observe(Histogram histogram, double seconds);
+	static void observeSince(Histogram histogram,
+			const struct timespec &start);
+
+	static void lineQueued();
+	static void linePicked();
+
+	static string format();
+	static bool writeFile(const string &fileName);
+private:
+	static const int BUCKET_COUNT = 14;
+	static const double BUCKET_BOUNDS[BUCKET_COUNT - 1];
+
+	/**
+	 * Metrics of one thread, only the owning thread writes into it.
+	 */
+	typedef struct {
+		uint64_t counters[COUNTER_COUNT];
+		uint64_t buckets[HISTOGRAM_COUNT][BUCKET_COUNT];
+		uint64_t sumNanos[HISTOGRAM_COUNT];
+	} Shard;
+
+	static __thread Shard *localShard;
+	static vector<Shard *> shards;
+	static vector<Shard *> freeShards; /**< of the finished threads */
+	static pthread_mutex_t shardsMutex;
+	static pthread_key_t shardKey; /**< releases shard when thread finishes */
+	static pthread_once_t shardKeyOnce;
+	static struct timespec queuedAt;
+
+	static Shard *shard();
+	static void createShardKey();
+	static void releaseShard(void *shard);
+	static void add(uint64_t &value, uint64_t delta);
+};
+
+#endif // METRICS_H_INCLUDED
@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       MetricsWriterPThread.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Implements thread which periodically writes metrics into
+//             the file.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file MetricsWriterPThread.cpp
+ *
+ * @brief Implements thread which periodically writes metrics into the file.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <signal.h>
+
+#include "Metrics.h"
+#include "MetricsWriterPThread.h"
+
+using namespace std;
+
+/**
+ * Sets file and period of writing.
+ * @param fileName Name of the file where metrics are written.
+ * @param interval Seconds between two writes.
+ */
+void MetricsWriterPThread::configure(const string &fileName, int interval) {
+	this->fileName = fileName;
+	this->interval = (interval > 0) ? interval : DEFAULT_INTERVAL;
+}
+
+/**
+ * Main body of the writer.
+ * @return Exit code of this thread.
+ */
+int MetricsWriterPThread::run() {
+	do {
+		Metrics::writeFile(fileName);
+	} while (sleepFor(interval * 1000L));
+
+	return 0;
+}
+
+/**
+ * Writes the final values when the thread is finished.
+ */
+void MetricsWriterPThread::onFinish() {
+	Metrics::writeFile(fileName);
+}
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       MetricsWriterPThread.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines the thread which periodically writes
+//             metrics into the file.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file MetricsWriterPThread.h
+ *
+ * @brief Header file which defines the thread which periodically writes
+ *        metrics into the file.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef METRICSWRITERPTHREAD_H_INCLUDED
+#define METRICSWRITERPTHREAD_H_INCLUDED
+
+#include <string>
+
+#include "PThread.h"
+
+using namespace std;
+
+/**
+ * Thread which writes metrics in Prometheus text format, so they can be
+ * collected by the textfile collector of node-exporter.
+ */
+class MetricsWriterPThread: public PThread {
+public:
+	MetricsWriterPThread() :
+			interval(DEFAULT_INTERVAL) {
+	}
+	virtual ~MetricsWriterPThread() {
+		cancel();
+	}
+	virtual int run();
+	void configure(const string &fileName, int interval);
+
+	static const int DEFAULT_INTERVAL = 10;
+private:
+	string fileName;
+	int interval; /**< seconds between two writes */
+
+	virtual void onFinish();
+};
+
+#endif // METRICSWRITERPTHREAD_H_INCLUDED
@@ -14,6 +14,12 @@
  * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
  */
 
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <time.h>
+#include <unistd.h>
+
 #include "PThread.h"
 
 using namespace std;
@@ -23,25 +29,30 @@ using namespace std;
  */
 UniqueIDGenerator PThread::idGenerator;
 
+bool PThread::anyPinned = false;
+cpu_set_t PThread::unpinnedCpus;
+
 /**
- * Constructor.
+ * Constructor, the thread is created by start().
  */
 PThread::PThread() :
-		threadInitialized(false), threadRunning(false), retCode(0) {
+		threadCreated(false), threadRunning(false), retCode(0), stackSize(
+				DEFAULT_STACK_SIZE), pinned(false), stopRequested(0), joined(
+				false), stopping(startMonitor, "stopping") {
 	id = idGenerator.generate() + 1;
 
-	if (pthread_create(&thread, NULL, &threadInitPrivate,
-			reinterpret_cast<void *>(this)) != 0) {
-		throw PThreadCreate();
-	}
+	char name[32];
+	snprintf(name, sizeof(name), "thread%d.start", (int) id);
+	startMonitor.setName(name);
 }
 
 /**
- * Destructor.
+ * Destructor, thread which has not been started is stopped here. Running
+ * thread has to be cancelled by the destructor of the derived class, so its
+ * wakeUp() is still available.
  */
 PThread::~PThread() {
 	cancel();
-	pthread_detach(thread);
 }
 
 /**
@@ -51,75 +62,183 @@ PThread::~PThread() {
 void *PThread::threadInitPrivate(void *_obj) {
 	PThread *obj = reinterpret_cast<PThread *>(_obj);
 
-	/* Setting up finalization callback & disable assynchronous cancellation. */
-
-	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-	pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, NULL);
-	pthread_cleanup_push(obj->onFinishPrivate, _obj);
+	obj->onStart();
+	obj->retCode = obj->run();
+	onFinishPrivate(obj);
 
-	/* Now we are going to wait until start() is called. */
+	return NULL;
+}
 
-	obj->initMonitor.enter();
-	obj->threadInitialized = true;
-	obj->initMonitor.signal();
-	obj->initMonitor.exit();
+/**
+ * Sets size of the stack, must be called before start().
+ * @param size Size of the stack in bytes.
+ */
+void PThread::setStackSize(size_t size) {
+	stackSize = size;
+}
 
-	obj->runningMonitor.enter();
-	while (!obj->threadRunning) { // Cycle until start() is not called
-		obj->runningMonitor.wait();
+/**
+ * Creates the thread and starts running of its code, thread whose stop
+ * has been requested already starts too and its run() returns at once.
+ */
+void PThread::start() {
+	startMonitor.enter();
+	if (threadCreated) {
+		startMonitor.exit();
+		return;
 	}
-	obj->runningMonitor.exit();
-
-	/* Start running of the code of this thread. */
 
-	obj->onStart();
-	obj->retCode = obj->run();
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	size_t size = (stackSize > (size_t) PTHREAD_STACK_MIN) ? stackSize
+			: (size_t) PTHREAD_STACK_MIN;
+	pthread_attr_setstacksize(&attr, size);
+	if (pinned) {
+		pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+	} else if (anyPinned) { // Not inherited from the pinned thread
+		pthread_attr_setaffinity_np(&attr, sizeof(unpinnedCpus), &unpinnedCpus);
+	}
 
-	/* Running ended, finalize this thread. */
+	/* Children are reaped by the execute thread waiting for the line,
+	 * the new thread inherits the blocked SIGCHLD */
+	sigset_t oldmask;
+	blockChildSignal(&oldmask);
+	threadRunning = true;
+	int ret = pthread_create(&thread, &attr, &threadInitPrivate,
+			reinterpret_cast<void *>(this));
+	pthread_sigmask(SIG_SETMASK, &oldmask, NULL);
+	pthread_attr_destroy(&attr);
+	threadCreated = (ret == 0);
+	threadRunning = threadCreated;
+	startMonitor.exit();
+
+	if (!threadCreated) {
+		throw PThreadCreate();
+	}
+}
 
-	onFinishPrivate(obj);
-	pthread_cleanup_pop(0);
-	pthread_exit(NULL);
+/**
+ * Pins the thread to the CPUs, must be called before start() by the thread
+ * which has not been pinned. Threads and children started by the pinned
+ * thread get CPUs of the process instead.
+ * @param cpus CPUs of the thread.
+ */
+void PThread::pin(const cpu_set_t &cpus) {
+	if (!anyPinned
+			&& sched_getaffinity(0, sizeof(unpinnedCpus), &unpinnedCpus) == 0) {
+		anyPinned = true;
+	}
+	this->cpus = cpus;
+	pinned = true;
 }
 
 /**
- * Starts running of this thread.
+ * Returns CPUs of the process before any thread has been pinned.
+ * @param cpus Set to the CPUs.
+ * @return False when no thread is pinned, so nothing has to be restored.
  */
-void PThread::start() {
-	initMonitor.enter();
-	if (!threadInitialized) {
-		initMonitor.wait();
+bool PThread::getUnpinnedCpus(cpu_set_t &cpus) {
+	if (anyPinned) {
+		cpus = unpinnedCpus;
 	}
-	initMonitor.exit();
+	return anyPinned;
+}
 
-	runningMonitor.enter();
-	threadRunning = true;
-	runningMonitor.signal();
-	runningMonitor.exit();
+/**
+ * Blocks SIGCHLD in the calling thread, so it is not taken by the handler
+ * of the execute thread meanwhile.
+ * @param oldmask Set to the previous mask, NULL when it is not restored.
+ */
+void PThread::blockChildSignal(sigset_t *oldmask) {
+	sigset_t mask;
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	pthread_sigmask(SIG_BLOCK, &mask, oldmask);
 }
 
 /**
- * Waits until thread is finished.
+ * Unblocks SIGCHLD in the calling thread, so the pending and next signals
+ * are served by its handler.
+ * @param oldmask Set to the previous mask, NULL when it is not restored.
+ */
+void PThread::unblockChildSignal(sigset_t *oldmask) {
+	sigset_t mask;
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	pthread_sigmask(SIG_UNBLOCK, &mask, oldmask);
+}
+
+/**
+ * Waits until thread is finished, only the owner of the thread joins it.
  */
 void PThread::join() {
-	pthread_join(thread, NULL);
+	if (threadCreated && !joined) {
+		pthread_join(thread, NULL);
+		joined = true;
+	}
 }
 
 /**
- * Sends cancellation demand to this thread.
- * This request will be served on the next cancelation point.
+ * Stops this thread and waits until it is finished.
  */
 void PThread::cancel() {
-	int _running;
+	requestStop();
+	join();
+}
+
+/**
+ * Sets the stop token and wakes up the thread, does not wait for it.
+ * The thread finishes when it tests the token the next time.
+ */
+void PThread::requestStop() {
+	__atomic_store_n(&stopRequested, 1, __ATOMIC_RELEASE);
+
+	startMonitor.enter();
+	stopping.broadcast();
+	startMonitor.exit();
+
+	wakeUp();
+}
 
-	runningMonitor.enter();
-	_running = threadRunning;
-	runningMonitor.exit();
+/**
+ * Tests whether stop of this thread has been requested.
+ */
+bool PThread::isStopRequested() const {
+	return __atomic_load_n(&stopRequested, __ATOMIC_ACQUIRE) != 0;
+}
 
-	if (_running) {
-		pthread_cancel(thread);
-		join();
+/**
+ * Sleeps until the time elapses or stop is requested.
+ * @param millis Milliseconds to sleep.
+ * @return False if stop has been requested.
+ */
+bool PThread::sleepFor(long millis) {
+	struct timespec deadline, now, left;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += millis / 1000;
+	deadline.tv_nsec += (millis % 1000) * 1000000;
+	if (deadline.tv_nsec >= 1000000000) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000;
 	}
+
+	startMonitor.enter();
+	while (!isStopRequested()) {
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		left.tv_sec = deadline.tv_sec - now.tv_sec;
+		left.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+		if (left.tv_nsec < 0) {
+			left.tv_sec--;
+			left.tv_nsec += 1000000000;
+		}
+		if (left.tv_sec < 0) {
+			break;
+		}
+		stopping.timedWait(left);
+	}
+	startMonitor.exit();
+
+	return !isStopRequested();
 }
 
 /**
@@ -147,96 +266,412 @@ int PThread::getRetCode() {
 }
 
 /**
- * Test whether has not been demanded cancellation of this thread.
+ * Returns completion which signals the end of this thread, its result
+ * is the return code of run().
  */
-void PThread::cancelPoint() {
-	pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-	pthread_testcancel();
-	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+Completion &PThread::getCompletion() {
+	return completion;
 }
 
 /**
- * Fires callback functions which signals the end of this threads.
+ * Method is called for finalization of thread's run.
  */
-void PThread::fireFinishCallbacks() {
-	set<OnFinishCallback>::iterator clbk_iter;
-	for (clbk_iter = onFinishCallbacks.begin();
-			clbk_iter != onFinishCallbacks.end(); ++clbk_iter) {
-		(**clbk_iter)();
-	}
+void PThread::onFinishPrivate(PThread *obj) {
+	obj->startMonitor.enter();
+	obj->threadRunning = false;
+	obj->startMonitor.exit();
+
+	obj->onFinish();
+	obj->completion.finish(obj->retCode);
 }
 
 /**
- * Adds new callback for signaling finish of this thread.
+ * Constructor of unfinished completion.
  */
-void PThread::addOnFinishCallback(OnFinishCallback callback) {
-	onFinishCallbacks.insert(callback);
+Completion::Completion() :
+		monitor("completion"), finished(monitor, "finished"), finishing(
+				false), done(false), result(0) {
 }
 
 /**
- * Removes callback for signaling finish of this thread.
+ * Registers callback which is called when the completion finishes.
+ * @param callback Function called with the result.
+ * @param arg Argument passed to the callback.
  */
-void PThread::removeOnFinishCallback(OnFinishCallback callback) {
-	onFinishCallbacks.erase(callback);
+void Completion::addCallback(Callback callback, void *arg) {
+	monitor.enter();
+	bool late = finishing || done;
+	if (!late) {
+		callbacks.push_back(make_pair(callback, arg));
+	}
+	monitor.exit();
+
+	if (late) {
+		callback(result, arg);
+	}
 }
 
 /**
- * Method is called for finalization of thread's run.
+ * Finishes the completion, calls callbacks and wakes up waiting threads.
+ * Completion can be destroyed by the woken up thread, so it is not touched
+ * after it is marked as done.
+ * @param result Result of the thread or the task.
  */
-void PThread::onFinishPrivate(void *_obj) {
-	PThread *obj = reinterpret_cast<PThread *>(_obj);
+void Completion::finish(int result) {
+	monitor.enter();
+	this->result = result;
+	finishing = true;
+	vector<pair<Callback, void *> > pending;
+	pending.swap(callbacks);
+	monitor.exit();
+
+	for (size_t i = 0; i < pending.size(); i++) {
+		pending[i].first(result, pending[i].second);
+	}
 
-	obj->runningMonitor.enter();
-	obj->threadRunning = false;
-	obj->runningMonitor.exit();
+	monitor.enter();
+	done = true;
+	finished.broadcast();
+	monitor.exit();
+}
 
-	obj->initMonitor.exit();
+/**
+ * Tests whether the completion has finished and its callbacks returned.
+ */
+bool Completion::isFinished() {
+	monitor.enter();
+	bool finished = done;
+	monitor.exit();
+	return finished;
+}
 
-	obj->onFinish();
-	obj->fireFinishCallbacks();
+/**
+ * Waits until the completion finishes.
+ * @return Result of the thread or the task.
+ */
+int Completion::wait() {
+	monitor.enter();
+	while (!done) {
+		finished.wait();
+	}
+	int result = this->result;
+	monitor.exit();
+	return result;
 }
 
+volatile bool PThreadMonitor::instrumented = false;
+vector<PThreadMonitor *> PThreadMonitor::monitors;
+pthread_mutex_t PThreadMonitor::monitorsMutex = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * Constructor of the new monitor.
+ * @param name Name of the monitor shown in the statistics.
  */
-PThreadMonitor::PThreadMonitor() {
-	pthread_mutex_init(&monMutex, NULL);
-	pthread_cond_init(&monCond, NULL);
+PThreadMonitor::PThreadMonitor(const string &name) :
+		name(name) {
+	pthread_mutex_init(&mutex, NULL);
+	registerPrivate();
+}
+
+/**
+ * Copy constructor, creates new monitor with the same name.
+ */
+PThreadMonitor::PThreadMonitor(const PThreadMonitor &monitor) :
+		name(monitor.name) {
+	pthread_mutex_init(&mutex, NULL);
+	registerPrivate();
 }
 
 /**
  * Destructor of the monitor.
  */
 PThreadMonitor::~PThreadMonitor() {
-	pthread_mutex_destroy(&monMutex);
-	pthread_cond_destroy(&monCond);
+	pthread_mutex_lock(&monitorsMutex);
+	for (size_t i = 0; i < monitors.size(); i++) {
+		if (monitors[i] == this) {
+			monitors.erase(monitors.begin() + i);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&monitorsMutex);
+	pthread_mutex_destroy(&mutex);
+}
+
+/**
+ * Clears statistics and registers monitor, so it is listed by dump().
+ */
+void PThreadMonitor::registerPrivate() {
+	memset(&stats, 0, sizeof(stats));
+	acquiredAt = 0;
+	woken = false;
+
+	pthread_mutex_lock(&monitorsMutex);
+	monitors.push_back(this);
+	pthread_mutex_unlock(&monitorsMutex);
+}
+
+/**
+ * Locks mutex of the monitor.
+ * @return True if the monitor has been held by another thread.
+ */
+bool PThreadMonitor::lock() {
+	if (pthread_mutex_trylock(&mutex) == 0) {
+		return false;
+	}
+	pthread_mutex_lock(&mutex);
+	return true;
+}
+
+/**
+ * Unlocks mutex of the monitor.
+ */
+void PThreadMonitor::unlock() {
+	pthread_mutex_unlock(&mutex);
 }
 
 /**
  * Entering into critical section.
  */
 void PThreadMonitor::enter() {
-	pthread_mutex_lock(&monMutex);
+	bool contended = lock();
+	if (instrumented) {
+		acquired(contended);
+	}
 }
 
 /**
  * Exiting the critic section.
  */
 void PThreadMonitor::exit() {
-	pthread_mutex_unlock(&monMutex);
+	released();
+	woken = false;
+	unlock();
+}
+
+/**
+ * Constructor of the condition.
+ * @param monitor Monitor inside of which threads wait on the condition.
+ * @param name Name of the condition.
+ */
+PThreadCondition::PThreadCondition(PThreadMonitor &monitor,
+		const string &name) :
+		monitor(monitor), name(name) {
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&cond, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+/**
+ * Destructor of the condition, nobody may wait on it.
+ */
+PThreadCondition::~PThreadCondition() {
+	pthread_cond_destroy(&cond);
+}
+
+/**
+ * Waiting for signal, must be called inside of the monitor.
+ */
+void PThreadCondition::wait() {
+	uint64_t start = monitor.waitStarted();
+	pthread_cond_wait(&cond, &monitor.mutex);
+	monitor.waitFinished(start);
+}
+
+/**
+ * Waiting for signal at most for the given time, must be called inside
+ * of the monitor.
+ * @param timeout Relative time of the wait.
+ * @return False if the time has elapsed.
+ */
+bool PThreadCondition::timedWait(const struct timespec &timeout) {
+	uint64_t start = monitor.waitStarted();
+
+	struct timespec deadline;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += timeout.tv_sec;
+	deadline.tv_nsec += timeout.tv_nsec;
+	if (deadline.tv_nsec >= 1000000000L) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+	bool timedOut = pthread_cond_timedwait(&cond, &monitor.mutex, &deadline)
+			== ETIMEDOUT;
+
+	monitor.waitFinished(start);
+	return !timedOut;
+}
+
+/**
+ * Wakes up one waiting thread, must be called inside of the monitor.
+ */
+void PThreadCondition::signal() {
+	if (PThreadMonitor::instrumented) {
+		PThreadMonitor::add(monitor.stats.signals, 1);
+	}
+	pthread_cond_signal(&cond);
+}
+
+/**
+ * Wakes up all waiting threads, must be called inside of the monitor.
+ */
+void PThreadCondition::broadcast() {
+	if (PThreadMonitor::instrumented) {
+		PThreadMonitor::add(monitor.stats.signals, 1);
+	}
+	pthread_cond_broadcast(&cond);
+}
+
+/**
+ * Returns name of the condition.
+ */
+const string &PThreadCondition::getName() const {
+	return name;
+}
+
+/**
+ * Sets name of the monitor shown in the statistics.
+ */
+void PThreadMonitor::setName(const string &name) {
+	this->name = name;
+}
+
+/**
+ * Returns name of the monitor.
+ */
+const string &PThreadMonitor::getName() const {
+	return name;
+}
+
+/**
+ * Enables or disables collecting of statistics by all monitors.
+ */
+void PThreadMonitor::setInstrumented(bool instrumented) {
+	PThreadMonitor::instrumented = instrumented;
+}
+
+/**
+ * Tests whether monitors collect statistics.
+ */
+bool PThreadMonitor::isInstrumented() {
+	return instrumented;
 }
 
 /**
- * Signaling all waiting threads.
+ * Returns current time in nanoseconds.
  */
-void PThreadMonitor::signal() {
-	pthread_cond_broadcast(&monCond);
+uint64_t PThreadMonitor::now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
 }
 
 /**
- * Waiting for signal.
+ * Adds to the statistic, only thread inside writes it, but dump() reads
+ * it from other threads.
  */
-void PThreadMonitor::wait() {
-	pthread_cond_wait(&monCond, &monMutex);
+void PThreadMonitor::add(uint64_t &value, uint64_t delta) {
+	__atomic_store_n(&value, __atomic_load_n(&value, __ATOMIC_RELAXED) + delta,
+			__ATOMIC_RELAXED);
 }
 
+/**
+ * Updates maximum of the statistic.
+ */
+void PThreadMonitor::max(uint64_t &value, uint64_t sample) {
+	if (sample > __atomic_load_n(&value, __ATOMIC_RELAXED)) {
+		__atomic_store_n(&value, sample, __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * Records entering of the thread into the monitor.
+ */
+void PThreadMonitor::acquired(bool contended) {
+	add(stats.acquisitions, 1);
+	if (contended) {
+		add(stats.contended, 1);
+	}
+	acquiredAt = now();
+}
+
+/**
+ * Records time for which the thread has held the monitor.
+ */
+void PThreadMonitor::released() {
+	if (acquiredAt != 0) {
+		uint64_t held = now() - acquiredAt;
+		add(stats.holdNanos, held);
+		max(stats.holdMaxNanos, held);
+		acquiredAt = 0;
+	}
+}
+
+/**
+ * Records start of the wait, mutex is released by the wait.
+ * @return Start of the wait or 0 when not measured.
+ */
+uint64_t PThreadMonitor::waitStarted() {
+	if (!instrumented) {
+		woken = false;
+		return 0;
+	}
+
+	released();
+	add(stats.waits, 1);
+	if (woken) { // Previous wakeup did not satisfy condition of the caller
+		add(stats.spurious, 1);
+	}
+	return now();
+}
+
+/**
+ * Records latency of the wait, thread is again inside the monitor.
+ */
+void PThreadMonitor::waitFinished(uint64_t start) {
+	woken = true;
+	if (start != 0) {
+		uint64_t waited = now() - start;
+		add(stats.waitNanos, waited);
+		max(stats.waitMaxNanos, waited);
+		acquiredAt = now();
+	}
+}
+
+/**
+ * Formats statistics of all monitors, one line per monitor.
+ */
+string PThreadMonitor::dump() {
+	string out;
+	char line[512];
+
+	pthread_mutex_lock(&monitorsMutex);
+	for (size_t i = 0; i < monitors.size(); i++) {
+		Stats &s = monitors[i]->stats;
+		uint64_t acquisitions = __atomic_load_n(&s.acquisitions,
+				__ATOMIC_RELAXED);
+		uint64_t waits = __atomic_load_n(&s.waits, __ATOMIC_RELAXED);
+		if (acquisitions == 0 && waits == 0) {
+			continue;
+		}
+
+		snprintf(line, sizeof(line),
+				"monitor=%s acquisitions=%lu contended=%lu hold_total_ms=%.3f "
+						"hold_max_us=%.3f waits=%lu wait_total_ms=%.3f "
+						"wait_max_us=%.3f spurious=%lu signals=%lu\n",
+				monitors[i]->name.c_str(), (unsigned long) acquisitions,
+				(unsigned long) __atomic_load_n(&s.contended, __ATOMIC_RELAXED),
+				__atomic_load_n(&s.holdNanos, __ATOMIC_RELAXED) / 1e6,
+				__atomic_load_n(&s.holdMaxNanos, __ATOMIC_RELAXED) / 1e3,
+				(unsigned long) waits,
+				__atomic_load_n(&s.waitNanos, __ATOMIC_RELAXED) / 1e6,
+				__atomic_load_n(&s.waitMaxNanos, __ATOMIC_RELAXED) / 1e3,
+				(unsigned long) __atomic_load_n(&s.spurious, __ATOMIC_RELAXED),
+				(unsigned long) __atomic_load_n(&s.signals, __ATOMIC_RELAXED));
+		out += line;
+	}
+	pthread_mutex_unlock(&monitorsMutex);
+
+	return out;
+}
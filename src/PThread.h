@@ -18,9 +18,15 @@
 #define PTHREAD_H_INCLUDED
 
 #include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <time.h>
 
 #include <stdexcept>
-#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "UniqueIDGenerator.h"
 
@@ -33,63 +39,188 @@ public:
 	}
 };
 
+/**
+ * Monitor - mutual exclusion of threads. Threads inside wait on conditions
+ * of the monitor, so a signal wakes up only threads waiting for it.
+ * When instrumentation is enabled, every monitor counts its acquisitions,
+ * contention, hold and wait times.
+ */
 class PThreadMonitor {
 public:
-	PThreadMonitor();
+	PThreadMonitor(const string &name = "monitor");
+	PThreadMonitor(const PThreadMonitor &monitor);
 	~PThreadMonitor();
 	void enter();
 	void exit();
-	void signal();
+
+	void setName(const string &name);
+	const string &getName() const;
+
+	static void setInstrumented(bool instrumented);
+	static bool isInstrumented();
+	static string dump();
+private:
+	friend class PThreadCondition;
+
+	/**
+	 * Statistics of the monitor, written only by the thread inside.
+	 */
+	typedef struct {
+		uint64_t acquisitions;
+		uint64_t contended; /**< acquisitions which had to wait for mutex */
+		uint64_t holdNanos;
+		uint64_t holdMaxNanos;
+		uint64_t waits;
+		uint64_t waitNanos;
+		uint64_t waitMaxNanos;
+		uint64_t spurious; /**< wakeups followed by another wait */
+		uint64_t signals;
+	} Stats;
+
+	static uint64_t now();
+	static void add(uint64_t &value, uint64_t delta);
+	static void max(uint64_t &value, uint64_t sample);
+
+	bool lock();
+	void unlock();
+
+	void acquired(bool contended);
+	void released();
+	uint64_t waitStarted();
+	void waitFinished(uint64_t start);
+
+	pthread_mutex_t mutex;
+
+	string name;
+	Stats stats;
+	uint64_t acquiredAt; /**< 0 when not measured */
+	bool woken; /**< thread inside has returned from wait */
+
+	static volatile bool instrumented;
+	static vector<PThreadMonitor *> monitors;
+	static pthread_mutex_t monitorsMutex;
+
+	void registerPrivate();
+	PThreadMonitor &operator=(const PThreadMonitor &);
+};
+
+/**
+ * Condition of the monitor. Threads wait on the condition inside of its
+ * monitor, signal() wakes up only one of them. Spurious wakeups are possible,
+ * so waiting thread has to test its condition in the loop.
+ */
+class PThreadCondition {
+public:
+	PThreadCondition(PThreadMonitor &monitor, const string &name);
+	~PThreadCondition();
 	void wait();
+	bool timedWait(const struct timespec &timeout);
+	void signal();
+	void broadcast();
+
+	const string &getName() const;
 private:
-	pthread_mutex_t monMutex;
-	pthread_cond_t monCond;
+	PThreadMonitor &monitor;
+	string name;
+	pthread_cond_t cond; /**< on monotonic clock */
+
+	PThreadCondition(const PThreadCondition &);
+	PThreadCondition &operator=(const PThreadCondition &);
 };
 
+/**
+ * Completion of the thread or the task. Callbacks are called by the finishing
+ * thread before waiting threads are woken up, callback added after
+ * the completion has finished is called at once.
+ */
+class Completion {
+public:
+	typedef void(*Callback)(int result, void *arg);
+
+	Completion();
+	void addCallback(Callback callback, void *arg);
+	void finish(int result);
+	bool isFinished();
+	int wait();
+private:
+	PThreadMonitor monitor;
+	PThreadCondition finished;
+	bool finishing; /**< callbacks are being called */
+	bool done;
+	int result;
+	vector<pair<Callback, void *> > callbacks;
+
+	Completion(const Completion &);
+	Completion &operator=(const Completion &);
+};
+
+/**
+ * Thread which is created by start(), so the object can be constructed
+ * statically and threads which are never started cost nothing. Stack of the
+ * thread is small, threads which need more set it before start(). Thread is
+ * stopped cooperatively: requestStop() sets the stop token and wakes
+ * the thread up, its run() tests isStopRequested() and returns. Threads
+ * blocked elsewhere than on their own conditions have to override wakeUp().
+ */
 class PThread {
 public:
-	typedef void(*OnFinishCallback)();
+	static const size_t DEFAULT_STACK_SIZE = 256 * 1024;
 
 	PThread();
 	virtual ~PThread();
 
 	virtual void start();
 	virtual void cancel();
+	void requestStop();
+	bool isStopRequested() const;
 	pthread_t getThread();
 	int getID();
 	int getRetCode();
 	void join();
-	void addOnFinishCallback(OnFinishCallback callback);
-	void removeOnFinishCallback(OnFinishCallback callback);
+	Completion &getCompletion();
 
 	virtual int run() = 0;
 
+	void pin(const cpu_set_t &cpus);
+
+	static void blockChildSignal(sigset_t *oldmask);
+	static void unblockChildSignal(sigset_t *oldmask);
+	static bool getUnpinnedCpus(cpu_set_t &cpus);
+
 protected:
 	virtual void onStart() {
 	}
 	virtual void onFinish() {
 	}
+	virtual void wakeUp() {
+	}
 
-	void cancelPoint();
+	bool sleepFor(long millis);
+	void setStackSize(size_t size);
 
-	volatile bool threadInitialized;
+	volatile bool threadCreated;
 	volatile bool threadRunning;
 	volatile int id;
 	int retCode;
 	pthread_t thread;
+	size_t stackSize;
+	bool pinned;
+	cpu_set_t cpus; /**< of the pinned thread */
+	int stopRequested; /**< stop token, accessed atomically */
+	bool joined;
 
-	PThreadMonitor initMonitor;
-	PThreadMonitor runningMonitor;
+	PThreadMonitor startMonitor; /**< guards start and stop of the thread */
+	PThreadCondition stopping; /**< requestStop() has been called */
 
-	set<OnFinishCallback> onFinishCallbacks;
+	Completion completion; /**< finished when run() returns */
 
 private:
 	static UniqueIDGenerator idGenerator;
+	static bool anyPinned;
+	static cpu_set_t unpinnedCpus; /**< of the process before pinning */
 
 	static void *threadInitPrivate(void *thread);
-	static void onFinishPrivate(void *thread);
-
-	void fireFinishCallbacks();
+	static void onFinishPrivate(PThread *thread);
 };
 
 #endif // PTHREAD_H_INCLUDED
@@ -0,0 +1,437 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       PeriodicPThread.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements thread scheduling periodic
+//             commands of the every builtin.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file PeriodicPThread.cpp
+ *
+ * @brief Source file which implements thread scheduling periodic commands
+ *        of the every builtin.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+
+#include "PeriodicPThread.h"
+
+using namespace std;
+
+PeriodicPThread *PeriodicPThread::instance = NULL;
+pthread_mutex_t PeriodicPThread::instanceMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Names of the overlap policies.
+ */
+static const char * const OVERLAP_NAMES[] = { "skip", "queue", "parallel" };
+
+/**
+ * Constructor, creates the timer.
+ */
+PeriodicPThread::PeriodicPThread() :
+		timerFd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)), monitor(
+				"periodic"), lastId(0) {
+	if (timerFd == -1) {
+		perror("Failed to create periodic timer - timerfd_create()");
+	} else {
+		loop.add(timerFd, this);
+	}
+}
+
+/**
+ * Destructor, stops the thread. Runs which have not exited are not signalled.
+ */
+PeriodicPThread::~PeriodicPThread() {
+	PThread::cancel();
+	for (set<RunExit *>::iterator it = exits.begin(); it != exits.end(); ++it) {
+		close((*it)->fd);
+		delete *it;
+	}
+	if (timerFd != -1) {
+		close(timerFd);
+	}
+}
+
+/**
+ * Returns the scheduler, it is created and started on demand.
+ * @param create Whether the scheduler is created if it does not exist.
+ * @return Scheduler or NULL.
+ */
+PeriodicPThread *PeriodicPThread::getInstance(bool create) {
+	pthread_mutex_lock(&instanceMutex);
+	if (instance == NULL && create) {
+		instance = new PeriodicPThread();
+		instance->start();
+	}
+	PeriodicPThread *scheduler = instance;
+	pthread_mutex_unlock(&instanceMutex);
+	return scheduler;
+}
+
+/**
+ * Main function where scheduler thread runs the event loop.
+ * @return Exit code of this thread.
+ */
+int PeriodicPThread::run() {
+	while (!isStopRequested()) {
+		if (loop.runOnce(-1) == -1) {
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Timer has expired, marks ticks of the commands whose deadlines have passed
+ * and wakes up their executors.
+ */
+void PeriodicPThread::onEvent(uint32_t) {
+	uint64_t expirations;
+	if (read(timerFd, &expirations, sizeof(expirations)) == -1) {
+		return; // Timer has been rearmed meanwhile
+	}
+
+	monitor.enter();
+	uint64_t current = now();
+	while (!deadlines.empty() && deadlines.begin()->first <= current) {
+		int id = deadlines.begin()->second;
+		deadlines.erase(deadlines.begin());
+		Task &task = tasks[id];
+
+		if (task.dueAt != 0) { // Previous tick has not been taken yet
+			task.missed++;
+		} else {
+			task.dueAt = task.deadline;
+		}
+
+		/* The next tick is a multiple of the interval since the start */
+		uint64_t interval = task.interval * 1000000UL;
+		task.deadline += interval;
+		if (task.deadline <= current) {
+			uint64_t behind = (current - task.deadline) / interval + 1;
+			task.missed += behind;
+			task.deadline += behind * interval;
+		}
+		deadlines.insert(make_pair(task.deadline, id));
+		kicked.insert(task.owner);
+	}
+	rearm();
+	set<PeriodicOwner *> owners(kicked);
+	monitor.exit();
+
+	/* Executors are woken up outside, they call the scheduler in their monitor */
+	for (set<PeriodicOwner *>::iterator it = owners.begin(); it != owners.end();
+			++it) {
+		(*it)->periodicDue();
+	}
+}
+
+/**
+ * Run has exited, executor is woken up to reap it and to start
+ * the queued run.
+ */
+void PeriodicPThread::RunExit::onEvent(uint32_t) {
+	instance->runExited(this);
+}
+
+/**
+ * Stops watching of the exited run.
+ * @param exit Watch of the run, it is deleted.
+ */
+void PeriodicPThread::runExited(RunExit *exit) {
+	PeriodicOwner *owner = NULL;
+
+	monitor.enter();
+	loop.remove(exit->fd);
+	close(exit->fd);
+	exits.erase(exit);
+	map<int, Task>::iterator it = tasks.find(exit->id);
+	if (it != tasks.end()) {
+		it->second.running.erase(exit->pid);
+		owner = it->second.owner;
+		kicked.insert(owner);
+	}
+	monitor.exit();
+
+	delete exit;
+	if (owner != NULL) {
+		owner->periodicDue();
+	}
+}
+
+/**
+ * Adds periodic command, its first run is due at once.
+ * @param owner Executor which runs the command.
+ * @param command Command line.
+ * @param interval Milliseconds between the runs.
+ * @param overlap What happens when the previous run has not exited.
+ * @return ID of the command.
+ */
+int PeriodicPThread::add(PeriodicOwner *owner, const string &command,
+		long interval, Overlap overlap) {
+	PeriodicPThread *scheduler = getInstance(true);
+
+	Task task;
+	task.owner = owner;
+	task.command = command;
+	task.interval = interval;
+	task.overlap = overlap;
+	task.deadline = now();
+	task.dueAt = 0;
+	task.runs = task.skipped = task.missed = 0;
+	task.jitterSum = task.jitterSquares = task.jitterMax = 0;
+
+	scheduler->monitor.enter();
+	int id = ++scheduler->lastId;
+	scheduler->tasks[id] = task;
+	scheduler->deadlines.insert(make_pair(task.deadline, id));
+	scheduler->rearm();
+	scheduler->monitor.exit();
+	return id;
+}
+
+/**
+ * Removes periodic command.
+ * @param owner Executor which runs the command.
+ * @param id ID of the command.
+ * @param running PIDs of its runs which have not exited.
+ * @return False if the executor has no such command.
+ */
+bool PeriodicPThread::remove(PeriodicOwner *owner, int id,
+		vector<pid_t> &running) {
+	PeriodicPThread *scheduler = getInstance(false);
+	if (scheduler == NULL) {
+		return false;
+	}
+
+	scheduler->monitor.enter();
+	map<int, Task>::iterator it = scheduler->tasks.find(id);
+	bool found = it != scheduler->tasks.end() && it->second.owner == owner;
+	if (found) {
+		running.assign(it->second.running.begin(), it->second.running.end());
+		scheduler->deadlines.erase(make_pair(it->second.deadline, id));
+		scheduler->tasks.erase(it);
+		scheduler->rearm();
+	}
+	scheduler->monitor.exit();
+	return found;
+}
+
+/**
+ * Tests whether the executor has runs to start or exited runs to reap.
+ * Executor calls it inside of its monitor, so it does not miss the wake up.
+ */
+bool PeriodicPThread::hasWork(PeriodicOwner *owner) {
+	PeriodicPThread *scheduler = getInstance(false);
+	if (scheduler == NULL) {
+		return false;
+	}
+
+	scheduler->monitor.enter();
+	bool work = scheduler->kicked.count(owner) > 0;
+	scheduler->monitor.exit();
+	return work;
+}
+
+/**
+ * Takes runs which should be started by the executor, applies the overlap
+ * policy and records jitter of the runs.
+ * @param owner Executor which runs the commands.
+ * @param runs Runs to be started, executor calls started() for each.
+ */
+void PeriodicPThread::take(PeriodicOwner *owner, vector<PeriodicRun> &runs) {
+	PeriodicPThread *scheduler = getInstance(false);
+	if (scheduler == NULL) {
+		return;
+	}
+
+	scheduler->monitor.enter();
+	scheduler->kicked.erase(owner);
+	uint64_t current = now();
+	for (map<int, Task>::iterator it = scheduler->tasks.begin();
+			it != scheduler->tasks.end(); ++it) {
+		Task &task = it->second;
+		if (task.owner != owner) {
+			continue;
+		}
+
+		uint64_t tick = 0;
+		if (task.dueAt != 0 && task.overlap == QUEUE
+				&& task.queued.size() < MAX_QUEUED) {
+			task.queued.push_back(task.dueAt);
+		} else if (task.dueAt != 0
+				&& (task.running.empty() || task.overlap == PARALLEL)) {
+			tick = task.dueAt;
+		} else if (task.dueAt != 0) {
+			task.skipped++;
+		}
+		task.dueAt = 0;
+		if (tick == 0 && task.running.empty() && !task.queued.empty()) {
+			tick = task.queued.front();
+			task.queued.pop_front();
+		}
+		if (tick == 0) {
+			continue;
+		}
+
+		PeriodicRun run;
+		run.id = it->first;
+		run.command = task.command;
+		run.scheduledAt = tick;
+		runs.push_back(run);
+
+		double jitter = (current - tick) / 1e6;
+		task.runs++;
+		task.jitterSum += jitter;
+		task.jitterSquares += jitter * jitter;
+		task.jitterMax = (jitter > task.jitterMax) ? jitter : task.jitterMax;
+	}
+	scheduler->monitor.exit();
+}
+
+/**
+ * Watches exit of the started run.
+ * @param run Run which has been started.
+ * @param pid PID of its child, 0 when no child has been started.
+ */
+void PeriodicPThread::started(const PeriodicRun &run, pid_t pid) {
+	PeriodicPThread *scheduler = getInstance(false);
+	if (scheduler == NULL || pid <= 0) {
+		return;
+	}
+
+	/* Fails when the child has already been reaped, pidfd is close-on-exec */
+	int fd = syscall(SYS_pidfd_open, pid, 0);
+	if (fd == -1) {
+		return;
+	}
+
+	RunExit *exit = new RunExit(run.id, pid, fd);
+	scheduler->monitor.enter();
+	map<int, Task>::iterator it = scheduler->tasks.find(run.id);
+	if (it != scheduler->tasks.end()) {
+		it->second.running.insert(pid);
+		scheduler->exits.insert(exit);
+		scheduler->loop.add(fd, exit);
+	} else {
+		close(fd);
+		delete exit;
+	}
+	scheduler->monitor.exit();
+}
+
+/**
+ * Lists periodic commands of the executor with statistics of their runs.
+ * @param owner Executor which runs the commands.
+ * @return One line per command.
+ */
+string PeriodicPThread::list(PeriodicOwner *owner) {
+	PeriodicPThread *scheduler = getInstance(false);
+	if (scheduler == NULL) {
+		return "";
+	}
+
+	string result;
+	char line[256];
+	scheduler->monitor.enter();
+	uint64_t current = now();
+	for (map<int, Task>::iterator it = scheduler->tasks.begin();
+			it != scheduler->tasks.end(); ++it) {
+		const Task &task = it->second;
+		if (task.owner != owner) {
+			continue;
+		}
+
+		double mean = (task.runs > 0) ? task.jitterSum / task.runs : 0;
+		double variance =
+				(task.runs > 0) ? task.jitterSquares / task.runs - mean * mean : 0;
+		snprintf(line, sizeof(line),
+				"[%d] every %ldms %s, next in %.3fs, runs %lu, running %lu,"
+						" queued %lu, skipped %lu, missed %lu, jitter mean %.3fms"
+						" sd %.3fms max %.3fms: ", it->first, task.interval,
+				OVERLAP_NAMES[task.overlap],
+				(task.deadline > current) ? (task.deadline - current) / 1e9 : 0,
+				task.runs, (unsigned long) task.running.size(),
+				(unsigned long) task.queued.size(), task.skipped, task.missed,
+				mean, sqrt((variance > 0) ? variance : 0), task.jitterMax);
+		result += line + task.command + "\n";
+	}
+	scheduler->monitor.exit();
+	return result;
+}
+
+/**
+ * Stops and deletes the scheduler, runs are not signalled.
+ */
+void PeriodicPThread::stop() {
+	pthread_mutex_lock(&instanceMutex);
+	PeriodicPThread *scheduler = instance;
+	instance = NULL;
+	pthread_mutex_unlock(&instanceMutex);
+
+	delete scheduler;
+}
+
+/**
+ * Parses overlap policy - skip, queue or parallel.
+ * @return False if the policy is invalid.
+ */
+bool PeriodicPThread::parseOverlap(const string &value, Overlap &overlap) {
+	for (int i = SKIP; i <= PARALLEL; i++) {
+		if (value == OVERLAP_NAMES[i]) {
+			overlap = static_cast<Overlap>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Arms the timer to the nearest deadline, must be called inside
+ * of the monitor.
+ */
+void PeriodicPThread::rearm() {
+	struct itimerspec spec;
+	memset(&spec, 0, sizeof(spec));
+	if (!deadlines.empty()) { // Zero would disarm the timer
+		uint64_t nearest = deadlines.begin()->first;
+		nearest = (nearest > 0) ? nearest : 1;
+		spec.it_value.tv_sec = nearest / 1000000000UL;
+		spec.it_value.tv_nsec = nearest % 1000000000UL;
+	}
+	if (timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, NULL) == -1) {
+		perror("Failed to arm periodic timer - timerfd_settime()");
+	}
+}
+
+/**
+ * Wakes up the event loop when stop is requested.
+ */
+void PeriodicPThread::wakeUp() {
+	loop.wakeUp();
+}
+
+/**
+ * Returns monotonic time in nanoseconds.
+ */
+uint64_t PeriodicPThread::now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       PeriodicPThread.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines thread scheduling periodic commands
+//             of the every builtin.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file PeriodicPThread.h
+ *
+ * @brief Header file which defines thread scheduling periodic commands
+ *        of the every builtin.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef PERIODICPTHREAD_H_INCLUDED
+#define PERIODICPTHREAD_H_INCLUDED
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "PThread.h"
+#include "EventLoop.h"
+
+using namespace std;
+
+/**
+ * Executor which runs the periodic commands. Scheduler only wakes it up,
+ * so the runs are children of its session.
+ */
+class PeriodicOwner {
+public:
+	virtual ~PeriodicOwner() {
+	}
+
+	/**
+	 * Called by the scheduler thread when a tick is due or a run has exited,
+	 * the executor calls PeriodicPThread::take().
+	 */
+	virtual void periodicDue() = 0;
+};
+
+/**
+ * Run which is started by the executor.
+ */
+typedef struct {
+	int id; /**< of the periodic command */
+	string command;
+	uint64_t scheduledAt; /**< monotonic nanoseconds of its tick */
+} PeriodicRun;
+
+/**
+ * Thread which keeps deadlines of all periodic commands of the shell
+ * in one timerfd. Deadlines are absolute - start plus multiple of
+ * the interval, so they do not drift by the time of the runs. Deadlines are
+ * ordered in a set, the timer is armed to the nearest one. Exits of the runs
+ * are watched by pidfd in the same event loop. When the previous run has not
+ * exited at the tick, the run is skipped, queued until it exits (at most
+ * MAX_QUEUED ticks wait) or started in parallel. Jitter is the time from
+ * the tick to the start of the run.
+ */
+class PeriodicPThread: public PThread, public EventHandler {
+public:
+	enum Overlap {
+		SKIP, QUEUE, PARALLEL
+	};
+	static const size_t MAX_QUEUED = 16; /**< further ticks are skipped */
+
+	virtual ~PeriodicPThread();
+	virtual int run();
+	virtual void onEvent(uint32_t events);
+
+	static int add(PeriodicOwner *owner, const string &command, long interval,
+			Overlap overlap);
+	static bool remove(PeriodicOwner *owner, int id, vector<pid_t> &running);
+	static bool hasWork(PeriodicOwner *owner);
+	static void take(PeriodicOwner *owner, vector<PeriodicRun> &runs);
+	static void started(const PeriodicRun &run, pid_t pid);
+	static string list(PeriodicOwner *owner);
+	static void stop();
+
+	static bool parseOverlap(const string &value, Overlap &overlap);
+private:
+	/**
+	 * Periodic command.
+	 */
+	typedef struct {
+		PeriodicOwner *owner;
+		string command;
+		long interval; /**< milliseconds */
+		Overlap overlap;
+		uint64_t deadline; /**< monotonic nanoseconds of the next tick */
+		uint64_t dueAt; /**< tick which has not been taken, 0 none */
+		deque<uint64_t> queued; /**< ticks waiting for the previous run */
+		set<pid_t> running;
+		unsigned long runs;
+		unsigned long skipped; /**< ticks when the previous run has not exited */
+		unsigned long missed; /**< ticks when the executor was busy */
+		double jitterSum; /**< milliseconds */
+		double jitterSquares;
+		double jitterMax;
+	} Task;
+
+	/**
+	 * Exit of the run watched by pidfd.
+	 */
+	class RunExit: public EventHandler {
+	public:
+		RunExit(int id, pid_t pid, int fd) :
+				id(id), pid(pid), fd(fd) {
+		}
+		virtual void onEvent(uint32_t events);
+
+		int id;
+		pid_t pid;
+		int fd;
+	};
+
+	int timerFd;
+	EventLoop loop;
+	PThreadMonitor monitor;
+	map<int, Task> tasks;
+	set<pair<uint64_t, int> > deadlines; /**< deadline and id */
+	set<PeriodicOwner *> kicked; /**< owners which have work */
+	set<RunExit *> exits; /**< watched runs */
+	int lastId;
+
+	friend class RunExit;
+
+	static PeriodicPThread *instance;
+	static pthread_mutex_t instanceMutex;
+
+	PeriodicPThread();
+	void runExited(RunExit *exit);
+	void rearm();
+	void wakeUp();
+
+	static PeriodicPThread *getInstance(bool create);
+	static uint64_t now();
+};
+
+#endif // PERIODICPTHREAD_H_INCLUDED
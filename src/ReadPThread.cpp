@@ -20,118 +20,212 @@
 #include <iostream>
 #include <cstdlib>
 #include <cstdio>
-#include <iostream>
+#include <cstring>
 
 #include <signal.h>
+#include <unistd.h>
 #include <errno.h>    
-
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+
+#include "DelimiterScanner.h"
+#include "Metrics.h"
+#include "Trace.h"
 #include "ReadPThread.h"
 
 using namespace std;
 
 /**
- * Cancels this thread.
+ * Constructor.
  */
-void ReadPThread::cancel() {
-	bufferMonitor.signal();
-	PThread::cancel();
+ReadPThread::ReadPThread(vector<char> &buffer, PThreadMonitor &bufferMonitor,
+		PThreadCondition &bufferFilled, PThreadCondition &bufferEmptied) :
+		buffer(buffer), bufferMonitor(bufferMonitor), bufferFilled(
+				bufferFilled), bufferEmptied(bufferEmptied), inputFd(-1) {
+	wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (wakeFd == -1) {
+		perror("Failed to create wake up descriptor - eventfd()");
+	}
+}
+
+/**
+ * Destructor.
+ */
+ReadPThread::~ReadPThread() {
+	cancel();
+	if (wakeFd != -1) {
+		close(wakeFd);
+	}
+}
+
+/**
+ * Wakes up this thread waiting for the input or for the consumer
+ * when its stop is requested.
+ */
+void ReadPThread::wakeUp() {
+	uint64_t one = 1;
+	if (wakeFd != -1 && write(wakeFd, &one, sizeof(one)) == -1) {
+		perror("Failed to wake up read thread - write()");
+	}
+
+	bufferMonitor.enter();
+	bufferEmptied.broadcast();
+	bufferMonitor.exit();
 }
 
 /**
  * Starts reading from the stdin.
  */
 void ReadPThread::startReading() {
+	/* Own copy of stdin, it is not inherited by children */
+	inputFd = fcntl(STDIN_FILENO, F_DUPFD_CLOEXEC, 0);
 	start();
 }
 
+/**
+ * Callback function which is called when this thread is going to finish.
+ */
+void ReadPThread::onFinish() {
+	close(inputFd);
+}
+
+/**
+ * Waits until consumer takes the command from the buffer.
+ */
+void ReadPThread::waitBufferEmpty() {
+	bufferMonitor.enter();
+	while (buffer[0] != '\0' && !isStopRequested()) {
+		bufferEmptied.wait();
+	}
+	bufferMonitor.exit();
+}
+
+/**
+ * Passes one line of the input to the consumer.
+ * @param line Line including the terminating newline.
+ * @param length Length of the line.
+ */
+void ReadPThread::passLine(const char *line, size_t length) {
+	if (length >= buffer.size()) {
+		cerr << "Too long input command!" << endl;
+		line = " ";
+		length = 1;
+	}
+
+	TRACE_BEGIN(HANDOFF);
+	bufferMonitor.enter();
+
+	/* Buffer is not empty, consumer has not processed it yet. */
+	while (buffer[0] != '\0' && !isStopRequested()) {
+		bufferEmptied.wait(); // Wait & enable buffer to consumer
+	}
+	if (isStopRequested()) {
+		bufferMonitor.exit();
+		TRACE_END(HANDOFF);
+		return;
+	}
+
+	memcpy(&buffer[0], line, length);
+	buffer[length] = '\0';
+	if (buffer[0] == '\0') { // Line starting by \0 would not be seen by consumer
+		buffer[0] = ' ';
+	}
+
+	Metrics::lineQueued();
+	bufferFilled.signal();
+	bufferMonitor.exit();
+	TRACE_END(HANDOFF);
+}
+
 /**
  * Main body of read thread.
+ * Input is read by whole blocks, which are split into lines by the delimiter
+ * scanner, so scripts piped into the shell are not limited by the size
+ * of the shared buffer.
  * @return Exit code how exited/returned this thread.
  */
 int ReadPThread::run() {
-	bool lastCommandFinished = true;
-	// Set stdin into file set - only stdin we will control and read
-	fd_set read_set;
-	FD_ZERO(&read_set);
-	FD_SET(STDIN_FILENO, &read_set);
+	vector<char> block(BLOCK_SIZE);
+	DelimiterBitmap bitmap;
+	size_t pending = 0; // Length of the unfinished line at the start of block
+	bool discarding = false; // Too long line is being skipped
+
+	// Wait for stdin or for the request to stop this thread
+	struct pollfd fds[2];
+	fds[0].fd = inputFd;
+	fds[0].events = POLLIN;
+	fds[1].fd = wakeFd;
+	fds[1].events = POLLIN;
 
 	// Block until new data are available
 	int ret = EXIT_SUCCESS;
-	while (1) {
+	while (!isStopRequested()) {
 		int retError = 0;
-		errno = 0;
 
-		while (1) { // Wait for data to read or cancel request to break this thread.
-			cancelPoint();
-			struct timeval tv = { 1, 0 };
-			ret = select(STDIN_FILENO + 1, &read_set, NULL, NULL, &tv);
-			cancelPoint();
-
-			if (ret != -1) {
-				break;
-			}
+		TRACE_BEGIN(READ_WAIT);
+		int ready = poll(fds, 2, -1);
+		TRACE_END(READ_WAIT);
+
+		if (ready == -1 && errno == EINTR) {
+			continue;
+		} else if (ready == -1) {
+			retError = errno;
+			perror("Failed waiting for stdin - poll()");
+			ret = (retError != 0) ? retError : EXIT_FAILURE;
+			break;
 		}
 
-		if (FD_ISSET(STDIN_FILENO, &read_set)) { // New data on stdin
-
-			bufferMonitor.enter();
-
-			/* Buffer is not empty, consumer has not processed it yet. */
-			while (buffer[0] != '\0') {
-				cancelPoint();
-				bufferMonitor.wait(); // Wait & enable buffer to consumer
-			}
-
+		if (fds[0].revents != 0 && !isStopRequested()) { // New data on stdin
+			TRACE_BEGIN(READ_BLOCK);
 			errno = 0;
-			ssize_t readBytes = read(STDIN_FILENO, &buffer[0],
-					sizeof(char) * buffer.size());
+			ssize_t readBytes = read(inputFd, &block[pending],
+					block.size() - pending);
 
 			if (readBytes < 0) { // exit with error
-				bufferMonitor.exit();
 				retError = errno;
 				perror("Failed reading of stdin - read()");
 				ret = (retError != 0) ? errno : EXIT_FAILURE;
+				TRACE_END(READ_BLOCK);
+				break;
+			} else if (readBytes == 0) { // End of input, pass the last line
+				if (pending > 0 && !discarding) {
+					passLine(&block[0], pending);
+				}
+				waitBufferEmpty();
+				ret = EXIT_SUCCESS;
+				TRACE_END(READ_BLOCK);
 				break;
-			} else if (readBytes == 0 || buffer[0] == '\0') { // Nothing has been read
-				buffer[0] = '\0';
-				bufferMonitor.exit();
-				continue;
-			} else if (readBytes > 0 && readBytes < (int) buffer.size()) { // Normal reading, apend \0
-				buffer[readBytes] = '\0';
 			}
 
-			// Buffer overflow, print error
-			if (readBytes >= (int) buffer.size() && lastCommandFinished) {
-				cerr << "Too long input command!" << endl;
-				buffer[0] = '\0';
-			}
-			// Input text in limits, everything OK, signal the consumer
-			else if (readBytes > 0 && readBytes < (int) buffer.size()
-					&& lastCommandFinished) {
-				bufferMonitor.signal();
-			}
-			// There was probably some error, do not put data to consumer and delete the data from buffer
-			else {
-				buffer[0] = '\0';
+			size_t length = pending + readBytes;
+			DelimiterScanner::scan(&block[0], length, bitmap);
+
+			size_t start = 0, newline;
+			while ((newline = DelimiterScanner::nextNewline(bitmap, start,
+					length)) < length) {
+				if (!discarding) {
+					passLine(&block[start], newline - start + 1);
+				} else { // After error is printed, send to consumer empty line - this will cause printing the $
+					passLine(" ", 1);
+					discarding = false;
+				}
+				start = newline + 1;
 			}
 
-			bool prevLastCommandFinished = lastCommandFinished;
-			lastCommandFinished = buffer[readBytes - 1] == '\n';
+			pending = length - start;
+			memmove(&block[0], &block[start], pending);
 
-			/* After error is printed, send to consumer empty line - this will cause printing the $ */
-			if (!prevLastCommandFinished && lastCommandFinished && readBytes > 0
-					&& readBytes < (int) buffer.size()) {
-				buffer[0] = ' ';
-				buffer[1] = '\0';
-				bufferMonitor.signal();
+			if (!discarding && pending >= buffer.size() - 1) {
+				cerr << "Too long input command!" << endl;
+				discarding = true;
 			}
-
-			bufferMonitor.exit();
+			if (discarding) {
+				pending = 0;
+			}
+			TRACE_END(READ_BLOCK);
 		}
-
-		// Reset for sure - but with one set file descriptor is not necessary
-		FD_ZERO(&read_set);
-		FD_SET(STDIN_FILENO, &read_set);
 	}
 
 	return ret;
@@ -30,20 +30,28 @@ using namespace std;
  */
 class ReadPThread: public PThread {
 public:
-	ReadPThread(vector<char> &buffer, PThreadMonitor &bufferMonitor) :
-			buffer(buffer), bufferMonitor(bufferMonitor) {
-	}
-	virtual ~ReadPThread() {
-	}
+	ReadPThread(vector<char> &buffer, PThreadMonitor &bufferMonitor,
+			PThreadCondition &bufferFilled, PThreadCondition &bufferEmptied);
+	virtual ~ReadPThread();
 	virtual int run();
-	virtual void cancel();
 	void startReading();
 private:
+	static const int BLOCK_SIZE = 65536;
+
 	vector<char> &buffer;
 	PThreadMonitor &bufferMonitor;
+	PThreadCondition &bufferFilled; /**< signalled when line is passed */
+	PThreadCondition &bufferEmptied; /**< waited for until line is taken */
+	int inputFd;
+	int wakeFd; /**< eventfd which wakes up poll when stop is requested */
 	int exitFile;
 	char exitFileName[32];
 
+	void passLine(const char *line, size_t length);
+	void waitBufferEmpty();
+
+	virtual void onFinish();
+	virtual void wakeUp();
 };
 
 #endif // READPTHREAD_H_INCLUDED
@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       ResourceLimits.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements resource limits applied
+//             to the children before exec.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ResourceLimits.cpp
+ *
+ * @brief Source file which implements resource limits applied to the children
+ *        before exec.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "ResourceLimits.h"
+
+using namespace std;
+
+/**
+ * Options of the ulimit builtin, index is the index of the resource.
+ */
+static const struct {
+	const char *option;
+	int resource;
+	rlim_t unit; /**< bytes of one unit of the option */
+	const char *description;
+} RESOURCES[LIMIT_RESOURCES] = { { "-t", RLIMIT_CPU, 1, "CPU seconds" }, {
+		"-v", RLIMIT_AS, 1024, "address space KiB" }, { "-n", RLIMIT_NOFILE,
+		1, "open files" }, { "-u", RLIMIT_NPROC, 1, "processes" } };
+
+/**
+ * Unsets all limits.
+ */
+void ResourceLimits::clear(LimitAttrs &attrs) {
+	memset(&attrs, 0, sizeof(attrs));
+}
+
+/**
+ * Returns whether no limit is set.
+ */
+bool ResourceLimits::isEmpty(const LimitAttrs &attrs) {
+	for (int i = 0; i < LIMIT_RESOURCES; i++) {
+		if (attrs.has[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Sets limits which are set in overrides.
+ */
+void ResourceLimits::merge(LimitAttrs &attrs, const LimitAttrs &overrides) {
+	for (int i = 0; i < LIMIT_RESOURCES; i++) {
+		if (overrides.has[i]) {
+			attrs.has[i] = true;
+			attrs.values[i] = overrides.values[i];
+		}
+	}
+}
+
+/**
+ * Parses one option of the ulimit builtin.
+ * @param option -t SECONDS, -v KIB, -n FILES or -u PROCESSES.
+ * @param value Value of the option, number or unlimited.
+ * @param attrs Limits where the option is set.
+ * @param error Description of the invalid value.
+ * @return True on success, false if the option or value is invalid.
+ */
+bool ResourceLimits::parseOption(const string &option, const string &value,
+		LimitAttrs &attrs, string &error) {
+	for (int i = 0; i < LIMIT_RESOURCES; i++) {
+		if (option != RESOURCES[i].option) {
+			continue;
+		}
+		if (value == "unlimited") {
+			attrs.has[i] = true;
+			attrs.values[i] = RLIM_INFINITY;
+			return true;
+		}
+
+		char *end;
+		errno = 0;
+		unsigned long number = strtoul(value.c_str(), &end, 10);
+		if (value.empty() || value[0] == '-' || *end != '\0' || errno != 0
+				|| number > RLIM_INFINITY / RESOURCES[i].unit) {
+			error = "invalid limit " + value;
+			return false;
+		}
+		attrs.has[i] = true;
+		attrs.values[i] = number * RESOURCES[i].unit;
+		return true;
+	}
+
+	error = "unknown option " + option;
+	return false;
+}
+
+/**
+ * Formats set limits as options of the ulimit builtin.
+ */
+string ResourceLimits::format(const LimitAttrs &attrs) {
+	stringstream ss;
+	for (int i = 0; i < LIMIT_RESOURCES; i++) {
+		if (!attrs.has[i]) {
+			continue;
+		}
+		ss << " " << RESOURCES[i].option << " ";
+		if (attrs.values[i] == RLIM_INFINITY) {
+			ss << "unlimited";
+		} else {
+			ss << (unsigned long) (attrs.values[i] / RESOURCES[i].unit);
+		}
+	}
+
+	string result = ss.str();
+	return result.empty() ? "" : result.substr(1);
+}
+
+/**
+ * Applies limits to the calling process, it is called in the child before
+ * exec. Both soft and hard limits are set, so the command cannot raise
+ * them back.
+ * @return 0 on success, otherwise exit status of the child.
+ */
+int ResourceLimits::apply(const LimitAttrs &attrs) {
+	for (int i = 0; i < LIMIT_RESOURCES; i++) {
+		if (!attrs.has[i]) {
+			continue;
+		}
+		struct rlimit limit;
+		if (getrlimit(RESOURCES[i].resource, &limit) == -1) {
+			perror("Failed to get resource limit - getrlimit()");
+			return EXIT_FAILURE;
+		}
+		if (attrs.values[i] == RLIM_INFINITY) {
+			limit.rlim_cur = limit.rlim_max;
+		} else {
+			limit.rlim_cur = limit.rlim_max = attrs.values[i];
+		}
+		if (setrlimit(RESOURCES[i].resource, &limit) == -1) {
+			string msg = string("Failed to limit ") + RESOURCES[i].description
+					+ " - setrlimit()";
+			perror(msg.c_str());
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
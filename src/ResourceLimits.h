@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       ResourceLimits.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines resource limits applied
+//             to the children before exec.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ResourceLimits.h
+ *
+ * @brief Header file which defines resource limits applied to the children
+ *        before exec.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef RESOURCELIMITS_H_INCLUDED
+#define RESOURCELIMITS_H_INCLUDED
+
+#include <string>
+
+#include <sys/resource.h>
+
+using namespace std;
+
+/**
+ * Number of the limited resources - CPU time, address space, open files
+ * and processes.
+ */
+const int LIMIT_RESOURCES = 4;
+
+/**
+ * Resource limits of the child, only the set ones are applied. Values
+ * are in units of setrlimit, RLIM_INFINITY raises the soft limit to the hard
+ * one. Structure is plain data, so it can be passed to the fork server.
+ */
+typedef struct {
+	bool has[LIMIT_RESOURCES];
+	rlim_t values[LIMIT_RESOURCES];
+} LimitAttrs;
+
+/**
+ * Parsing, formatting and applying of the resource limits.
+ */
+class ResourceLimits {
+public:
+	static void clear(LimitAttrs &attrs);
+	static bool isEmpty(const LimitAttrs &attrs);
+	static void merge(LimitAttrs &attrs, const LimitAttrs &overrides);
+
+	static bool parseOption(const string &option, const string &value,
+			LimitAttrs &attrs, string &error);
+	static string format(const LimitAttrs &attrs);
+
+	static int apply(const LimitAttrs &attrs);
+};
+
+#endif // RESOURCELIMITS_H_INCLUDED
@@ -0,0 +1,270 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       Scheduling.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements scheduling attributes applied
+//             to the children before exec.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Scheduling.cpp
+ *
+ * @brief Source file which implements scheduling attributes applied to
+ *        the children before exec.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#include "Scheduling.h"
+
+using namespace std;
+
+/**
+ * Names of the scheduling policies.
+ */
+static const struct {
+	const char *name;
+	int policy;
+} POLICIES[] = { { "other", SCHED_OTHER }, { "batch", SCHED_BATCH }, {
+		"idle", SCHED_IDLE }, { "fifo", SCHED_FIFO }, { "rr", SCHED_RR }, {
+		NULL, 0 } };
+
+/**
+ * Names of the I/O scheduling classes, index is the class.
+ */
+static const char * const IO_CLASSES[] = { "none", "rt", "be", "idle", NULL };
+
+/**
+ * Unsets all attributes.
+ */
+void Scheduling::clear(SchedAttrs &attrs) {
+	memset(&attrs, 0, sizeof(attrs));
+	CPU_ZERO(&attrs.cpus);
+}
+
+/**
+ * Returns whether no attribute is set.
+ */
+bool Scheduling::isEmpty(const SchedAttrs &attrs) {
+	return !attrs.hasAffinity && !attrs.hasNice && !attrs.hasPolicy
+			&& !attrs.hasIoPriority;
+}
+
+/**
+ * Sets attributes which are set in overrides.
+ */
+void Scheduling::merge(SchedAttrs &attrs, const SchedAttrs &overrides) {
+	if (overrides.hasAffinity) {
+		attrs.hasAffinity = true;
+		attrs.cpus = overrides.cpus;
+	}
+	if (overrides.hasNice) {
+		attrs.hasNice = true;
+		attrs.nice = overrides.nice;
+	}
+	if (overrides.hasPolicy) {
+		attrs.hasPolicy = true;
+		attrs.policy = overrides.policy;
+		attrs.priority = overrides.priority;
+	}
+	if (overrides.hasIoPriority) {
+		attrs.hasIoPriority = true;
+		attrs.ioClass = overrides.ioClass;
+		attrs.ioLevel = overrides.ioLevel;
+	}
+}
+
+/**
+ * Parses one option of the sched builtin.
+ * @param option -c CPUS, -n NICE, -p POLICY[:PRIO] or -i CLASS[:LEVEL].
+ * @param value Value of the option.
+ * @param attrs Attributes where the option is set.
+ * @param error Description of the invalid value.
+ * @return True on success, false if the option or value is invalid.
+ */
+bool Scheduling::parseOption(const string &option, const string &value,
+		SchedAttrs &attrs, string &error) {
+	size_t colon = value.find(':');
+	string name = value.substr(0, colon);
+	string level = (colon != string::npos) ? value.substr(colon + 1) : "";
+
+	if (option == "-c") {
+		attrs.hasAffinity = parseCpus(value, attrs.cpus);
+		error = attrs.hasAffinity ? "" : "invalid CPU list " + value;
+	} else if (option == "-n") {
+		attrs.hasNice = parseNumber(value, attrs.nice) && attrs.nice >= -20
+				&& attrs.nice <= 19;
+		error = attrs.hasNice ? "" : "nice must be -20..19";
+	} else if (option == "-p") {
+		attrs.hasPolicy = false;
+		for (int i = 0; POLICIES[i].name != NULL; i++) {
+			if (name == POLICIES[i].name) {
+				attrs.hasPolicy = true;
+				attrs.policy = POLICIES[i].policy;
+			}
+		}
+		bool realTime = attrs.policy == SCHED_FIFO || attrs.policy == SCHED_RR;
+		attrs.priority = realTime ? 1 : 0;
+		if (attrs.hasPolicy && !level.empty()) {
+			attrs.hasPolicy = realTime && parseNumber(level, attrs.priority)
+					&& attrs.priority >= sched_get_priority_min(attrs.policy)
+					&& attrs.priority <= sched_get_priority_max(attrs.policy);
+		}
+		error = attrs.hasPolicy ?
+				"" : "policy must be other, batch, idle, fifo[:PRIO] or rr[:PRIO]";
+	} else if (option == "-i") {
+		attrs.hasIoPriority = false;
+		for (int i = 1; IO_CLASSES[i] != NULL; i++) {
+			if (name == IO_CLASSES[i]) {
+				attrs.hasIoPriority = true;
+				attrs.ioClass = i;
+			}
+		}
+		attrs.ioLevel = 4;
+		if (attrs.hasIoPriority && !level.empty()) {
+			attrs.hasIoPriority = parseNumber(level, attrs.ioLevel)
+					&& attrs.ioLevel >= 0 && attrs.ioLevel <= 7;
+		}
+		error = attrs.hasIoPriority ? "" : "I/O class must be rt, be or idle[:0-7]";
+	} else {
+		error = "unknown option " + option;
+		return false;
+	}
+
+	return error.empty();
+}
+
+/**
+ * Formats set attributes as options of the sched builtin.
+ */
+string Scheduling::format(const SchedAttrs &attrs) {
+	stringstream ss;
+	if (attrs.hasAffinity) {
+		ss << " -c ";
+		const char *separator = "";
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+			if (!CPU_ISSET(cpu, &attrs.cpus)) {
+				continue;
+			}
+			int last = cpu;
+			while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &attrs.cpus)) {
+				last++;
+			}
+			ss << separator << cpu;
+			if (last > cpu) {
+				ss << "-" << last;
+			}
+			separator = ",";
+			cpu = last;
+		}
+	}
+	if (attrs.hasNice) {
+		ss << " -n " << attrs.nice;
+	}
+	if (attrs.hasPolicy) {
+		for (int i = 0; POLICIES[i].name != NULL; i++) {
+			if (POLICIES[i].policy == attrs.policy) {
+				ss << " -p " << POLICIES[i].name;
+			}
+		}
+		if (attrs.policy == SCHED_FIFO || attrs.policy == SCHED_RR) {
+			ss << ":" << attrs.priority;
+		}
+	}
+	if (attrs.hasIoPriority) {
+		ss << " -i " << IO_CLASSES[attrs.ioClass] << ":" << attrs.ioLevel;
+	}
+
+	string result = ss.str();
+	return result.empty() ? "" : result.substr(1);
+}
+
+/**
+ * Applies attributes to the calling process, it is called in the child
+ * before exec. Nice is applied before the policy, because it is ignored
+ * by the real-time policies.
+ * @return 0 on success, otherwise exit status of the child.
+ */
+int Scheduling::apply(const SchedAttrs &attrs) {
+	if (attrs.hasAffinity
+			&& sched_setaffinity(0, sizeof(attrs.cpus), &attrs.cpus) == -1) {
+		perror("Failed to set CPU affinity - sched_setaffinity()");
+		return EXIT_FAILURE;
+	}
+	if (attrs.hasNice && setpriority(PRIO_PROCESS, 0, attrs.nice) == -1) {
+		perror("Failed to set nice value - setpriority()");
+		return EXIT_FAILURE;
+	}
+	if (attrs.hasPolicy) {
+		struct sched_param param;
+		param.sched_priority = attrs.priority;
+		if (sched_setscheduler(0, attrs.policy, &param) == -1) {
+			perror("Failed to set scheduling policy - sched_setscheduler()");
+			return EXIT_FAILURE;
+		}
+	}
+	if (attrs.hasIoPriority
+			&& syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0,
+					(attrs.ioClass << IOPRIO_CLASS_SHIFT) | attrs.ioLevel)
+					== -1) {
+		perror("Failed to set I/O priority - ioprio_set()");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Parses list of CPUs like 0-3,6.
+ */
+bool Scheduling::parseCpus(const string &value, cpu_set_t &cpus) {
+	CPU_ZERO(&cpus);
+	stringstream ss(value);
+	string range;
+	bool any = false;
+	while (getline(ss, range, ',')) {
+		size_t dash = range.find('-');
+		int first, last;
+		if (!parseNumber(range.substr(0, dash), first)
+				|| !parseNumber(
+						(dash != string::npos) ? range.substr(dash + 1) : range,
+						last) || first < 0 || last < first
+				|| last >= CPU_SETSIZE) {
+			return false;
+		}
+		for (int cpu = first; cpu <= last; cpu++) {
+			CPU_SET(cpu, &cpus);
+		}
+		any = true;
+	}
+	return any;
+}
+
+/**
+ * Parses whole string as decimal number.
+ */
+bool Scheduling::parseNumber(const string &value, int &number) {
+	if (value.empty()) {
+		return false;
+	}
+	char *end;
+	errno = 0;
+	long result = strtol(value.c_str(), &end, 10);
+	if (*end != '\0' || errno != 0) {
+		return false;
+	}
+	number = result;
+	return true;
+}
@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       Scheduling.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines scheduling attributes applied
+//             to the children before exec.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Scheduling.h
+ *
+ * @brief Header file which defines scheduling attributes applied to
+ *        the children before exec.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef SCHEDULING_H_INCLUDED
+#define SCHEDULING_H_INCLUDED
+
+#include <string>
+
+#include <sched.h>
+
+using namespace std;
+
+/**
+ * Scheduling attributes of the child, only the set ones are applied.
+ * Structure is plain data, so it can be passed to the fork server.
+ */
+typedef struct {
+	bool hasAffinity;
+	cpu_set_t cpus;
+	bool hasNice;
+	int nice;
+	bool hasPolicy;
+	int policy; /**< SCHED_OTHER, SCHED_BATCH, SCHED_IDLE, SCHED_FIFO, SCHED_RR */
+	int priority; /**< static priority of the real-time policies */
+	bool hasIoPriority;
+	int ioClass; /**< 1 real-time, 2 best-effort, 3 idle */
+	int ioLevel; /**< 0 (highest) - 7 */
+} SchedAttrs;
+
+/**
+ * Parsing, formatting and applying of the scheduling attributes.
+ */
+class Scheduling {
+public:
+	static void clear(SchedAttrs &attrs);
+	static bool isEmpty(const SchedAttrs &attrs);
+	static void merge(SchedAttrs &attrs, const SchedAttrs &overrides);
+
+	static bool parseOption(const string &option, const string &value,
+			SchedAttrs &attrs, string &error);
+	static string format(const SchedAttrs &attrs);
+
+	static int apply(const SchedAttrs &attrs);
+private:
+	static const int IOPRIO_CLASS_SHIFT = 13;
+	static const int IOPRIO_WHO_PROCESS = 1;
+
+	static bool parseCpus(const string &value, cpu_set_t &cpus);
+	static bool parseNumber(const string &value, int &number);
+};
+
+#endif // SCHEDULING_H_INCLUDED
@@ -0,0 +1,240 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       ServerPThread.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements thread serving shell sessions
+//             of the clients connected to the Unix domain socket.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ServerPThread.cpp
+ *
+ * @brief Source file which implements thread serving shell sessions of
+ *        the clients connected to the Unix domain socket.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "ForkServer.h"
+#include "WatchdogPThread.h"
+#include "Session.h"
+#include "ServerPThread.h"
+
+using namespace std;
+
+/**
+ * Constructor.
+ * @param path Path of the Unix domain socket.
+ * @param workerCount Number of workers, 0 for WORKERS_PER_CPU per online CPU.
+ */
+ServerPThread::ServerPThread(const string &path, int workerCount) :
+		path(path), workerCount(workerCount), listenFd(-1), pool(NULL), sessionsMonitor(
+				"sessions") {
+	if (this->workerCount <= 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		this->workerCount = WORKERS_PER_CPU * ((cpus > 0) ? cpus : 1);
+	}
+}
+
+/**
+ * Destructor, stops the thread and removes the socket if it has not run.
+ */
+ServerPThread::~ServerPThread() {
+	cancel();
+	if (listenFd != -1) {
+		close(listenFd);
+		unlink(path.c_str());
+	}
+}
+
+/**
+ * Creates the listening socket. Stale socket left by the previous server
+ * is replaced.
+ * @return True on success, false on failure.
+ */
+bool ServerPThread::listen() {
+	struct sockaddr_un addr;
+	if (path.size() >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "Path of the socket is too long: %s\n", path.c_str());
+		return false;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path.c_str());
+
+	/* Every session needs its own descriptor */
+	struct rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+
+	struct stat st;
+	if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+		unlink(path.c_str());
+	}
+
+	listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listenFd == -1) {
+		perror("Failed to create server socket - socket()");
+		return false;
+	}
+	if (bind(listenFd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr))
+			== -1) {
+		perror("Failed to bind server socket - bind()");
+		close(listenFd);
+		listenFd = -1;
+		return false;
+	}
+	if (::listen(listenFd, BACKLOG) == -1 || !loop.isOpened()
+			|| !loop.add(listenFd, this)) {
+		perror("Failed to listen on server socket - listen()");
+		close(listenFd);
+		unlink(path.c_str());
+		listenFd = -1;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Main function where server thread runs the event loop.
+ * @return Exit code of this thread.
+ */
+int ServerPThread::run() {
+	int status = EXIT_SUCCESS;
+	pool = new ThreadPool(workerCount, CommandExecutor::STACK_SIZE);
+
+	while (!isStopRequested()) {
+		if (loop.runOnce(REAP_PERIOD) == -1) {
+			status = EXIT_FAILURE;
+			break;
+		}
+		reapOrphans();
+	}
+
+	/* New clients are refused, received lines are run, then remaining
+	 * sessions are closed */
+	loop.remove(listenFd);
+	close(listenFd);
+	unlink(path.c_str());
+	listenFd = -1;
+
+	delete pool;
+	pool = NULL;
+
+	sessionsMonitor.enter();
+	set<Session *> remaining;
+	remaining.swap(sessions);
+	sessionsMonitor.exit();
+
+	for (set<Session *>::iterator it = remaining.begin(); it != remaining.end();
+			++it) {
+		loop.remove((*it)->getFd());
+		delete *it;
+	}
+	reapOrphans();
+
+	return status;
+}
+
+/**
+ * Accepts all pending connections, every connection gets its own session.
+ */
+void ServerPThread::onEvent(uint32_t) {
+	int fd;
+	while ((fd = accept4(listenFd, NULL, NULL, SOCK_CLOEXEC)) != -1) {
+		Session *session = new Session(fd, *this);
+
+		sessionsMonitor.enter();
+		sessions.insert(session);
+		sessionsMonitor.exit();
+
+		if (!loop.add(fd, session, true)) {
+			closeSession(session);
+		}
+	}
+
+	if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+		perror("Failed to accept connection - accept4()");
+	}
+}
+
+/**
+ * Submits the task to the workers.
+ */
+void ServerPThread::submit(Task *task) {
+	pool->submit(task);
+}
+
+/**
+ * Enables events of the session which has been served.
+ */
+void ServerPThread::rearm(Session *session) {
+	if (!loop.rearm(session->getFd(), session)) {
+		closeSession(session);
+	}
+}
+
+/**
+ * Closes connection and deletes the session. Session must not be served
+ * by any other worker.
+ */
+void ServerPThread::closeSession(Session *session) {
+	loop.remove(session->getFd());
+
+	sessionsMonitor.enter();
+	sessions.erase(session);
+	sessionsMonitor.exit();
+
+	delete session;
+}
+
+/**
+ * Passes children of the closed session which have to be reaped.
+ */
+void ServerPThread::addOrphans(const vector<pid_t> &pids) {
+	sessionsMonitor.enter();
+	orphans.insert(orphans.end(), pids.begin(), pids.end());
+	sessionsMonitor.exit();
+}
+
+/**
+ * Wakes up the event loop when stop is requested.
+ */
+void ServerPThread::wakeUp() {
+	loop.wakeUp();
+}
+
+/**
+ * Reaps children of the closed sessions which have exited.
+ */
+void ServerPThread::reapOrphans() {
+	sessionsMonitor.enter();
+	for (size_t i = 0; i < orphans.size();) {
+		if (ForkServer::wait(orphans[i], NULL, NULL, WNOHANG) != 0) {
+			WatchdogPThread::unwatch(orphans[i]);
+			orphans[i] = orphans.back();
+			orphans.pop_back();
+		} else {
+			i++;
+		}
+	}
+	sessionsMonitor.exit();
+}
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       ServerPThread.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines thread serving shell sessions
+//             of the clients connected to the Unix domain socket.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ServerPThread.h
+ *
+ * @brief Header file which defines thread serving shell sessions of
+ *        the clients connected to the Unix domain socket.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef SERVERPTHREAD_H_INCLUDED
+#define SERVERPTHREAD_H_INCLUDED
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "PThread.h"
+#include "EventLoop.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+class Session;
+
+/**
+ * Thread which accepts connections and runs the event loop of all sessions.
+ * Received lines are run by the pool of workers. Workers wait for
+ * the foreground children, so there are more of them than CPUs.
+ */
+class ServerPThread: public PThread, public EventHandler {
+public:
+	static const int WORKERS_PER_CPU = 4;
+
+	ServerPThread(const string &path, int workerCount = 0);
+	virtual ~ServerPThread();
+
+	bool listen();
+	virtual int run();
+	virtual void onEvent(uint32_t events);
+
+	void submit(Task *task);
+	void rearm(Session *session);
+	void closeSession(Session *session);
+	void addOrphans(const vector<pid_t> &pids);
+private:
+	static const int REAP_PERIOD = 1000; /**< milliseconds between reaping of orphans */
+	static const int BACKLOG = 128;
+
+	string path;
+	int workerCount;
+	int listenFd;
+	EventLoop loop;
+	ThreadPool *pool; /**< Created by the running thread */
+
+	PThreadMonitor sessionsMonitor;
+	set<Session *> sessions;
+	vector<pid_t> orphans; /**< background children of closed sessions */
+
+	void wakeUp();
+	void reapOrphans();
+};
+
+#endif // SERVERPTHREAD_H_INCLUDED
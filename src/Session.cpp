@@ -0,0 +1,191 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       Session.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements shell session of the client
+//             connected to the server.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Session.cpp
+ *
+ * @brief Source file which implements shell session of the client connected
+ *        to the server.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cerrno>
+#include <cstdlib>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "ThreadPool.h"
+#include "ServerPThread.h"
+#include "Session.h"
+
+using namespace std;
+
+/**
+ * Task which serves received data of the session.
+ */
+class SessionTask: public Task {
+public:
+	SessionTask(Session &session, ServerPThread &server) :
+			Task(true), session(session), server(server) {
+	}
+	virtual int run() {
+		if (session.serve()) {
+			server.rearm(&session);
+		} else {
+			server.closeSession(&session);
+		}
+		return 0;
+	}
+private:
+	Session &session;
+	ServerPThread &server;
+};
+
+/**
+ * Constructor.
+ * @param fd Socket of the connection, it is closed by the session.
+ * @param server Server which runs the session.
+ */
+Session::Session(int fd, ServerPThread &server) :
+		CommandExecutor(jobs), fd(fd), server(server), jobs(MAX_JOBS) {
+	out = &outStream;
+	err = &errStream;
+}
+
+/**
+ * Destructor, closes the connection. Children which have not exited
+ * are reaped by the server.
+ */
+Session::~Session() {
+	vector<pid_t> running;
+	jobs.reap();
+	jobs.release(running);
+	server.addOrphans(running);
+	close(fd);
+}
+
+/**
+ * Returns socket of the connection.
+ */
+int Session::getFd() const {
+	return fd;
+}
+
+/**
+ * Data has been received or the connection has been closed, the session
+ * is served by the worker. Descriptor is registered as one-shot, so no
+ * other event comes until the worker rearms it.
+ */
+void Session::onEvent(uint32_t) {
+	server.submit(new SessionTask(*this, server));
+}
+
+/**
+ * Reads data from the socket and runs the whole lines.
+ * @return False when the connection has been closed or exit has been run.
+ */
+bool Session::serve() {
+	char data[READ_SIZE];
+	ssize_t count = read(fd, data, sizeof(data));
+	if (count == -1 && errno == EINTR) {
+		return true;
+	} else if (count <= 0) { // The last line does not need to be terminated
+		if (!input.empty()) {
+			runLine(input);
+		}
+		return false;
+	}
+	input.append(data, count);
+
+	size_t start = 0, end;
+	while ((end = input.find('\n', start)) != string::npos) {
+		string line = input.substr(start, end - start);
+		start = end + 1;
+		if (!runLine(line)) {
+			return false;
+		}
+	}
+	input.erase(0, start);
+
+	if (input.size() > MAX_LINE) {
+		input.clear();
+		*err << "Line is too long!" << endl;
+		return flush();
+	}
+	return true;
+}
+
+/**
+ * Flushes output of the builtins, so it precedes output of the child.
+ * @param commandLine Command line with expanded variables.
+ * @return Exit status of the command.
+ */
+int Session::runCommand(const string &commandLine) {
+	flush();
+	return CommandExecutor::runCommand(commandLine);
+}
+
+/**
+ * Connects stdout and stderr of the child to the socket.
+ * @param fds Array of three descriptors which will be filled.
+ */
+void Session::getChildDescriptors(int *fds) {
+	fds[0] = devnull_fd;
+	fds[1] = fd;
+	fds[2] = fd;
+}
+
+/**
+ * Runs the line and sends its output.
+ * @param line Received line without the new line character.
+ * @return False when exit has been run or the output cannot be sent.
+ */
+bool Session::runLine(const string &line) {
+	reportFinishedJobs();
+
+	lineSeq++;
+	interpreter.feed(line);
+
+	return flush() && !interpreter.exitRequested();
+}
+
+/**
+ * Sends collected output of the builtins and the interpreter.
+ * @return False when the connection has been closed.
+ */
+bool Session::flush() {
+	return send(outStream) && send(errStream);
+}
+
+/**
+ * Sends content of the stream and clears it.
+ * @return False when the connection has been closed.
+ */
+bool Session::send(ostringstream &stream) {
+	string data = stream.str();
+	stream.str("");
+
+	size_t sent = 0;
+	while (sent < data.size()) {
+		ssize_t count = ::send(fd, data.data() + sent, data.size() - sent,
+				MSG_NOSIGNAL);
+		if (count == -1 && errno == EINTR) {
+			continue;
+		} else if (count == -1) {
+			return false;
+		}
+		sent += count;
+	}
+	return true;
+}
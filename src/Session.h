@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       Session.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines shell session of the client
+//             connected to the server.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Session.h
+ *
+ * @brief Header file which defines shell session of the client connected
+ *        to the server.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef SESSION_H_INCLUDED
+#define SESSION_H_INCLUDED
+
+#include <sstream>
+#include <string>
+
+#include "CommandExecutor.h"
+#include "EventLoop.h"
+#include "JobTable.h"
+
+using namespace std;
+
+class ServerPThread;
+
+/**
+ * Session of one connection - its own variables, functions, working
+ * directory and children. Lines received from the socket are run by
+ * the workers of the server, only one worker serves the session at a time.
+ * Output of the builtins is collected and sent before the next command
+ * starts, children write directly into the socket and their stdin
+ * is /dev/null. No prompt is sent.
+ */
+class Session: public CommandExecutor, public EventHandler {
+public:
+	Session(int fd, ServerPThread &server);
+	virtual ~Session();
+
+	int getFd() const;
+	virtual void onEvent(uint32_t events);
+	bool serve();
+	virtual int runCommand(const string &commandLine);
+protected:
+	virtual void getChildDescriptors(int *fds);
+private:
+	static const size_t MAX_LINE = 4096;
+	static const int MAX_JOBS = 16;
+	static const size_t READ_SIZE = 4096;
+
+	int fd;
+	ServerPThread &server;
+	JobTable jobs;
+	string input; /**< received data without the whole line */
+	ostringstream outStream;
+	ostringstream errStream;
+
+	bool runLine(const string &line);
+	bool flush();
+	bool send(ostringstream &stream);
+};
+
+#endif // SESSION_H_INCLUDED
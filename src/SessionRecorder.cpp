@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       SessionRecorder.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements recording of the lines run by
+//             the shell for their later replay.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file SessionRecorder.cpp
+ *
+ * @brief Source file which implements recording of the lines run by the shell
+ *        for their later replay.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cerrno>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "SessionRecorder.h"
+
+using namespace std;
+
+int SessionRecorder::fd = -1;
+uint64_t SessionRecorder::origin = 0;
+
+/**
+ * Starts recording into the file, the file is truncated.
+ * @param fileName Name of the log.
+ * @return True on success, false if the file cannot be opened.
+ */
+bool SessionRecorder::open(const string &fileName) {
+	fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+			0644);
+	if (fd == -1) {
+		perror("Failed to open session record - open()");
+		return false;
+	}
+	origin = now();
+	return true;
+}
+
+/**
+ * Tests whether lines are recorded.
+ */
+bool SessionRecorder::isEnabled() {
+	return fd >= 0;
+}
+
+/**
+ * Stops recording.
+ */
+void SessionRecorder::close() {
+	if (fd >= 0) {
+		::close(fd);
+		fd = -1;
+	}
+}
+
+/**
+ * Returns monotonic time in nanoseconds.
+ */
+uint64_t SessionRecorder::now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+/**
+ * Appends the line into the log, whole record is written at once.
+ * @param takenAt Time when the execute thread has taken the line, see now().
+ * @param line Line without the terminating newline.
+ * @param complete False if the line is followed by the rest of the command.
+ */
+void SessionRecorder::record(uint64_t takenAt, const string &line,
+		bool complete) {
+	if (fd < 0) {
+		return;
+	}
+
+	char offset[48];
+	snprintf(offset, sizeof(offset), "%.6f %c ",
+			(takenAt - origin) / 1e9, complete ? '.' : '+');
+	string record = offset + line + "\n";
+
+	size_t written = 0;
+	while (written < record.size()) {
+		ssize_t ret = write(fd, record.data() + written,
+				record.size() - written);
+		if (ret < 0 && errno == EINTR) {
+			continue;
+		} else if (ret < 0) {
+			perror("Failed to write session record - write()");
+			return;
+		}
+		written += ret;
+	}
+}
@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       SessionRecorder.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines recording of the lines run by
+//             the shell for their later replay.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file SessionRecorder.h
+ *
+ * @brief Header file which defines recording of the lines run by the shell
+ *        for their later replay.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef SESSIONRECORDER_H_INCLUDED
+#define SESSIONRECORDER_H_INCLUDED
+
+#include <string>
+
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ * Log of the lines taken by the execute thread, one record per line:
+ *  OFFSET FLAG LINE
+ * OFFSET are seconds since the start of the recording when the line was
+ * taken, FLAG is '.' when the line completes a command or '+' when
+ * the interpreter needs more lines (compound command). Lines are written
+ * after history expansion, so the log replays without the history.
+ */
+class SessionRecorder {
+public:
+	static bool open(const string &fileName);
+	static bool isEnabled();
+	static void close();
+
+	static uint64_t now();
+	static void record(uint64_t takenAt, const string &line, bool complete);
+private:
+	static int fd;
+	static uint64_t origin; /**< monotonic nanoseconds of the start */
+};
+
+#endif // SESSIONRECORDER_H_INCLUDED
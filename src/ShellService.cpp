@@ -17,40 +17,67 @@
  */
 
 #include <cstdio>
+#include <cerrno>
 
 #include <signal.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 
+#include "Trace.h"
+#include "ForkServer.h"
+#include "WatchdogPThread.h"
+#include "PeriodicPThread.h"
+#include "ChangeWatcherPThread.h"
+#include "CommandIndex.h"
+#include "EventStream.h"
+#include "SessionRecorder.h"
+#include "Scheduling.h"
 #include "ShellService.h"
 
-ShellService ShellService::instance;
-
 /**
- * Constructor.
+ * Constructor, threads of the service are created when it is started.
  */
 ShellService::ShellService() :
-		initFailed(false), buffer(vector<char>(BUFFER_SIZE)), bufferMonitor(
-				PThreadMonitor()), readThread(
-				ReadPThread(buffer, bufferMonitor)), executeThread(
-				ExecutePThread(buffer, bufferMonitor)) {
+		initFailed(false), buffer(BUFFER_SIZE), bufferMonitor(
+				"buffer"), bufferFilled(bufferMonitor, "filled"), bufferEmptied(
+				bufferMonitor, "emptied"), readThread(
+				buffer, bufferMonitor, bufferFilled, bufferEmptied), executeThread(
+				buffer, bufferMonitor, bufferFilled, bufferEmptied), metricsWriter(NULL), traceWriter(NULL), server(NULL), history(NULL), interrupted(0) {
+	finishFd = eventfd(0, EFD_CLOEXEC);
+	initFailed = (finishFd == -1);
+	if (initFailed) {
+		perror("Failed to create finish descriptor - eventfd()");
+	}
+}
 
+/**
+ * Callback function which captures end of the read or execute thread.
+ */
+void ShellService::threadFinished(int, void *service) {
+	static_cast<ShellService *>(service)->terminate();
 }
 
 /**
- * Callback function which captures end of the read thread.
+ * Wakes up run(), so the service is stopped. It only writes into eventfd,
+ * so it can be called from the threads of the service and signal handlers.
  */
-void ShellService::readThreadFinished() {
-	instance.executeThread.cancel();
-	instance.fireFinishCallbacks(instance.readThread.getRetCode());
+void ShellService::terminate() {
+	uint64_t one = 1;
+	if (write(finishFd, &one, sizeof(one)) == -1) {
+		perror("Failed to finish shell service - write()");
+	}
 }
 
 /**
- * Callback function which captures end of the execute thread.
+ * Wakes up run() like terminate(), but the running command is terminated
+ * instead of waited for. Can be called from signal handlers.
  */
-void ShellService::executeThreadFinished() {
-	instance.readThread.cancel();
-	instance.fireFinishCallbacks(instance.executeThread.getRetCode());
+void ShellService::interrupt() {
+	interrupted = 1;
+	terminate();
 }
 
 /**
@@ -82,38 +109,182 @@ void ShellService::removeOnFinishCallback(OnFinishCallback callback) {
 }
 
 /**
- * Returns singleton instance of this service.
+ * Returns singleton instance of this service, it is constructed by the first
+ * call, so not before main() and after the statics it depends on.
  * @return Instance of this service object.
  */
 ShellService &ShellService::getInstance() {
+	static ShellService instance;
 	return instance;
 }
 
 /**
  * Starts shell service.
+ * @param options Options of the shell.
  * @return True on succes, otherwise false.
  */
-bool ShellService::start() {
+bool ShellService::start(const ShellOptions &options) {
+	if (!initFailed && options.forkServer) { // Before the state is allocated
+		initFailed = !ForkServer::start();
+	}
+
+	if (!initFailed && !options.timingLog.empty()) {
+		initFailed = !executeThread.setTimingLog(options.timingLog);
+	}
+
+	if (!initFailed && options.eventFd >= 0) {
+		initFailed = !EventStream::open(options.eventFd);
+	}
+
+	if (!initFailed && !options.traceFile.empty()) {
+		initFailed = !Trace::open(options.traceFile);
+	}
+
+	if (!initFailed && !options.serverSocket.empty()) {
+		server = new ServerPThread(options.serverSocket, options.workers);
+		initFailed = !server->listen();
+	}
+
+	if (!initFailed && !options.recordFile.empty()) {
+		initFailed = !SessionRecorder::open(options.recordFile);
+	}
+
+	if (!initFailed && server == NULL && !options.historyFile.empty()) {
+		history = new History();
+		initFailed = !history->open(options.historyFile);
+		executeThread.setHistory(history);
+	}
+
+	if (!initFailed && !options.pinCpus.empty()) {
+		initFailed = !pinThreads(options.pinCpus);
+	}
+
 	if (!initFailed) {
-		//  stop();
+		readThread.getCompletion().addCallback(threadFinished, this);
+		executeThread.getCompletion().addCallback(threadFinished, this);
 
-		/*readThread = ReadPThread(buffer, bufferMonitor),
-		 executeThread = ExecutePThread(buffer, bufferMonitor);    */
+		if (!options.metricsFile.empty()) {
+			metricsWriter = new MetricsWriterPThread();
+			metricsWriter->configure(options.metricsFile,
+					options.metricsInterval);
+			metricsWriter->start();
+		}
 
-		readThread.addOnFinishCallback(readThreadFinished);
-		executeThread.addOnFinishCallback(executeThreadFinished);
+		if (Trace::isEnabled()) {
+			traceWriter = new TraceWriterPThread();
+			traceWriter->start();
+		}
 
-		executeThread.start();
-		readThread.startReading();
+		if (server != NULL) { // Terminal is not read in server mode
+			server->getCompletion().addCallback(threadFinished, this);
+			server->start();
+		} else {
+			executeThread.start();
+			readThread.startReading();
+		}
 	}
 
 	return !initFailed;
 }
 
 /**
- * Stops shell service.
+ * Pins the reader to the first of the CPUs and the executor to the second
+ * one, so the handoff of the lines does not migrate them. With one CPU both
+ * share it.
+ * @param value List of the CPUs, e.g. 2,3.
+ * @return False if the list is invalid.
+ */
+bool ShellService::pinThreads(const string &value) {
+	SchedAttrs attrs;
+	string error;
+	Scheduling::clear(attrs);
+	if (!Scheduling::parseOption("-c", value, attrs, error)) {
+		cerr << "Pinning of threads: " << error << endl;
+		return false;
+	}
+
+	/* Threads cannot be started on the CPUs outside of the process */
+	cpu_set_t allowed, reader, executor;
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+		CPU_AND(&attrs.cpus, &attrs.cpus, &allowed);
+	}
+	if (CPU_COUNT(&attrs.cpus) == 0) {
+		cerr << "Pinning of threads: no CPU of " << value
+				<< " is available" << endl;
+		return false;
+	}
+
+	CPU_ZERO(&reader);
+	CPU_ZERO(&executor);
+	for (int cpu = 0, found = 0; cpu < CPU_SETSIZE && found < 2; cpu++) {
+		if (CPU_ISSET(cpu, &attrs.cpus)) {
+			CPU_SET(cpu, (found++ == 0) ? &reader : &executor);
+		}
+	}
+	if (CPU_COUNT(&executor) == 0) {
+		executor = reader;
+	}
+
+	readThread.pin(reader);
+	executeThread.pin(executor);
+	return true;
+}
+
+/**
+ * Waits until the service ends, stops it and fires finish callbacks.
+ * Service ends when any of its threads finishes or terminate() is called.
+ * @return Exit code of the service.
+ */
+int ShellService::run() {
+	uint64_t value;
+	while (read(finishFd, &value, sizeof(value)) == -1 && errno == EINTR) {
+	}
+
+	stop();
+
+	/* End of input finishes with status of the last command */
+	int code = readThread.getRetCode();
+	code = (code != 0) ? code : executeThread.getRetCode();
+	code = (server != NULL) ? server->getRetCode() : code;
+	fireFinishCallbacks(code);
+	return code;
+}
+
+/**
+ * Stops shell service and waits until all its threads are finished.
+ * Must not be called by the threads of the service, see terminate().
+ * Server waits until the running lines of its sessions finish, so does
+ * the executor unless the service is interrupted.
+ * Commands waiting for changes of the files return.
+ * Writers are stopped last, so they write the final state.
  */
 void ShellService::stop() {
-	executeThread.cancel();
-	readThread.cancel();
+	ChangeWatcherPThread::stopAll(); // Executor may wait for a change
+	if (interrupted) {
+		executeThread.interrupt();
+	}
+	readThread.requestStop();
+	executeThread.requestStop();
+	readThread.join();
+	executeThread.join();
+
+	executeThread.setHistory(NULL);
+	delete history;
+	history = NULL;
+	SessionRecorder::close();
+
+	if (server != NULL) {
+		server->cancel();
+	}
+	WatchdogPThread::stop();
+	PeriodicPThread::stop();
+	CommandIndex::stop();
+	ForkServer::stop();
+
+	if (metricsWriter != NULL) {
+		metricsWriter->cancel();
+	}
+	if (traceWriter != NULL) {
+		traceWriter->cancel();
+	}
 }
@@ -21,11 +21,38 @@
 
 #include <set>
 
+#include <signal.h>
+
 #include "ReadPThread.h"
 #include "ExecutePThread.h"
+#include "MetricsWriterPThread.h"
+#include "TraceWriterPThread.h"
+#include "ServerPThread.h"
 
 using namespace std;
 
+/**
+ * Options of the shell service given on the command line.
+ */
+struct ShellOptions {
+	ShellOptions() :
+			metricsInterval(MetricsWriterPThread::DEFAULT_INTERVAL), eventFd(-1), workers(
+					0), forkServer(false) {
+	}
+
+	string timingLog; /**< log of resource usage of every command */
+	string metricsFile; /**< file where metrics are periodically written */
+	int metricsInterval; /**< seconds between writes of metrics */
+	string traceFile; /**< binary file where spans of trace points are written */
+	int eventFd; /**< descriptor of the event stream, -1 when disabled */
+	string serverSocket; /**< sessions are served on this socket instead of terminal */
+	int workers; /**< workers running lines of the sessions, 0 for default */
+	bool forkServer; /**< children are forked by the helper process */
+	string historyFile; /**< lines of the terminal are kept here, empty none */
+	string recordFile; /**< lines of the terminal are recorded here, empty none */
+	string pinCpus; /**< CPUs of the reader and the executor, empty unpinned */
+};
+
 /*
  * Singleton class which starts or stops service of the shell.
  */
@@ -35,31 +62,41 @@ public:
 
 	static ShellService &getInstance();
 
-	bool start();
+	bool start(const ShellOptions &options);
+	int run();
 	void stop();
+	void terminate();
+	void interrupt();
 
 	void addOnFinishCallback(OnFinishCallback callback);
 	void removeOnFinishCallback(OnFinishCallback callback);
 
 private:
 	ShellService();
-	static ShellService instance;
 
 	static const int BUFFER_SIZE = 513;
 
 	bool initFailed;
 	vector<char> buffer;
 	PThreadMonitor bufferMonitor;
+	PThreadCondition bufferFilled;
+	PThreadCondition bufferEmptied;
 	ReadPThread readThread;
 	ExecutePThread executeThread;
+	MetricsWriterPThread *metricsWriter; /**< Created only when metrics are written */
+	TraceWriterPThread *traceWriter; /**< Created only when tracing */
+	ServerPThread *server; /**< Created only in server mode */
+	History *history; /**< Created only when history is kept */
 	set<OnFinishCallback> onFinishCallbacks;
 	bool finished;
 	sigset_t orig_sigmask;
+	int finishFd; /**< eventfd which wakes up run() when service should end */
+	volatile sig_atomic_t interrupted; /**< running command is terminated */
 
 	void fireFinishCallbacks(int code);
+	bool pinThreads(const string &value);
 
-	static void readThreadFinished();
-	static void executeThreadFinished();
+	static void threadFinished(int result, void *service);
 };
 
 #endif // SHELLSERVICE_H_INCLUDED
@@ -0,0 +1,279 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       TaskGraph.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements dependency graph of the tasks
+//             run by the tasks builtin.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file TaskGraph.cpp
+ *
+ * @brief Source file which implements dependency graph of the tasks run by
+ *        the tasks builtin.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <sys/stat.h>
+
+#include "TaskGraph.h"
+
+using namespace std;
+
+/**
+ * Returns modification time of the file.
+ * @param path Path of the file.
+ * @param mtime Set to the modification time.
+ * @return False if the file does not exist.
+ */
+static bool modified(const string &path, struct timespec &mtime) {
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) {
+		return false;
+	}
+	mtime = st.st_mtim;
+	return true;
+}
+
+/**
+ * Reads rules of the tasks from the file.
+ * @param fileName Path of the file.
+ * @param error Set to the description of the error.
+ * @return False if the file cannot be read or a rule is invalid.
+ */
+bool TaskGraph::load(const string &fileName, string &error) {
+	ifstream in(fileName.c_str());
+	if (!in) {
+		error = fileName + ": Cannot be read";
+		return false;
+	}
+
+	string text;
+	for (int line = 1; getline(in, text); line++) {
+		stringstream where;
+		where << fileName << ":" << line << ": ";
+
+		text = text.substr(0, text.find('#'));
+		if (text.find_first_not_of(" \t\r") == string::npos) {
+			continue;
+		}
+
+		if (text[0] == ' ' || text[0] == '\t') { // Command of the rule
+			if (tasks.empty()) {
+				error = where.str() + "Command without rule";
+				return false;
+			}
+			size_t start = text.find_first_not_of(" \t");
+			tasks.back().commands.push_back(
+					text.substr(start, text.find_last_not_of(" \t\r") + 1 - start));
+			continue;
+		}
+
+		size_t colon = text.find(':');
+		stringstream words(text.substr(0, (colon != string::npos) ? colon : 0));
+		GraphTask task;
+		string extra;
+		if (colon == string::npos || !(words >> task.target) || words >> extra) {
+			error = where.str() + "Expected TARGET: [DEP...]";
+			return false;
+		}
+		if (indexes.count(task.target) > 0) {
+			error = where.str() + "Target " + task.target + " is defined twice";
+			return false;
+		}
+
+		words.clear();
+		words.str(text.substr(colon + 1));
+		for (string dep; words >> dep;) {
+			task.deps.push_back(dep);
+		}
+		task.waiting = 0;
+		task.priority = 0;
+		task.selected = task.ran = false;
+		indexes[task.target] = tasks.size();
+		tasks.push_back(task);
+	}
+	return true;
+}
+
+/**
+ * Selects the tasks needed by the targets, counts their dependencies and
+ * computes their priorities.
+ * @param targets Requested targets, all tasks when empty.
+ * @param cwd Directory of the relative paths.
+ * @param error Set to the description of the error.
+ * @return False on unknown target, missing file or dependency cycle.
+ */
+bool TaskGraph::select(const vector<string> &targets, const string &cwd,
+		string &error) {
+	vector<size_t> stack;
+	for (size_t i = 0; i < targets.size(); i++) {
+		map<string, size_t>::iterator it = indexes.find(targets[i]);
+		if (it == indexes.end()) {
+			error = "No rule for target " + targets[i];
+			return false;
+		}
+		stack.push_back(it->second);
+	}
+	for (size_t i = 0; targets.empty() && i < tasks.size(); i++) {
+		stack.push_back(i);
+	}
+
+	/* Dependencies of the selected tasks are selected too */
+	while (!stack.empty()) {
+		GraphTask &task = tasks[stack.back()];
+		size_t index = stack.back();
+		stack.pop_back();
+		if (task.selected) {
+			continue;
+		}
+		task.selected = true;
+		for (size_t d = 0; d < task.deps.size(); d++) {
+			const string &dep = task.deps[d];
+			map<string, size_t>::iterator it = indexes.find(dep);
+			struct timespec mtime;
+			if (it != indexes.end()) {
+				tasks[it->second].dependents.push_back(index);
+				task.waiting++;
+				stack.push_back(it->second);
+			} else if (!modified((dep[0] == '/') ? dep : cwd + "/" + dep, mtime)) {
+				error = "No rule for " + dep + " needed by " + task.target;
+				return false;
+			}
+		}
+	}
+
+	/* Topological order, tasks left with dependencies are in a cycle */
+	vector<size_t> order, waiting(tasks.size());
+	for (size_t i = 0; i < tasks.size(); i++) {
+		waiting[i] = tasks[i].waiting;
+		if (tasks[i].selected && waiting[i] == 0) {
+			order.push_back(i);
+		}
+	}
+	for (size_t i = 0; i < order.size(); i++) {
+		const vector<size_t> &dependents = tasks[order[i]].dependents;
+		for (size_t d = 0; d < dependents.size(); d++) {
+			if (--waiting[dependents[d]] == 0) {
+				order.push_back(dependents[d]);
+			}
+		}
+	}
+	for (size_t i = 0; i < tasks.size(); i++) {
+		if (tasks[i].selected && waiting[i] > 0) {
+			error = "Dependency cycle through " + tasks[i].target;
+			return false;
+		}
+	}
+
+	/* Priority is the longest path to the end in reverse order */
+	for (size_t i = order.size(); i-- > 0;) {
+		GraphTask &task = tasks[order[i]];
+		long longest = 0;
+		for (size_t d = 0; d < task.dependents.size(); d++) {
+			longest = max(longest, tasks[task.dependents[d]].priority);
+		}
+		task.priority = (long) task.commands.size() + longest;
+	}
+
+	for (size_t i = 0; i < tasks.size(); i++) {
+		if (tasks[i].selected && tasks[i].waiting == 0) {
+			ready.push(make_pair(tasks[i].priority, -(long) i));
+		}
+	}
+	return true;
+}
+
+/**
+ * Takes the ready task with the longest critical path.
+ * @param task Set to the index of the task.
+ * @return False when no task is ready.
+ */
+bool TaskGraph::takeReady(size_t &task) {
+	if (ready.empty()) {
+		return false;
+	}
+	task = -ready.top().second;
+	ready.pop();
+	return true;
+}
+
+/**
+ * Finishes the task, its dependents without other dependencies become
+ * ready. Dependents of the failed task are never finished.
+ * @param task Index of the task.
+ * @param ran Whether its commands have run. Task without commands has run
+ *        when any of its dependencies has.
+ */
+void TaskGraph::finish(size_t task, bool ran) {
+	GraphTask &graphTask = tasks[task];
+	for (size_t d = 0; !ran && graphTask.commands.empty()
+			&& d < graphTask.deps.size(); d++) {
+		map<string, size_t>::iterator it = indexes.find(graphTask.deps[d]);
+		ran = it != indexes.end() && tasks[it->second].ran;
+	}
+	graphTask.ran = ran;
+
+	for (size_t d = 0; d < graphTask.dependents.size(); d++) {
+		GraphTask &dependent = tasks[graphTask.dependents[d]];
+		if (--dependent.waiting == 0) {
+			ready.push(
+					make_pair(dependent.priority,
+							-(long) graphTask.dependents[d]));
+		}
+	}
+}
+
+/**
+ * Tests whether the target of the task is up to date - its file exists,
+ * it is not older than any dependency and no dependency has run.
+ * @param task Index of the task.
+ * @param cwd Directory of the relative paths.
+ * @return False when the task has to run.
+ */
+bool TaskGraph::isUpToDate(size_t task, const string &cwd) const {
+	const GraphTask &graphTask = tasks[task];
+	struct timespec stamp, mtime;
+	if (graphTask.commands.empty()
+			|| !modified((graphTask.target[0] == '/') ?
+					graphTask.target : cwd + "/" + graphTask.target, stamp)) {
+		return false;
+	}
+
+	for (size_t d = 0; d < graphTask.deps.size(); d++) {
+		const string &dep = graphTask.deps[d];
+		map<string, size_t>::const_iterator it = indexes.find(dep);
+		if (it != indexes.end() && tasks[it->second].ran) {
+			return false;
+		}
+		if (modified((dep[0] == '/') ? dep : cwd + "/" + dep, mtime)
+				&& (mtime.tv_sec > stamp.tv_sec
+						|| (mtime.tv_sec == stamp.tv_sec
+								&& mtime.tv_nsec > stamp.tv_nsec))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Returns number of the tasks.
+ */
+size_t TaskGraph::size() const {
+	return tasks.size();
+}
+
+/**
+ * Returns task of the index.
+ */
+GraphTask &TaskGraph::operator[](size_t task) {
+	return tasks[task];
+}
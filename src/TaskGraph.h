@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       TaskGraph.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines dependency graph of the tasks run
+//             by the tasks builtin.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file TaskGraph.h
+ *
+ * @brief Header file which defines dependency graph of the tasks run by
+ *        the tasks builtin.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef TASKGRAPH_H_INCLUDED
+#define TASKGRAPH_H_INCLUDED
+
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Task of the graph, its commands run one after another.
+ */
+typedef struct {
+	string target; /**< name, file of the target is its stamp */
+	vector<string> deps; /**< tasks and files the task depends on */
+	vector<string> commands;
+	vector<size_t> dependents; /**< indexes of the tasks depending on it */
+	size_t waiting; /**< dependencies which have not finished */
+	long priority; /**< commands on the longest path to the end of graph */
+	bool selected; /**< needed by the requested targets */
+	bool ran; /**< commands have run, dependents are not up to date */
+} GraphTask;
+
+/**
+ * Dependency graph of the tasks read from the file of rules:
+ *  TARGET: [DEP...]
+ *  	COMMAND
+ * Indented lines are commands of the preceding rule, # starts a comment.
+ * Dependency which is not a target has to be an existing file. Relative
+ * paths are resolved in the working directory of the session. Ready tasks
+ * are taken by their critical path, so the longest chains start first,
+ * ties in the order of the file.
+ */
+class TaskGraph {
+public:
+	bool load(const string &fileName, string &error);
+	bool select(const vector<string> &targets, const string &cwd,
+			string &error);
+	bool isUpToDate(size_t task, const string &cwd) const;
+	bool takeReady(size_t &task);
+	void finish(size_t task, bool ran);
+
+	size_t size() const;
+	GraphTask &operator[](size_t task);
+private:
+	vector<GraphTask> tasks; /**< in the order of the file */
+	map<string, size_t> indexes; /**< by target */
+	priority_queue<pair<long, long> > ready; /**< priority and -index */
+};
+
+#endif // TASKGRAPH_H_INCLUDED
@@ -0,0 +1,221 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       ThreadPool.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements pool of worker threads running
+//             submitted tasks.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ThreadPool.cpp
+ *
+ * @brief Source file which implements pool of worker threads running
+ *        submitted tasks.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdio>
+
+#include <signal.h>
+#include <unistd.h>
+
+#include "ThreadPool.h"
+
+using namespace std;
+
+__thread ThreadPool *ThreadPool::currentPool = NULL;
+__thread int ThreadPool::currentWorker = -1;
+
+/**
+ * Worker thread of the pool.
+ */
+class ThreadPool::Worker: public PThread {
+public:
+	Worker(ThreadPool &pool, int index, size_t stackSize) :
+			pool(pool), index(index) {
+		setStackSize(stackSize);
+	}
+	virtual ~Worker() {
+		cancel();
+	}
+
+	/**
+	 * Runs tasks until stop is requested and no task is left.
+	 */
+	virtual int run() {
+		currentPool = &pool;
+		currentWorker = index;
+
+		while (1) {
+			Task *task = pool.take(index);
+			if (task != NULL) {
+				/* Submitter can delete its task once it has finished */
+				bool autoDelete = task->isAutoDelete();
+				int result = task->run();
+				task->getCompletion().finish(result);
+				if (autoDelete) {
+					delete task;
+				}
+				continue;
+			}
+			if (isStopRequested()) {
+				break;
+			}
+			pool.waitForWork(*this);
+		}
+
+		return 0;
+	}
+private:
+	ThreadPool &pool;
+	int index;
+
+	/**
+	 * Wakes up the worker blocked without work when its stop is requested.
+	 */
+	virtual void wakeUp() {
+		pool.idleMonitor.enter();
+		pool.workAvailable.broadcast();
+		pool.idleMonitor.exit();
+	}
+};
+
+/**
+ * Constructor, starts the workers.
+ * @param workerCount Number of workers, 0 for number of online CPUs.
+ * @param stackSize Size of the stack of every worker.
+ */
+ThreadPool::ThreadPool(int workerCount, size_t stackSize) :
+		idleMonitor("pool.idle"), workAvailable(idleMonitor, "work"), pending(
+				0), sleepers(0), nextQueue(0), stolen(0) {
+	if (workerCount <= 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		workerCount = (cpus > 0) ? cpus : 1;
+	}
+
+	queues.resize(workerCount);
+	for (int i = 0; i < workerCount; i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "pool.queue%d", i);
+		queues[i].monitor = new PThreadMonitor(name);
+	}
+
+	for (int i = 0; i < workerCount; i++) {
+		workers.push_back(new Worker(*this, i, stackSize));
+		workers.back()->start();
+	}
+}
+
+/**
+ * Destructor, runs the queued tasks and stops the workers.
+ */
+ThreadPool::~ThreadPool() {
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i]->requestStop();
+	}
+	for (size_t i = 0; i < workers.size(); i++) {
+		delete workers[i];
+	}
+	for (size_t i = 0; i < queues.size(); i++) {
+		delete queues[i].monitor;
+	}
+}
+
+/**
+ * Submits the task, it is run by some of the workers.
+ * @param task Task which has to live until its completion finishes.
+ */
+void ThreadPool::submit(Task *task) {
+	int queue;
+	if (currentPool == this) { // Subtask is run by the same worker if not stolen
+		queue = currentWorker;
+	} else {
+		queue = __atomic_fetch_add(&nextQueue, 1, __ATOMIC_RELAXED)
+				% queues.size();
+	}
+
+	queues[queue].monitor->enter();
+	queues[queue].tasks.push_back(task);
+	__atomic_add_fetch(&pending, 1, __ATOMIC_SEQ_CST);
+	queues[queue].monitor->exit();
+
+	/* Pairs with waitForWork(), either the sleeper sees the task or we see it */
+	if (__atomic_load_n(&sleepers, __ATOMIC_SEQ_CST) > 0) {
+		idleMonitor.enter();
+		workAvailable.signal();
+		idleMonitor.exit();
+	}
+}
+
+/**
+ * Returns number of workers of the pool.
+ */
+int ThreadPool::getWorkerCount() const {
+	return workers.size();
+}
+
+/**
+ * Returns number of tasks taken from the deque of other worker.
+ */
+unsigned long ThreadPool::getStolen() const {
+	return __atomic_load_n(&stolen, __ATOMIC_RELAXED);
+}
+
+/**
+ * Takes the newest task of the worker or steals the oldest task of others.
+ * @param worker Index of the worker.
+ * @return Task or NULL when all deques are empty.
+ */
+Task *ThreadPool::take(int worker) {
+	Task *task = pop(worker, true);
+	for (size_t i = 1; task == NULL && i < queues.size(); i++) {
+		task = pop((worker + i) % queues.size(), false);
+		if (task != NULL) {
+			__atomic_add_fetch(&stolen, 1, __ATOMIC_RELAXED);
+		}
+	}
+	return task;
+}
+
+/**
+ * Pops the task from the deque.
+ * @param queue Index of the deque.
+ * @param back Whether the newest task is popped, otherwise the oldest one.
+ * @return Task or NULL when the deque is empty.
+ */
+Task *ThreadPool::pop(int queue, bool back) {
+	Task *task = NULL;
+
+	queues[queue].monitor->enter();
+	deque<Task *> &tasks = queues[queue].tasks;
+	if (!tasks.empty()) {
+		task = back ? tasks.back() : tasks.front();
+		if (back) {
+			tasks.pop_back();
+		} else {
+			tasks.pop_front();
+		}
+		__atomic_sub_fetch(&pending, 1, __ATOMIC_SEQ_CST);
+	}
+	queues[queue].monitor->exit();
+
+	return task;
+}
+
+/**
+ * Blocks the worker until some task is queued or its stop is requested.
+ */
+void ThreadPool::waitForWork(Worker &worker) {
+	idleMonitor.enter();
+	__atomic_add_fetch(&sleepers, 1, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&pending, __ATOMIC_SEQ_CST) == 0
+			&& !worker.isStopRequested()) {
+		workAvailable.wait();
+	}
+	__atomic_sub_fetch(&sleepers, 1, __ATOMIC_SEQ_CST);
+	idleMonitor.exit();
+}
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       ThreadPool.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines pool of worker threads running
+//             submitted tasks.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ThreadPool.h
+ *
+ * @brief Header file which defines pool of worker threads running submitted
+ *        tasks.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef THREADPOOL_H_INCLUDED
+#define THREADPOOL_H_INCLUDED
+
+#include <deque>
+#include <vector>
+
+#include "PThread.h"
+
+using namespace std;
+
+/**
+ * Task which is run by the worker of the pool. Task is owned by the
+ * submitter and it has to live until its completion finishes. Task created
+ * with autoDelete is owned by the pool, it is deleted by the worker after
+ * its completion finishes, so only callbacks can be added to it.
+ */
+class Task {
+public:
+	Task(bool autoDelete = false) :
+			autoDelete(autoDelete) {
+	}
+	virtual ~Task() {
+	}
+	virtual int run() = 0;
+
+	bool isAutoDelete() const {
+		return autoDelete;
+	}
+
+	/**
+	 * Returns completion which finishes with the result of run().
+	 */
+	Completion &getCompletion() {
+		return completion;
+	}
+private:
+	bool autoDelete;
+	Completion completion;
+};
+
+/**
+ * Fixed pool of worker threads. Every worker has its own deque of tasks,
+ * tasks submitted by the worker are pushed to its deque and popped in LIFO
+ * order, other tasks are distributed round robin. Worker without tasks
+ * steals the oldest task of other workers and blocks when there is nothing
+ * to steal. Workers which are blocked elsewhere would starve the pool,
+ * so reader and executor of the shell keep their dedicated threads.
+ */
+class ThreadPool {
+public:
+	ThreadPool(int workerCount = 0,
+			size_t stackSize = PThread::DEFAULT_STACK_SIZE);
+	~ThreadPool();
+
+	void submit(Task *task);
+	int getWorkerCount() const;
+	unsigned long getStolen() const;
+private:
+	class Worker;
+	friend class Worker;
+
+	/**
+	 * Deque of the worker, owner takes from back, thieves from front.
+	 */
+	typedef struct {
+		PThreadMonitor *monitor;
+		deque<Task *> tasks;
+	} Queue;
+
+	vector<Worker *> workers;
+	vector<Queue> queues;
+	PThreadMonitor idleMonitor;
+	PThreadCondition workAvailable; /**< task has been queued or pool stops */
+	int pending; /**< tasks in all queues, accessed atomically */
+	int sleepers; /**< workers blocked on workAvailable, accessed atomically */
+	unsigned int nextQueue; /**< round robin of tasks from other threads */
+	unsigned long stolen;
+
+	static __thread ThreadPool *currentPool;
+	static __thread int currentWorker;
+
+	Task *take(int worker);
+	Task *pop(int queue, bool back);
+	void waitForWork(Worker &worker);
+
+	ThreadPool(const ThreadPool &);
+	ThreadPool &operator=(const ThreadPool &);
+};
+
+#endif // THREADPOOL_H_INCLUDED
@@ -0,0 +1,281 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       Trace.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements trace points of the hot path
+//             recorded into per-thread ring buffers.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Trace.cpp
+ *
+ * @brief Source file which implements trace points of the hot path recorded
+ *        into per-thread ring buffers.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "Trace.h"
+
+using namespace std;
+
+const char Trace::MAGIC[8] = { 'S', 'H', 'T', 'R', 'A', 'C', 'E', '\0' };
+
+volatile int Trace::fd = -1;
+__thread Trace::Ring *Trace::localRing = NULL;
+vector<Trace::Ring *> Trace::rings;
+vector<Trace::Ring *> Trace::freeRings;
+pthread_mutex_t Trace::ringsMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_key_t Trace::ringKey;
+pthread_once_t Trace::ringKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Names of the trace points.
+ */
+static const char * const POINT_NAMES[] = { "read_wait", "read_block",
+		"handoff", "pickup", "run_line", "parse", "fork", "redirect", "exec",
+		"wait_child" };
+
+/**
+ * Tests whether trace points have been compiled into the shell.
+ */
+bool Trace::isCompiledIn() {
+#ifdef SHELL_TRACE
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Opens binary file where spans are written and enables recording.
+ * @param fileName Name of the file.
+ * @return True on success, false on failure.
+ */
+bool Trace::open(const string &fileName) {
+	int file = ::open(fileName.c_str(),
+			O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+	if (file < 0) {
+		perror("Failed to open trace file - open()");
+		return false;
+	}
+
+	TraceHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAGIC, sizeof(header.magic));
+	header.version = VERSION;
+	header.recordSize = sizeof(TraceRecord);
+	TraceRecord clock = clockRecord();
+	if (write(file, &header, sizeof(header)) != sizeof(header)
+			|| write(file, &clock, sizeof(clock)) != sizeof(clock)) {
+		perror("Failed to write trace file - write()");
+		::close(file);
+		return false;
+	}
+
+	fd = file;
+	return true;
+}
+
+/**
+ * Writes remaining spans and closes trace file.
+ */
+void Trace::close() {
+	if (fd >= 0) {
+		flush();
+		int file = fd;
+		fd = -1;
+		::close(file);
+	}
+}
+
+/**
+ * Tests whether spans are recorded.
+ */
+bool Trace::isEnabled() {
+	return fd >= 0;
+}
+
+/**
+ * Returns current time in ticks. Invariant TSC is read directly, which is
+ * cheaper than clock_gettime() even through the vDSO.
+ */
+uint64_t Trace::now() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __builtin_ia32_rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+/**
+ * Returns record which pairs current ticks with nanoseconds.
+ */
+TraceRecord Trace::clockRecord() {
+	struct timespec ts;
+	TraceRecord rec;
+	rec.start = now();
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	rec.end = (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+	rec.tid = 0;
+	rec.point = POINT_COUNT;
+	rec.flags = FLAG_CLOCK;
+	return rec;
+}
+
+/**
+ * Returns ring of the calling thread, ring of a finished thread is reused,
+ * new one is registered only when there is none.
+ */
+Trace::Ring *Trace::ring() {
+	if (localRing == NULL) {
+		pthread_once(&ringKeyOnce, createRingKey);
+
+		pthread_mutex_lock(&ringsMutex);
+		Ring *taken;
+		if (!freeRings.empty()) {
+			taken = freeRings.back();
+			freeRings.pop_back();
+		} else {
+			taken = new Ring;
+			memset(taken, 0, sizeof(Ring));
+			rings.push_back(taken);
+		}
+		pthread_mutex_unlock(&ringsMutex);
+
+		taken->tid = (uint32_t) syscall(SYS_gettid);
+		pthread_setspecific(ringKey, taken);
+		localRing = taken;
+	}
+	return localRing;
+}
+
+/**
+ * Creates key whose destructor releases the ring of the finishing thread.
+ */
+void Trace::createRingKey() {
+	pthread_key_create(&ringKey, releaseRing);
+}
+
+/**
+ * Returns ring of the finished thread to the free rings, its spans which
+ * have not been drained yet are written by the next flush().
+ * @param ring Ring of the thread.
+ */
+void Trace::releaseRing(void *ring) {
+	pthread_mutex_lock(&ringsMutex);
+	freeRings.push_back(static_cast<Ring *>(ring));
+	pthread_mutex_unlock(&ringsMutex);
+}
+
+/**
+ * Records span which started at the start and ends now. Span is dropped
+ * when the ring is full, the caller never waits for the writer.
+ * @param point Trace point of the span.
+ * @param start Start of the span returned by now().
+ */
+void Trace::record(Point point, uint64_t start) {
+	if (fd < 0) {
+		return;
+	}
+
+	Ring *local = ring();
+	uint64_t head = local->head;
+	if (head - __atomic_load_n(&local->tail, __ATOMIC_ACQUIRE) >= RING_SIZE) {
+		local->dropped++;
+		return;
+	}
+
+	TraceRecord &rec = local->records[head % RING_SIZE];
+	rec.start = start;
+	rec.end = now();
+	rec.tid = local->tid;
+	rec.point = point;
+	rec.flags = 0;
+
+	__atomic_store_n(&local->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Records span of the forked child. Ring copied from the parent would be
+ * lost by exec, so the span is written directly into the file.
+ * Safe to be called between fork and exec.
+ */
+void Trace::recordChild(Point point, uint64_t start) {
+	if (fd < 0) {
+		return;
+	}
+
+	TraceRecord rec;
+	rec.start = start;
+	rec.end = now();
+	rec.tid = (uint32_t) getpid();
+	rec.point = point;
+	rec.flags = FLAG_CHILD;
+
+	if (write(fd, &rec, sizeof(rec)) != sizeof(rec)) {
+		return;
+	}
+}
+
+/**
+ * Drains rings of all threads into the trace file, batch is finished by
+ * the clock record.
+ */
+void Trace::flush() {
+	vector<TraceRecord> batch;
+
+	pthread_mutex_lock(&ringsMutex);
+	for (size_t r = 0; r < rings.size(); r++) {
+		Ring *ring = rings[r];
+		uint64_t tail = ring->tail;
+		uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		for (; tail < head; tail++) {
+			batch.push_back(ring->records[tail % RING_SIZE]);
+		}
+		__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&ringsMutex);
+
+	if (!batch.empty() && fd >= 0) {
+		batch.push_back(clockRecord());
+		size_t size = batch.size() * sizeof(TraceRecord);
+		if (write(fd, &batch[0], size) != (ssize_t) size) {
+			perror("Failed to write trace file - write()");
+		}
+	}
+}
+
+/**
+ * Returns name of the trace point.
+ */
+const char *Trace::pointName(int point) {
+	return (point >= 0 && point < POINT_COUNT) ? POINT_NAMES[point] : "unknown";
+}
+
+/**
+ * Returns number of spans dropped because of full rings.
+ */
+uint64_t Trace::getDropped() {
+	uint64_t dropped = 0;
+
+	pthread_mutex_lock(&ringsMutex);
+	for (size_t r = 0; r < rings.size(); r++) {
+		dropped += rings[r]->dropped;
+	}
+	pthread_mutex_unlock(&ringsMutex);
+
+	return dropped;
+}
@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       Trace.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines trace points of the hot path
+//             recorded into per-thread ring buffers.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Trace.h
+ *
+ * @brief Header file which defines trace points of the hot path recorded
+ *        into per-thread ring buffers.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Trace points are compiled in only when SHELL_TRACE is defined (make trace),
+ * otherwise the macros are empty and cost nothing.
+ */
+#ifdef SHELL_TRACE
+#define TRACE_BEGIN(point) uint64_t traceStart_##point = Trace::now()
+#define TRACE_END(point) Trace::record(Trace::point, traceStart_##point)
+#define TRACE_CHILD_END(point) Trace::recordChild(Trace::point, traceStart_##point)
+#else
+#define TRACE_BEGIN(point)
+#define TRACE_END(point)
+#define TRACE_CHILD_END(point)
+#endif
+
+/**
+ * One span of the trace, timestamps are ticks of the TSC on x86
+ * (nanoseconds of CLOCK_MONOTONIC elsewhere). Records with FLAG_CLOCK
+ * pair ticks in start with nanoseconds in end, so ticks can be converted.
+ */
+typedef struct {
+	uint64_t start;
+	uint64_t end;
+	uint32_t tid; /**< thread id, PID for spans of the children */
+	uint16_t point;
+	uint16_t flags;
+} TraceRecord;
+
+/**
+ * Header of the binary trace file, records follow it.
+ */
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t recordSize;
+} TraceHeader;
+
+/**
+ * Recorder of the spans. Every thread writes into its own lock-free ring,
+ * rings are drained by the trace writer thread into the binary file.
+ * Ring of the finished thread is taken by the next new thread.
+ * Children write their spans directly into the file before exec.
+ */
+class Trace {
+public:
+	enum Point {
+		READ_WAIT, /**< reader waits for the input */
+		READ_BLOCK, /**< reader reads and splits the block */
+		HANDOFF, /**< reader passes line to the executor */
+		PICKUP, /**< executor waits for the line */
+		RUN_LINE, /**< executor compiles and runs the line */
+		PARSE, /**< command line is split into tokens */
+		FORK, /**< child is forked */
+		REDIRECT, /**< child sets up redirections */
+		EXEC, /**< child calls exec */
+		WAIT_CHILD, /**< executor waits for the foreground child */
+		POINT_COUNT
+	};
+
+	static const uint16_t FLAG_CHILD = 1;
+	static const uint16_t FLAG_CLOCK = 2;
+	static const int RING_SIZE = 4096;
+
+	static bool isCompiledIn();
+	static bool open(const string &fileName);
+	static void close();
+	static bool isEnabled();
+
+	static uint64_t now();
+	static void record(Point point, uint64_t start);
+	static void recordChild(Point point, uint64_t start);
+	static void flush();
+
+	static const char *pointName(int point);
+	static uint64_t getDropped();
+
+	static const char MAGIC[8];
+	static const uint32_t VERSION = 1;
+private:
+	/**
+	 * Ring of one thread, only owner moves head, only writer moves tail.
+	 */
+	typedef struct {
+		TraceRecord records[RING_SIZE];
+		uint64_t head;
+		uint64_t tail;
+		uint64_t dropped;
+		uint32_t tid;
+	} Ring;
+
+	static volatile int fd;
+	static __thread Ring *localRing;
+	static vector<Ring *> rings;
+	static vector<Ring *> freeRings; /**< of the finished threads */
+	static pthread_mutex_t ringsMutex;
+	static pthread_key_t ringKey; /**< releases ring when thread finishes */
+	static pthread_once_t ringKeyOnce;
+
+	static Ring *ring();
+	static void createRingKey();
+	static void releaseRing(void *ring);
+	static TraceRecord clockRecord();
+};
+
+#endif // TRACE_H_INCLUDED
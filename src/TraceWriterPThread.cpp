@@ -0,0 +1,44 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       TraceWriterPThread.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Implements thread which drains trace rings into the trace
+//             file.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file TraceWriterPThread.cpp
+ *
+ * @brief Implements thread which drains trace rings into the trace file.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <signal.h>
+
+#include "Trace.h"
+#include "TraceWriterPThread.h"
+
+using namespace std;
+
+/**
+ * Main body of the writer.
+ * @return Exit code of this thread.
+ */
+int TraceWriterPThread::run() {
+	while (sleepFor(FLUSH_PERIOD)) {
+		Trace::flush();
+	}
+
+	return 0;
+}
+
+/**
+ * Writes remaining spans and closes the file when the thread is finished.
+ */
+void TraceWriterPThread::onFinish() {
+	Trace::close();
+}
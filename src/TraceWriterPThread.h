@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       TraceWriterPThread.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines the thread which drains trace rings
+//             into the trace file.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file TraceWriterPThread.h
+ *
+ * @brief Header file which defines the thread which drains trace rings into
+ *        the trace file.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef TRACEWRITERPTHREAD_H_INCLUDED
+#define TRACEWRITERPTHREAD_H_INCLUDED
+
+#include "PThread.h"
+
+using namespace std;
+
+/**
+ * Thread which periodically writes spans recorded by other threads,
+ * so recording threads never block on the file.
+ */
+class TraceWriterPThread: public PThread {
+public:
+	TraceWriterPThread() {
+	}
+	virtual ~TraceWriterPThread() {
+		cancel();
+	}
+	virtual int run();
+
+	static const int FLUSH_PERIOD = 10; /**< milliseconds */
+private:
+	virtual void onFinish();
+};
+
+#endif // TRACEWRITERPTHREAD_H_INCLUDED
@@ -0,0 +1,254 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       WatchdogPThread.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Source file which implements thread terminating children which
+//             have exceeded their timeout.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file WatchdogPThread.cpp
+ *
+ * @brief Source file which implements thread terminating children which have
+ *        exceeded their timeout.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#include "WatchdogPThread.h"
+
+using namespace std;
+
+WatchdogPThread *WatchdogPThread::instance = NULL;
+pthread_mutex_t WatchdogPThread::instanceMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Constructor, creates the timer.
+ */
+WatchdogPThread::WatchdogPThread() :
+		timerFd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)), monitor(
+				"watchdog") {
+	if (timerFd == -1) {
+		perror("Failed to create watchdog timer - timerfd_create()");
+	} else {
+		loop.add(timerFd, this);
+	}
+}
+
+/**
+ * Destructor, stops the thread.
+ */
+WatchdogPThread::~WatchdogPThread() {
+	PThread::cancel();
+	if (timerFd != -1) {
+		close(timerFd);
+	}
+}
+
+/**
+ * Returns the watchdog, it is created and started on demand.
+ * @param create Whether the watchdog is created if it does not exist.
+ * @return Watchdog or NULL.
+ */
+WatchdogPThread *WatchdogPThread::getInstance(bool create) {
+	pthread_mutex_lock(&instanceMutex);
+	if (instance == NULL && create) {
+		instance = new WatchdogPThread();
+		instance->start();
+	}
+	WatchdogPThread *watchdog = instance;
+	pthread_mutex_unlock(&instanceMutex);
+	return watchdog;
+}
+
+/**
+ * Main function where watchdog thread runs the event loop.
+ * @return Exit code of this thread.
+ */
+int WatchdogPThread::run() {
+	while (!isStopRequested()) {
+		if (loop.runOnce(-1) == -1) {
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Timer has expired, signals the groups whose deadlines have passed.
+ */
+void WatchdogPThread::onEvent(uint32_t) {
+	uint64_t expirations;
+	if (read(timerFd, &expirations, sizeof(expirations)) == -1) {
+		return; // Timer has been rearmed meanwhile
+	}
+
+	monitor.enter();
+	uint64_t current = now();
+	map<pid_t, Entry>::iterator it = entries.begin();
+	while (it != entries.end()) {
+		Entry &entry = it->second;
+		if (entry.deadline > current) {
+			++it;
+		} else if (!entry.terminated) {
+			kill(-it->first, SIGTERM);
+			kill(-it->first, SIGCONT); // Stopped process would not terminate
+			entry.terminated = true;
+			entry.deadline = current + entry.killAfter * 1000000UL;
+			++it;
+		} else {
+			kill(-it->first, SIGKILL);
+			++it; // Kept until unwatch(), so the expiration is reported
+			entry.deadline = UINT64_MAX;
+		}
+	}
+	rearm();
+	monitor.exit();
+}
+
+/**
+ * Starts watching of the process group.
+ * @param group Process group of the child.
+ * @param timeout Milliseconds until SIGTERM.
+ * @param killAfter Milliseconds between SIGTERM and SIGKILL.
+ */
+void WatchdogPThread::watch(pid_t group, long timeout, long killAfter) {
+	WatchdogPThread *watchdog = getInstance(true);
+
+	Entry entry;
+	entry.deadline = now() + timeout * 1000000UL;
+	entry.killAfter = killAfter;
+	entry.terminated = false;
+
+	watchdog->monitor.enter();
+	watchdog->entries[group] = entry;
+	watchdog->rearm();
+	watchdog->monitor.exit();
+}
+
+/**
+ * Stops watching of the process group, called when the child
+ * is reaped, so the signals are not sent to the reused process group.
+ * @param group Process group of the child.
+ * @return True if the child has been terminated by the watchdog.
+ */
+bool WatchdogPThread::unwatch(pid_t group) {
+	WatchdogPThread *watchdog = getInstance(false);
+	if (watchdog == NULL) {
+		return false;
+	}
+
+	bool terminated = false;
+	watchdog->monitor.enter();
+	map<pid_t, Entry>::iterator it = watchdog->entries.find(group);
+	if (it != watchdog->entries.end()) {
+		terminated = it->second.terminated;
+		watchdog->entries.erase(it);
+		watchdog->rearm();
+	}
+	watchdog->monitor.exit();
+
+	return terminated;
+}
+
+/**
+ * Stops and deletes the watchdog, watched children are not signalled.
+ */
+void WatchdogPThread::stop() {
+	pthread_mutex_lock(&instanceMutex);
+	WatchdogPThread *watchdog = instance;
+	instance = NULL;
+	pthread_mutex_unlock(&instanceMutex);
+
+	delete watchdog;
+}
+
+/**
+ * Parses duration - number with optional suffix ms, s, m, h or d.
+ * @param value Duration, seconds when there is no suffix.
+ * @param millis Parsed duration in milliseconds.
+ * @return True on success, false if the duration is invalid.
+ */
+bool WatchdogPThread::parseDuration(const string &value, long &millis) {
+	char *end;
+	errno = 0;
+	double number = strtod(value.c_str(), &end);
+	if (end == value.c_str() || errno != 0 || number < 0) {
+		return false;
+	}
+
+	double scale;
+	string suffix(end);
+	if (suffix == "ms") {
+		scale = 1;
+	} else if (suffix.empty() || suffix == "s") {
+		scale = 1e3;
+	} else if (suffix == "m") {
+		scale = 60e3;
+	} else if (suffix == "h") {
+		scale = 3600e3;
+	} else if (suffix == "d") {
+		scale = 86400e3;
+	} else {
+		return false;
+	}
+
+	double result = number * scale;
+	if (result > 1e15) {
+		return false;
+	}
+	millis = (long) result;
+	return true;
+}
+
+/**
+ * Arms the timer to the nearest deadline, must be called inside
+ * of the monitor.
+ */
+void WatchdogPThread::rearm() {
+	uint64_t nearest = UINT64_MAX;
+	for (map<pid_t, Entry>::iterator it = entries.begin(); it != entries.end();
+			++it) {
+		nearest = (it->second.deadline < nearest) ? it->second.deadline : nearest;
+	}
+
+	struct itimerspec spec;
+	memset(&spec, 0, sizeof(spec));
+	if (nearest != UINT64_MAX) { // Zero would disarm the timer
+		nearest = (nearest > 0) ? nearest : 1;
+		spec.it_value.tv_sec = nearest / 1000000000UL;
+		spec.it_value.tv_nsec = nearest % 1000000000UL;
+	}
+	if (timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, NULL) == -1) {
+		perror("Failed to arm watchdog timer - timerfd_settime()");
+	}
+}
+
+/**
+ * Wakes up the event loop when stop is requested.
+ */
+void WatchdogPThread::wakeUp() {
+	loop.wakeUp();
+}
+
+/**
+ * Returns monotonic time in nanoseconds.
+ */
+uint64_t WatchdogPThread::now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
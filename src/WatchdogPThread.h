@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       WatchdogPThread.h
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Header file which defines thread terminating children which
+//             have exceeded their timeout.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file WatchdogPThread.h
+ *
+ * @brief Header file which defines thread terminating children which have
+ *        exceeded their timeout.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef WATCHDOGPTHREAD_H_INCLUDED
+#define WATCHDOGPTHREAD_H_INCLUDED
+
+#include <map>
+#include <string>
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "PThread.h"
+#include "EventLoop.h"
+
+using namespace std;
+
+/**
+ * Thread which watches deadlines of the children. Child which has not
+ * exited until its deadline gets SIGTERM into its process group, SIGKILL
+ * follows after the kill delay. All deadlines share one timerfd of the event
+ * loop, it is armed to the nearest one. Thread is started with the first
+ * watched child.
+ */
+class WatchdogPThread: public PThread, public EventHandler {
+public:
+	static const long DEFAULT_KILL_AFTER = 5000; /**< milliseconds */
+
+	virtual ~WatchdogPThread();
+	virtual int run();
+	virtual void onEvent(uint32_t events);
+
+	static void watch(pid_t group, long timeout, long killAfter);
+	static bool unwatch(pid_t group);
+	static void stop();
+
+	static bool parseDuration(const string &value, long &millis);
+private:
+	/**
+	 * Watched process group.
+	 */
+	typedef struct {
+		uint64_t deadline; /**< monotonic nanoseconds */
+		long killAfter; /**< milliseconds between SIGTERM and SIGKILL */
+		bool terminated; /**< SIGTERM has been sent */
+	} Entry;
+
+	int timerFd;
+	EventLoop loop;
+	PThreadMonitor monitor;
+	map<pid_t, Entry> entries;
+
+	static WatchdogPThread *instance;
+	static pthread_mutex_t instanceMutex;
+
+	WatchdogPThread();
+	void rearm();
+	void wakeUp();
+
+	static WatchdogPThread *getInstance(bool create);
+	static uint64_t now();
+};
+
+#endif // WATCHDOGPTHREAD_H_INCLUDED
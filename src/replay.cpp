@@ -0,0 +1,314 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       replay.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Replays the session recorded by the shell and reports latency
+//             of its commands and throughput.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file replay.cpp
+ *
+ * @brief Replays the session recorded by the shell (option -R) into a new
+ *        shell and reports latency of its commands and throughput.
+ *        Lines are written at the recorded pace, or with -f every command
+ *        is written as soon as the previous one is done. Completion of
+ *        the commands is read from the event stream of the shell.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+static const int EVENT_FD = 3;
+
+/**
+ * Recorded line.
+ */
+typedef struct {
+	double offset; /**< seconds since the start of the recording */
+	bool complete; /**< last line of the command */
+	string text;
+} Line;
+
+/**
+ * Replayed command, it consists of one or more lines.
+ */
+typedef struct {
+	size_t last; /**< index of its last line */
+	double sentAt;
+	double latency;
+	int status;
+} Command;
+
+static double seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Reads the log written by the shell.
+ * @return False if the log cannot be read.
+ */
+static bool readLog(const char *fileName, vector<Line> &lines) {
+	ifstream in(fileName);
+	if (!in) {
+		perror("Failed to open session record");
+		return false;
+	}
+
+	string text;
+	while (getline(in, text)) {
+		Line line;
+		char flag;
+		int length = 0;
+		if (sscanf(text.c_str(), "%lf %c %n", &line.offset, &flag, &length) < 2
+				|| length == 0 || (flag != '.' && flag != '+')) {
+			cerr << "Invalid record: " << text << endl;
+			return false;
+		}
+		line.complete = (flag == '.');
+		line.text = text.substr(length) + "\n";
+		lines.push_back(line);
+	}
+	return true;
+}
+
+/**
+ * Starts the shell with the event stream, its output is discarded.
+ */
+static pid_t startShell(const vector<const char *> &args, const char *stubs,
+		int stdinFd, int eventFd) {
+	pid_t pid = fork();
+	if (pid == 0) {
+		if (stubs != NULL) {
+			const char *path = getenv("PATH");
+			string stubPath = string(stubs) + ":" + (path ? path : "");
+			setenv("PATH", stubPath.c_str(), 1);
+		}
+		int devnull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+		dup2(stdinFd, STDIN_FILENO);
+		dup2(devnull, STDOUT_FILENO);
+		dup2(devnull, STDERR_FILENO);
+		dup2(eventFd, EVENT_FD);
+		execv(args[0], const_cast<char * const *>(&args[0]));
+		_exit(127);
+	}
+	return pid;
+}
+
+/**
+ * Parses the done event, other events are ignored.
+ * @return True if the line is the done event.
+ */
+static bool parseDone(const string &event, unsigned long &seq, int &status) {
+	return event.find("\"event\":\"done\"") != string::npos
+			&& sscanf(event.c_str(), "{\"event\":\"done\",\"seq\":%lu,\"status\":%d",
+					&seq, &status) == 2;
+}
+
+int main(int argc, char *argv[]) {
+	bool fast = false;
+	const char *shell = "./shell";
+	const char *stubs = NULL;
+	bool verbose = false;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "+fs:x:v")) != -1) {
+		switch (opt) {
+		case 'f':
+			fast = true;
+			break;
+		case 's':
+			stubs = optarg;
+			break;
+		case 'x':
+			shell = optarg;
+			break;
+		case 'v':
+			verbose = true;
+			break;
+		default:
+			optind = argc;
+			break;
+		}
+	}
+	if (optind >= argc) {
+		cerr << "Usage: " << argv[0] << " [-f] [-v] [-s STUBS] [-x SHELL] LOG"
+				<< " [SHELL_OPTION...]" << endl
+				<< "  -f  write every command when the previous is done,"
+				<< " otherwise at the recorded pace" << endl
+				<< "  -v  print latency of every command" << endl
+				<< "  -s STUBS  directory prepended to PATH of the shell" << endl
+				<< "  -x SHELL  shell to run (default ./shell)" << endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<Line> lines;
+	if (!readLog(argv[optind], lines)) {
+		return EXIT_FAILURE;
+	}
+
+	vector<Command> commands;
+	for (size_t i = 0; i < lines.size(); i++) {
+		if (lines[i].complete) {
+			Command command = { i, 0, 0, 0 };
+			commands.push_back(command);
+		}
+	}
+
+	int input[2], events[2];
+	if (pipe2(input, O_CLOEXEC) == -1 || pipe2(events, O_CLOEXEC) == -1) {
+		perror("pipe");
+		return EXIT_FAILURE;
+	}
+	signal(SIGPIPE, SIG_IGN);
+
+	vector<const char *> args;
+	args.push_back(shell);
+	args.push_back("-H");
+	args.push_back("-");
+	args.push_back("-e");
+	args.push_back("3");
+	for (int i = optind + 1; i < argc; i++) {
+		args.push_back(argv[i]);
+	}
+	args.push_back(NULL);
+
+	pid_t pid = startShell(args, stubs, input[0], events[1]);
+	close(input[0]);
+	close(events[1]);
+	fcntl(input[1], F_SETFL, O_NONBLOCK);
+
+	/* Lines are written when they are due and the shell accepts them,
+	 * events are read meanwhile, so neither side blocks the other. */
+
+	double start = seconds();
+	size_t next = 0; // Line to be written
+	size_t written = 0; // Bytes of the next line already written
+	size_t waiting = 0; // Command whose done event is expected
+	string pending; // Incomplete event
+	bool eof = false;
+
+	while (waiting < commands.size() && !eof) {
+		double now = seconds();
+		bool due = next < lines.size()
+				&& (fast ? next <= commands[waiting].last
+						: start + lines[next].offset <= now);
+
+		struct pollfd fds[2];
+		fds[0].fd = events[0];
+		fds[0].events = POLLIN;
+		fds[1].fd = due ? input[1] : -1;
+		fds[1].events = POLLOUT;
+
+		int timeout = -1;
+		if (!due && !fast && next < lines.size()) {
+			timeout = (int) ((start + lines[next].offset - now) * 1e3) + 1;
+		}
+		if (poll(fds, 2, timeout) == -1 && errno != EINTR) {
+			perror("Failed to wait for the shell - poll()");
+			break;
+		}
+
+		if (fds[1].revents != 0) {
+			const string &text = lines[next].text;
+			ssize_t ret = write(input[1], text.data() + written,
+					text.size() - written);
+			if (ret < 0 && errno != EAGAIN && errno != EINTR) {
+				perror("Failed to write into the shell - write()");
+				break;
+			}
+			written += (ret > 0) ? ret : 0;
+			if (written == text.size()) {
+				for (size_t c = waiting; c < commands.size(); c++) {
+					if (commands[c].last == next) {
+						commands[c].sentAt = seconds();
+						break;
+					}
+				}
+				next++;
+				written = 0;
+			}
+		}
+
+		if (fds[0].revents != 0) {
+			char data[4096];
+			ssize_t length = read(events[0], data, sizeof(data));
+			if (length <= 0) {
+				eof = true; // Shell has exited
+			}
+			pending.append(data, (length > 0) ? length : 0);
+
+			size_t end;
+			while ((end = pending.find('\n')) != string::npos) {
+				unsigned long seq;
+				int status;
+				if (parseDone(pending.substr(0, end), seq, status)) {
+					while (waiting < commands.size()
+							&& commands[waiting].last + 1 < seq) {
+						waiting++; // Command has not reported, e.g. exit
+					}
+					if (waiting < commands.size()) {
+						commands[waiting].latency = seconds()
+								- commands[waiting].sentAt;
+						commands[waiting].status = status;
+						waiting++;
+					}
+				}
+				pending.erase(0, end + 1);
+			}
+		}
+	}
+	double elapsed = seconds() - start;
+
+	close(input[1]);
+	close(events[0]);
+	int status;
+	waitpid(pid, &status, 0);
+
+	vector<double> latencies;
+	for (size_t c = 0; c < waiting; c++) {
+		latencies.push_back(commands[c].latency * 1e6);
+		if (verbose) {
+			string text = lines[commands[c].last].text;
+			printf("command seq=%lu latency_us=%.1f status=%d line=%s",
+					(unsigned long) commands[c].last + 1, latencies.back(),
+					commands[c].status, text.c_str());
+		}
+	}
+	sort(latencies.begin(), latencies.end());
+
+	if (latencies.empty()) {
+		cerr << "No command has been replayed!" << endl;
+		return EXIT_FAILURE;
+	}
+	printf("replay mode=%s commands=%lu lines=%lu total_s=%.3f"
+			" commands_per_s=%.1f p50_us=%.1f p99_us=%.1f max_us=%.1f\n",
+			fast ? "fast" : "paced", (unsigned long) latencies.size(),
+			(unsigned long) next, elapsed, latencies.size() / elapsed,
+			latencies[latencies.size() / 2],
+			latencies[latencies.size() * 99 / 100], latencies.back());
+	return (waiting == commands.size()) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -27,33 +27,124 @@
 
 using namespace std;
 
+#include "Trace.h"
 #include "ShellService.h"
 
-/**
- * Instance of a service of shell.
- */
-ShellService &shell = ShellService::getInstance();
-
 /*
  * Service ended, exit application.
  * @param code Exit code of the application.
  */
 void shellServiceFinished(int code) {
+	if (PThreadMonitor::isInstrumented()) {
+		cerr << PThreadMonitor::dump() << flush;
+	}
 	exit(code);
 }
 
 /**
- * Signal handler which cleans up application and exists.
+ * Prints usage of the application.
+ * @param name Name of the executable.
+ */
+void usage(const char *name) {
+	cerr << "Usage: " << name << " [-T FILE] [-m FILE [-i SECONDS]] [-t FILE]"
+			<< " [-e FD] [-M] [-S PATH [-w WORKERS]] [-z] [-H FILE] [-R FILE]"
+			<< " [-P CPUS]"
+			<< endl
+			<< "  -T FILE  log resource usage of every command into FILE"
+			<< " (- for stderr)" << endl
+			<< "  -m FILE  periodically write metrics into FILE in Prometheus"
+			<< " text format" << endl
+			<< "  -i SECONDS  period of writing metrics" << endl
+			<< "  -t FILE  write spans of the trace points into binary FILE"
+			<< " (shell built by make trace)" << endl
+			<< "  -e FD  write JSON lines events about commands into FD,"
+			<< " prompt is not printed" << endl
+			<< "  -M  collect statistics of monitors, printed at exit"
+			<< " and by monitors builtin" << endl
+			<< "  -S PATH  serve sessions of clients connected to Unix"
+			<< " socket PATH instead of terminal" << endl
+			<< "  -w WORKERS  number of threads running lines of the"
+			<< " sessions" << endl
+			<< "  -z  fork children by the helper process started"
+			<< " with the shell" << endl
+			<< "  -H FILE  keep history in FILE (default ~/.shell_history"
+			<< " when stdin is terminal, - for none)" << endl
+			<< "  -R FILE  record lines run by the shell with their times"
+			<< " into FILE for replay" << endl
+			<< "  -P CPUS  pin the reader to the first CPU of the list and"
+			<< " the executor to the second one" << endl;
+}
+
+/**
+ * Signal handler which cleans up application and exists. Handler can run
+ * in any thread, so the service is only woken up to stop itself.
  * @param signo Number of signal which was delivered to this handler.
  */
 void shell_exit(int signo) {
 	signo = signo;
-	shell.stop();
+	ShellService::getInstance().interrupt();
 }
 
 int main(int argc, char *argv[]) {
-	argc = argc;
-	argv = argv;
+	ShellOptions options;
+	bool historySet = false;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "T:m:i:t:e:MS:w:zH:R:P:")) != -1) {
+		switch (opt) {
+		case 'T':
+			options.timingLog = optarg;
+			break;
+		case 'm':
+			options.metricsFile = optarg;
+			break;
+		case 'i':
+			options.metricsInterval = atoi(optarg);
+			break;
+		case 't':
+			if (!Trace::isCompiledIn()) {
+				cerr << "Trace points are not compiled in, build shell by"
+						<< " make trace!" << endl;
+				return EXIT_FAILURE;
+			}
+			options.traceFile = optarg;
+			break;
+		case 'e':
+			options.eventFd = atoi(optarg);
+			break;
+		case 'M':
+			PThreadMonitor::setInstrumented(true);
+			break;
+		case 'S':
+			options.serverSocket = optarg;
+			break;
+		case 'w':
+			options.workers = atoi(optarg);
+			break;
+		case 'z':
+			options.forkServer = true;
+			break;
+		case 'H':
+			options.historyFile = (string(optarg) != "-") ? optarg : "";
+			historySet = true;
+			break;
+		case 'R':
+			options.recordFile = optarg;
+			break;
+		case 'P':
+			options.pinCpus = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	/* Interactive shell keeps history in the home directory */
+	const char *home = getenv("HOME");
+	if (!historySet && isatty(STDIN_FILENO) && home != NULL) {
+		options.historyFile = string(home) + "/.shell_history";
+	}
 
 	/* Properly handle SIGTERM and SIGQUIT signals. */
 	struct sigaction sa;
@@ -87,13 +178,16 @@ int main(int argc, char *argv[]) {
 	}
 	//pthread_sigmask(SIG_BLOCK, &sa.sa_mask, NULL);
 
+	/* Children are reaped by the execute thread */
+
+	PThread::blockChildSignal(NULL);
+
 	/* Run shell service */
 
+	ShellService &shell = ShellService::getInstance();
 	shell.addOnFinishCallback(shellServiceFinished);
-	if (shell.start()) {
-		while (1)
-			pause();
-		return EXIT_SUCCESS;
+	if (shell.start(options)) {
+		return shell.run();
 	} else {
 		cerr << "Unable to start shell service!" << endl;
 		return EXIT_FAILURE;
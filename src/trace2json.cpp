@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Shell
+// Course:     POS (Advanced Operating Systems)
+// File:       trace2json.cpp
+// Date:       October 2026
+// Author:     Radim Loskot
+// E-mail:     xlosko01(at)stud.fit.vutbr.cz
+//
+// Brief:      Converts binary trace file of the shell into JSON trace
+//             format of Chrome/Perfetto.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file trace2json.cpp
+ *
+ * @brief Converts binary trace file of the shell into JSON trace format
+ *        of Chrome/Perfetto.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "Trace.h"
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+	if (argc != 2 && argc != 3) {
+		cerr << "Usage: " << argv[0] << " TRACE [JSON]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	FILE *in = fopen(argv[1], "rb");
+	if (in == NULL) {
+		perror("Failed to open trace - fopen()");
+		return EXIT_FAILURE;
+	}
+
+	TraceHeader header;
+	if (fread(&header, sizeof(header), 1, in) != 1
+			|| memcmp(header.magic, Trace::MAGIC, sizeof(header.magic)) != 0
+			|| header.version != Trace::VERSION
+			|| header.recordSize != sizeof(TraceRecord)) {
+		cerr << "Not a trace file of the shell!" << endl;
+		fclose(in);
+		return EXIT_FAILURE;
+	}
+
+	vector<TraceRecord> records;
+	TraceRecord rec, first, last;
+	int clocks = 0;
+	uint64_t origin = 0;
+	while (fread(&rec, sizeof(rec), 1, in) == 1) {
+		if (rec.flags & Trace::FLAG_CLOCK) {
+			first = (clocks++ == 0) ? rec : first;
+			last = rec;
+			continue;
+		}
+		if (records.empty() || rec.start < origin) {
+			origin = rec.start;
+		}
+		records.push_back(rec);
+	}
+	fclose(in);
+
+	/* Nanoseconds per tick from the first and last clock records */
+	double scale = 1.0;
+	if (clocks >= 2 && last.start > first.start) {
+		scale = (double) (last.end - first.end) / (last.start - first.start);
+	} else if (clocks < 2) {
+		cerr << "Trace has no clock records, ticks are taken as nanoseconds"
+				<< endl;
+	}
+
+	FILE *out = (argc == 3) ? fopen(argv[2], "w") : stdout;
+	if (out == NULL) {
+		perror("Failed to open output - fopen()");
+		return EXIT_FAILURE;
+	}
+
+	/* Complete events, timestamps are microseconds since the first span */
+	fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	for (size_t i = 0; i < records.size(); i++) {
+		const TraceRecord &r = records[i];
+		bool child = (r.flags & Trace::FLAG_CHILD) != 0;
+		fprintf(out, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+				"\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u}%s\n",
+				Trace::pointName(r.point), child ? "child" : "shell",
+				(r.start - origin) * scale / 1e3, (r.end - r.start) * scale / 1e3,
+				child ? r.tid : 0, r.tid, (i + 1 < records.size()) ? "," : "");
+	}
+	fprintf(out, "]}\n");
+
+	if (out != stdout) {
+		fclose(out);
+	}
+	cerr << records.size() << " spans converted" << endl;
+	return EXIT_SUCCESS;
+}